@@ -0,0 +1,59 @@
+#include "Benchmark.hpp"
+#include "Points.hpp"
+
+#include "../Derivative/Batch.hpp"
+
+#include <cmath> // std::abs, std::fmax
+
+using namespace Simplification;
+using namespace Benchmark;
+
+namespace
+{
+	template<typename Expr>
+	void Compare(const char *pName, const Points &rPoints)
+	{
+		const std::size_t count = rPoints.size();
+
+		std::vector<double> scalar(count), batch(count);
+
+		const auto scalarTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				scalar[i] = Expr::calc(rPoints[i]);
+
+			DoNotOptimize(scalar);
+		});
+
+		const auto batchTime = Measure([&]
+		{
+			Batching::CalcBatch<Expr>(rPoints, batch.data(), count);
+
+			DoNotOptimize(batch);
+		});
+
+		double maxError = 0.0;
+		for (std::size_t i = 0; i < count; ++i)
+			maxError = std::fmax(maxError, std::abs(scalar[i] - batch[i]));
+
+		std::printf(" %s (max |calc - batch| = %g)\n", pName, maxError);
+		Report("per-point calc", scalarTime, count);
+		Report("CalcBatch", batchTime, count, scalarTime.ns);
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunBatch()
+{
+	std::printf("Batch evaluation, SIMD width %zu\n", Batching::Simd::WIDTH);
+
+	const Points points(1u << 20);
+
+	using Polynomial = decltype(x0 * x0 * x1 + x0 * x1 - x1 / (x0 + x1));
+	using Transcendental = decltype(Sin(x0) * Ln(x1) + x0 * x1);
+
+	Compare<Polynomial>("x0 * x0 * x1 + x0 * x1 - x1 / (x0 + x1)", points);
+	Compare<Polynomial::der<'x', 0>>("d/dx0 of the above", points);
+	Compare<Transcendental>("sin(x0) * ln(x1) + x0 * x1", points);
+	Compare<Transcendental::der<'x', 0>>("d/dx0 of the above", points);
+}
@@ -0,0 +1,243 @@
+#pragma once
+
+#ifndef __BENCHMARK_HPP_INCLUDED__
+#define __BENCHMARK_HPP_INCLUDED__
+
+#include <chrono>   // std::chrono::steady_clock
+#include <cstddef>  // std::size_t
+#include <cstdint>  // std::uint64_t
+#include <cstdio>   // std::printf
+#include <string>   // std::string
+
+#if defined(__linux__)
+#include <linux/perf_event.h> // perf_event_attr
+#include <sys/ioctl.h>        // ioctl
+#include <sys/syscall.h>      // SYS_perf_event_open
+#include <unistd.h>           // syscall, read, close
+#endif /* defined(__linux__) */
+
+namespace Benchmark
+{
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Prevents the compiler from throwing away the computed value
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	inline void DoNotOptimize(const T &rValue)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "g"(&rValue) : "memory");
+#else
+		static volatile const void *s_pSink;
+		s_pSink = &rValue;
+#endif /* defined(__GNUC__) || defined(__clang__) */
+	}
+
+#pragma region Hardware counters
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Instructions and cycles of the calling thread via perf_event, available() is false where it is not supported
+	//!
+	//====================================================================================================================================
+
+	class PerfCounters
+	{
+	public:
+		PerfCounters()
+		{
+#if defined(__linux__)
+			perf_event_attr attr{ };
+			attr.size           = sizeof(attr);
+			attr.type           = PERF_TYPE_HARDWARE;
+			attr.disabled       = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv     = 1;
+			attr.read_format    = PERF_FORMAT_GROUP;
+
+			attr.config = PERF_COUNT_HW_CPU_CYCLES;
+			m_Cycles = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+			if (m_Cycles < 0)
+				return;
+
+			attr.disabled = 0;
+			attr.config   = PERF_COUNT_HW_INSTRUCTIONS;
+			m_Instructions = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, m_Cycles, 0));
+#endif /* defined(__linux__) */
+		}
+
+		PerfCounters(const PerfCounters&) = delete;
+		PerfCounters& operator=(const PerfCounters&) = delete;
+
+		~PerfCounters()
+		{
+#if defined(__linux__)
+			if (m_Instructions >= 0)
+				close(m_Instructions);
+			if (m_Cycles >= 0)
+				close(m_Cycles);
+#endif /* defined(__linux__) */
+		}
+
+		bool available() const noexcept { return (m_Cycles >= 0 && m_Instructions >= 0); }
+
+		void start() noexcept
+		{
+#if defined(__linux__)
+			if (available())
+			{
+				ioctl(m_Cycles, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+				ioctl(m_Cycles, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+			}
+#endif /* defined(__linux__) */
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Stops counting and adds the counted events to rCycles and rInstructions
+		//!
+		//====================================================================================================================================
+
+		void stop(double &rCycles, double &rInstructions) noexcept
+		{
+#if defined(__linux__)
+			if (!available())
+				return;
+
+			ioctl(m_Cycles, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+			struct
+			{
+				std::uint64_t count;
+				std::uint64_t values[2];
+			} group{ };
+
+			if (read(m_Cycles, &group, sizeof(group)) == static_cast<ssize_t>(sizeof(group)))
+			{
+				rCycles       += static_cast<double>(group.values[0]);
+				rInstructions += static_cast<double>(group.values[1]);
+			}
+#else
+			(void)rCycles;
+			(void)rInstructions;
+#endif /* defined(__linux__) */
+		}
+
+	private:
+		int m_Cycles       = -1;
+		int m_Instructions = -1;
+	};
+
+#pragma endregion
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Result of the measurement: best time of one run and hardware counters summed over all runs
+	//!
+	//====================================================================================================================================
+
+	struct Measurement
+	{
+		double ns           = 0.0;
+		double cycles       = 0.0;
+		double instructions = 0.0;
+
+		double ipc() const noexcept { return (cycles > 0.0 ? instructions / cycles : 0.0); }
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Runs func repeatedly until at least minSeconds elapsed
+	//!
+	//! \param   func        Function to measure
+	//! \param   minSeconds  Minimal total duration of the measurement
+	//!
+	//! \return  Best time of one run in nanoseconds and instructions/cycles of all runs
+	//!
+	//====================================================================================================================================
+
+	template<typename Func>
+	Measurement Measure(Func &&func, double minSeconds = 0.2)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		func(); // warm up caches and branch predictors
+
+		PerfCounters counters;
+		Measurement result;
+
+		double best = 1e300;
+		double total = 0.0;
+
+		while (total < minSeconds)
+		{
+			counters.start();
+			const auto start = Clock::now();
+			func();
+			const auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+			counters.stop(result.cycles, result.instructions);
+
+			total += elapsed;
+			if (elapsed < best)
+				best = elapsed;
+		}
+
+		result.ns = best * 1e9;
+
+		return result;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Prints one line of the report
+	//!
+	//! \param   rName        Name of the case
+	//! \param   rMeasurement Measurement of one run
+	//! \param   items        Number of items processed by one run
+	//! \param   baselineNs   Time of the baseline run, 0 if there is no baseline
+	//!
+	//====================================================================================================================================
+
+	inline void Report(const std::string &rName, const Measurement &rMeasurement, std::size_t items, double baselineNs = 0.0)
+	{
+		std::printf("  %-48s %10.3f ns/item %12.2f Mitems/s", rName.c_str(), rMeasurement.ns / items, items * 1e3 / rMeasurement.ns);
+
+		if (rMeasurement.cycles > 0.0)
+			std::printf("  IPC %.2f", rMeasurement.ipc());
+
+		if (baselineNs > 0.0)
+			std::printf("  x%.2f", baselineNs / rMeasurement.ns);
+
+		std::printf("\n");
+	}
+
+#pragma region Suites
+
+	void RunCalc();
+	void RunBatch();
+	void RunDag();
+	void RunGradient();
+	void RunFibonacci();
+	void RunProgram();
+	void RunRuntime();
+	void RunText();
+	void RunPolicy();
+	void RunHessian();
+	void RunTaylor();
+	void RunParallel();
+	void RunSlots();
+	void RunStream();
+	void RunNative();
+	void RunBinomial();
+	void RunLogarithm();
+	void RunPower();
+	void RunProfiling();
+
+#pragma endregion
+
+} // namespace Benchmark
+
+#endif /* __BENCHMARK_HPP_INCLUDED__ */
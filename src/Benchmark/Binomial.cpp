@@ -0,0 +1,126 @@
+#include "Benchmark.hpp"
+
+#include "../Factorial/Binomial.hpp"
+
+#include <stdexcept> // std::invalid_argument, std::out_of_range
+#include <vector>    // std::vector
+
+using namespace Benchmark;
+
+namespace
+{
+	constexpr size_t MOD = 1000000007;
+	constexpr size_t SIZE = 1u << 16;
+
+	using CompileTimeTables = Combinatorics::Tables<SIZE, MOD>;
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Per-call computation: n (n - 1) ... (n - k + 1) / k! with one inverse, O(min(k, n - k) + log MOD)
+	//!
+	//====================================================================================================================================
+
+	size_t CalcBinomial(size_t n, size_t k)
+	{
+		if (k > n)
+			return 0;
+
+		if (k > n - k)
+			k = n - k;
+
+		size_t numerator = 1, denominator = 1;
+		for (size_t i = 0; i < k; ++i)
+		{
+			numerator = Combinatorics::MulMod(numerator, n - i, MOD);
+			denominator = Combinatorics::MulMod(denominator, i + 1, MOD);
+		}
+
+		return Combinatorics::MulMod(numerator, Combinatorics::InverseMod(denominator, MOD), MOD);
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunBinomial()
+{
+	std::printf("Binomial coefficients modulo 1e9 + 7, n < %zu\n", SIZE);
+
+	std::vector<size_t> n(1u << 12), k(n.size());
+	for (std::size_t i = 0; i < n.size(); ++i)
+	{
+		n[i] = (i * 7919 + 13) % SIZE;
+		k[i] = (i * 104729) % (n[i] + 1);
+	}
+
+	const std::size_t count = n.size();
+	std::vector<size_t> perCall(count), runtime(count), compileTime(count);
+
+	const auto buildTime = Measure([]
+	{
+		Combinatorics::Table table(SIZE, MOD);
+
+		DoNotOptimize(table);
+	});
+
+	const Combinatorics::Table table(SIZE, MOD);
+
+	const auto perCallTime = Measure([&]
+	{
+		for (std::size_t i = 0; i < count; ++i)
+			perCall[i] = CalcBinomial(n[i], k[i]);
+
+		DoNotOptimize(perCall);
+	});
+
+	const auto runtimeTime = Measure([&]
+	{
+		for (std::size_t i = 0; i < count; ++i)
+			runtime[i] = table.binomial(n[i], k[i]);
+
+		DoNotOptimize(runtime);
+	});
+
+	const auto compileTimeTime = Measure([&]
+	{
+		for (std::size_t i = 0; i < count; ++i)
+			compileTime[i] = CompileTimeTables::binomial(n[i], k[i]);
+
+		DoNotOptimize(compileTime);
+	});
+
+	std::printf(" %zu queries (results %s)\n", count, perCall == runtime && runtime == compileTime ? "equal" : "DIFFER");
+	Report("per-call product and inverse", perCallTime, count);
+	Report("Combinatorics::Table::binomial", runtimeTime, count, perCallTime.ns);
+	Report("Combinatorics::Tables::binomial", compileTimeTime, count, perCallTime.ns);
+
+	// lookups beyond the tables and zero throw the same in both tables, a zero modulus too
+	const auto throws = [](auto lookup)
+	{
+		try
+		{
+			lookup();
+		}
+		catch (const std::invalid_argument&)
+		{
+			return true;
+		}
+		catch (const std::out_of_range&)
+		{
+			return true;
+		}
+
+		return false;
+	};
+
+	const bool rejected =
+		throws([&] { return table.inverse(0); }) && throws([] { return CompileTimeTables::inverse(0); }) &&
+		throws([&] { return table.inverse(SIZE + 1); }) && throws([] { return CompileTimeTables::inverse(SIZE + 1); }) &&
+		throws([&] { return table.binomial(SIZE + 1, 1); }) && throws([] { return CompileTimeTables::binomial(SIZE + 1, 1); }) &&
+		throws([&] { return table.permutations(SIZE + 1, 1); }) && throws([] { return CompileTimeTables::permutations(SIZE + 1, 1); }) &&
+		throws([] { return Combinatorics::MulMod(2, 3, 0); }) && throws([] { return Combinatorics::PowMod(2, 3, 0); }) &&
+		!throws([] { return CompileTimeTables::binomial(SIZE, SIZE / 2) + CompileTimeTables::inverse(SIZE); });
+
+	std::printf(" lookups beyond the tables, inverse of 0, modulus 0 (results %s)\n", rejected ? "equal" : "DIFFER");
+
+	std::printf(" building Combinatorics::Table once, %zu entries (%.1f per-call queries)\n", SIZE + 1, buildTime.ns * count / perCallTime.ns);
+	Report("Combinatorics::Table::Table", buildTime, SIZE + 1);
+}
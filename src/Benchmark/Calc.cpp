@@ -0,0 +1,104 @@
+#include "Benchmark.hpp"
+#include "Points.hpp"
+
+#include <cmath> // std::sin, std::cos, std::log, std::abs, std::fmax
+
+using namespace Simplification;
+using namespace Benchmark;
+
+namespace
+{
+	//====================================================================================================================================
+	//!
+	//! \brief	 Compares Node::calc of the expression and of its simplified form with the hand-written function
+	//!
+	//! \param   pName        Name of the case
+	//! \param   rPoints      Points to evaluate
+	//! \param   handWritten  Equivalent hand-written C++
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename HandWritten>
+	void Compare(const char *pName, const Points &rPoints, HandWritten handWritten)
+	{
+		using Simplified = SimplifyResult<Expr>;
+
+		const std::size_t count = rPoints.size();
+
+		std::vector<double> tree(count), simplified(count), hand(count);
+
+		const auto treeTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				tree[i] = Expr::calc(rPoints[i]);
+
+			DoNotOptimize(tree);
+		});
+
+		const auto simplifiedTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				simplified[i] = Simplified::calc(rPoints[i]);
+
+			DoNotOptimize(simplified);
+		});
+
+		const auto handTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				hand[i] = handWritten(rPoints.x0s[i], rPoints.x1s[i]);
+
+			DoNotOptimize(hand);
+		});
+
+		double maxError = 0.0;
+		for (std::size_t i = 0; i < count; ++i)
+			maxError = std::fmax(maxError, std::fmax(std::abs(tree[i] - hand[i]), std::abs(simplified[i] - hand[i])) / std::fmax(1.0, std::abs(hand[i])));
+
+		std::printf(" %s (%zu -> %zu nodes, %zu -> %zu estimated cycles, max relative error = %g)\n", pName, NodeCount<Expr>::value,
+			NodeCount<Simplified>::value, CostModel::Cost<Expr>::value.cycles, CostModel::Cost<Simplified>::value.cycles, maxError);
+		Report("hand-written", handTime, count);
+		Report("Node::calc", treeTime, count, handTime.ns);
+		Report("Node::calc after Simplify", simplifiedTime, count, handTime.ns);
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunCalc()
+{
+	std::printf("Node::calc against hand-written code\n");
+
+	const Points points(1u << 16);
+
+	using Polynomial = decltype(x0 * x0 * x1 + Sin(x0));
+	Compare<Polynomial>("x0 * x0 * x1 + sin(x0)", points,
+		[](double a, double b) { return a * a * b + std::sin(a); });
+	Compare<Polynomial::der<'x', 0>>("d/dx0", points,
+		[](double a, double b) { return 2.0 * a * b + std::cos(a); });
+	Compare<Polynomial::der<'x', 0>::der<'x', 0>>("d2/dx0^2", points,
+		[](double a, double b) { return 2.0 * b - std::sin(a); });
+
+	using Trigonometric = decltype(Sin(x0) * Cos(x1));
+	Compare<Trigonometric>("sin(x0) * cos(x1)", points,
+		[](double a, double b) { return std::sin(a) * std::cos(b); });
+	Compare<Trigonometric::der<'x', 0>>("d/dx0", points,
+		[](double a, double b) { return std::cos(a) * std::cos(b); });
+	Compare<Trigonometric::der<'x', 0>::der<'x', 1>>("d2/dx0dx1", points,
+		[](double a, double b) { return -std::cos(a) * std::sin(b); });
+
+	using Logarithm = decltype(Ln(x0 * x1 + Num<1>));
+	Compare<Logarithm>("ln(x0 * x1 + 1)", points,
+		[](double a, double b) { return std::log(a * b + 1.0); });
+	Compare<Logarithm::der<'x', 0>>("d/dx0", points,
+		[](double a, double b) { return b / (a * b + 1.0); });
+	Compare<Logarithm::der<'x', 0>::der<'x', 0>>("d2/dx0^2", points,
+		[](double a, double b) { return -b * b / ((a * b + 1.0) * (a * b + 1.0)); });
+
+	using Quotient = decltype(x0 / x1);
+	Compare<Quotient>("x0 / x1", points,
+		[](double a, double b) { return a / b; });
+	Compare<Quotient::der<'x', 1>>("d/dx1", points,
+		[](double a, double b) { return -a / (b * b); });
+	Compare<Quotient::der<'x', 1>::der<'x', 1>>("d2/dx1^2", points,
+		[](double a, double b) { return 2.0 * a / (b * b * b); });
+}
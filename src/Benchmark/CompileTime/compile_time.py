@@ -0,0 +1,370 @@
+#!/usr/bin/env python3
+"""
+Compile-time benchmark for the template metaprograms.
+
+Every case is a small translation unit generated for a growing size N. Each
+unit is compiled with every requested compiler and the script records:
+
+  * wall time of the compilation,
+  * peak memory of the compiler (maximum RSS of the driver and its children),
+  * template instantiation statistics:
+      - clang: number of InstantiateClass/InstantiateFunction events from -ftime-trace,
+      - gcc:   time of the 'template instantiation' phase from -ftime-report.
+
+The result is printed as a Markdown table. With --json the raw numbers are
+stored, and --baseline compares the run with such a file, so regressions and
+scaling curves are visible. Cases listed in GROWTH_LIMITS also fail the run when
+the instantiation count (clang) or the template instantiation time of
+-ftime-report (gcc) grows by more than the given factor from one size to the
+next. The total time is not used for this: its fixed startup cost of the
+compiler hides super-linear growth of the small sizes.
+
+Usage:
+    python3 compile_time.py [--compilers g++ clang++] [--cases fibonacci derivative-sin ...]
+                            [--json result.json] [--baseline previous.json] [--repeat 3]
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+SRC_DIR = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..'))
+
+DERIVATIVE_PROLOGUE = '''
+#include "Derivative/Simplify.hpp"
+
+using namespace Simplification;
+
+using X0 = Node<Variable<'x', 0>>;
+
+struct Point
+{
+	using value_type = double;
+
+	double operator()(X0) const noexcept { return 0.5; }
+};
+'''
+
+DERIVATIVE_EPILOGUE = '''
+int main()
+{
+	return static_cast<int>(NodeCount<Result>::value + Result::calc(Point{ }));
+}
+'''
+
+
+def nested(function, depth, leaf='X0'):
+    """Node<Wrap, Node<Wrap, ... leaf>> of the given depth."""
+    expr = leaf
+    for _ in range(depth):
+        expr = f'Node<{function}, {expr}>'
+    return expr
+
+
+def product(depth):
+    """x0 * x0 * ... * x0 with depth multiplications."""
+    expr = 'X0'
+    for _ in range(depth):
+        expr = f'Node<WrapMul, {expr}, X0>'
+    return expr
+
+
+def derivative(expr, order):
+    for _ in range(order):
+        expr = f'{expr}::der<\'x\', 0>'
+    return expr
+
+
+def derivative_case(expr):
+    return DERIVATIVE_PROLOGUE + f'\nusing Result = {expr};\n' + DERIVATIVE_EPILOGUE
+
+
+def hessian_case(n, fused):
+    """Hessian by n variables of sin(x0) * ... * sin(x{n-1}) / (x0 + ... + x{n-1}), fused or by nesting der by hand."""
+    variables = [f'Node<Variable<\'x\', {i}>>' for i in range(n)]
+    numerator = f'Node<WrapSin, {variables[0]}>'
+    denominator = variables[0]
+    for variable in variables[1:]:
+        numerator = f'Node<WrapMul, {numerator}, Node<WrapSin, {variable}>>'
+        denominator = f'Node<WrapAdd, {denominator}, {variable}>'
+
+    if fused:
+        body = f'return static_cast<int>(Symbolic::Hessian<Expr, {", ".join(variables)}>::calcAll(Point{{ }}).value);'
+    else:
+        terms = [f'SimplifyResult<Expr::der<\'x\', {i}>::der<\'x\', {j}>>::calc(Point{{ }})' for i in range(n) for j in range(n)]
+        body = f'return static_cast<int>({" + ".join(terms)});'
+
+    return f'''
+#include "Derivative/Symbolic.hpp"
+
+using namespace Simplification;
+
+struct Point
+{{
+	using value_type = double;
+
+	template<int INDEX>
+	double operator()(Node<Variable<'x', INDEX>>) const noexcept {{ return 0.5 + INDEX; }}
+}};
+
+using Expr = Node<WrapDiv, {numerator}, {denominator}>;
+
+int main()
+{{
+	{body}
+}}
+'''
+
+
+#: name -> (sizes, generator of the translation unit)
+CASES = {
+    'fibonacci': ([10, 30, 60, 90], lambda n: f'''
+#include "Fibonacci/Fibonacci.hpp"
+
+int main() {{ return static_cast<int>(Fibonacci<{n}>::value); }}
+'''),
+    # the former two-way recursive template, kept to compare against
+    'fibonacci-recursive': ([10, 30, 60, 90], lambda n: f'''
+#include <cstddef>
+
+template<size_t N> struct Fibonacci {{ static constexpr size_t value = Fibonacci<N - 1>::value + Fibonacci<N - 2>::value; }};
+template<> struct Fibonacci<1> {{ static constexpr size_t value = 1; }};
+template<> struct Fibonacci<0> {{ static constexpr size_t value = 1; }};
+
+int main() {{ return static_cast<int>(Fibonacci<{n}>::value); }}
+'''),
+    'fibonacci-mod': ([10 ** 3, 10 ** 6, 10 ** 12, 10 ** 18], lambda n: f'''
+#include "Fibonacci/Fibonacci.hpp"
+
+int main() {{ return static_cast<int>(Fibonacci<{n}ull, 1000000007ull>::value); }}
+'''),
+    'factorial': ([10, 100, 1000, 3000], lambda n: f'''
+#include "Factorial/Factorial.hpp"
+
+int main() {{ return static_cast<int>(Factorial<{n}>::big.size()); }}
+'''),
+    # the same big integers multiplied one factor after another, kept to compare against the product tree
+    'factorial-linear': ([10, 100, 1000, 3000], lambda n: f'''
+#include "Factorial/Factorial.hpp"
+
+using Big = Multiprecision::BigInteger<FactorialEngine::Limbs({n})>;
+
+constexpr Big Linear(size_t n)
+{{
+	Big result = 1;
+	for (size_t factor = 2; factor <= n; ++factor)
+		result = result * Big(static_cast<long long>(factor));
+
+	return result;
+}}
+
+constexpr Big value = Linear({n});
+
+int main() {{ return static_cast<int>(value.size()); }}
+'''),
+    # the product tree without Karatsuba, kept to compare against
+    'factorial-schoolbook': ([10, 100, 1000, 3000], lambda n: f'''
+#include "Factorial/Factorial.hpp"
+
+using Big = Multiprecision::BigInteger<FactorialEngine::Limbs({n})>;
+
+constexpr Big Tree(size_t first, size_t last)
+{{
+	if (last < first + 16)
+		return Multiprecision::RangeProduct<Big::CAPACITY>(first, last);
+
+	const size_t middle = first + (last - first) / 2;
+
+	return Big::Multiplied(Tree(first, middle), Tree(middle + 1, last), Big::CAPACITY + 1);
+}}
+
+constexpr Big value = Tree(1, {n});
+
+int main() {{ return static_cast<int>(value.size()); }}
+'''),
+    # factorials and inverse factorials of 0..N modulo 1e9 + 7 in one constexpr pass each
+    'binomial-table': ([1000, 10000, 50000, 100000], lambda n: f'''
+#include "Factorial/Binomial.hpp"
+
+int main() {{ return static_cast<int>(Combinatorics::Tables<{n}, 1000000007>::binomial({n}, {n} / 2)); }}
+'''),
+    'power': ([10, 100, 400, 800], lambda n: f'''
+#include "Power/Power.hpp"
+
+int main() {{ return static_cast<int>(Power<1ll, {n}u>::value); }}
+'''),
+    'power-big': ([100, 1000, 10000, 30000], lambda n: f'''
+#include "Power/Power.hpp"
+
+int main() {{ return static_cast<int>(Power<3ll, {n}u>::big.size()); }}
+'''),
+    'fibonacci-big': ([100, 1000, 10000, 30000], lambda n: f'''
+#include "Fibonacci/Fibonacci.hpp"
+
+int main() {{ return static_cast<int>(Fibonacci<{n}>::big.size()); }}
+'''),
+    'log2': ([1 << 4, 1 << 12, 1 << 20, 1 << 31], lambda n: f'''
+#include "Logarithm/Logarithm.hpp"
+
+int main() {{ return Log2<{n}u>::value; }}
+'''),
+    # the former template recursing once per bit, kept to compare against
+    'log2-recursive': ([1 << 4, 1 << 12, 1 << 20, 1 << 31], lambda n: f'''
+template<unsigned x> struct Log2 {{ static constexpr int value = 1 + Log2<x / 2>::value; }};
+template<> struct Log2<1u> {{ static constexpr int value = 1; }};
+
+int main() {{ return Log2<{n}u>::value; }}
+'''),
+    'derivative-sin': ([1, 4, 8, 16], lambda n: derivative_case(derivative(nested('WrapSin', n), 1))),
+    'derivative-mul': ([2, 8, 16, 32], lambda n: derivative_case(derivative(product(n), 1))),
+    'derivative-nth': ([1, 2, 3, 4], lambda n: derivative_case(derivative('Node<WrapMul, Node<WrapSin, X0>, Node<WrapDiv, X0, Node<WrapLn, X0>>>', n))),
+    'simplify-nth': ([1, 2, 3, 4], lambda n: derivative_case(
+        f'SimplifyResult<{derivative("Node<WrapMul, Node<WrapSin, X0>, Node<WrapDiv, X0, Node<WrapLn, X0>>>", n)}>')),
+    # every order the memoized derivative of the order below, simplified node by node
+    'nth-derivative': ([2, 4, 6, 8], lambda n: derivative_case(
+        f'Symbolic::NthDerivativeResult<Node<WrapMul, Node<WrapSin, X0>, Node<WrapDiv, X0, Node<WrapLn, X0>>>, X0, {n}>').replace(
+        'Derivative/Simplify.hpp', 'Derivative/Symbolic.hpp')),
+    'program-nth': ([1, 2, 3, 4], lambda n: '#include "Derivative/Program.hpp"\n' + derivative_case(
+        f'{derivative("Node<WrapMul, Node<WrapSin, X0>, Node<WrapDiv, X0, Node<WrapLn, X0>>>", n)}').replace(
+        'Result::calc', 'Lowering::Program<Result>::calc')),
+    'hessian': ([1, 2, 3, 4], lambda n: hessian_case(n, True)),
+    # every entry nested by hand, kept to compare against
+    'hessian-nested': ([1, 2, 3, 4], lambda n: hessian_case(n, False)),
+}
+
+# cases whose trees grow exponentially with N while the instantiations must not
+GROWTH_LIMITS = {
+    # the trees grow about 100 times from one size to the next
+    'nth-derivative': 3.0,
+}
+
+
+def run_compiler(compiler, source, workdir):
+    """Compiles source and returns (seconds, peak KiB, instantiation metric) or None on failure."""
+    cpp = os.path.join(workdir, 'case.cpp')
+    obj = os.path.join(workdir, 'case.o')
+    log = os.path.join(workdir, 'case.log')
+    with open(cpp, 'w') as file:
+        file.write(source)
+
+    is_clang = 'clang' in os.path.basename(compiler)
+    args = [compiler, '-std=c++17', '-O0', '-c', cpp, '-o', obj, '-I', SRC_DIR, '-ftemplate-depth=4096']
+    args.append('-ftime-trace' if is_clang else '-ftime-report')
+
+    with open(log, 'w') as stderr:
+        start = time.perf_counter()
+        process = subprocess.Popen(args, stdout=subprocess.DEVNULL, stderr=stderr)
+        # wait4 reports the usage of the driver together with the compiler proper it has waited for
+        _, status, usage = os.wait4(process.pid, 0)
+        elapsed = time.perf_counter() - start
+        process.returncode = os.waitstatus_to_exitcode(status)
+
+    with open(log) as file:
+        report = file.read()
+
+    if process.returncode != 0:
+        sys.stderr.write(report[-2000:])
+        return None
+
+    if is_clang:
+        with open(os.path.join(workdir, 'case.json')) as file:
+            events = json.load(file).get('traceEvents', [])
+        metric = sum(1 for event in events if event.get('name') in ('InstantiateClass', 'InstantiateFunction'))
+    else:
+        # ' template instantiation : <usr> ( x%) <sys> ( x%) <wall> ( x%) <memory>'
+        match = re.search(r'template instantiation\s*:' + r'\s*(\d+\.\d+)\s*\(\s*\d+%\)' * 3, report)
+        metric = float(match.group(3)) if match else 0.0
+
+    return elapsed, usage.ru_maxrss, metric
+
+
+def measure(compilers, cases, repeat):
+    results = []
+    with tempfile.TemporaryDirectory() as workdir:
+        for name in cases:
+            sizes, generate = CASES[name]
+            for size in sizes:
+                source = generate(size)
+                for compiler in compilers:
+                    runs = [run_compiler(compiler, source, workdir) for _ in range(repeat)]
+                    if any(run is None for run in runs):
+                        results.append({'case': name, 'n': size, 'compiler': compiler, 'failed': True})
+                        continue
+
+                    best = min(runs, key=lambda run: run[0])
+                    results.append({'case': name, 'n': size, 'compiler': compiler,
+                                    'seconds': best[0], 'peak_mib': best[1] / 1024.0, 'instantiations': best[2]})
+    return results
+
+
+def print_table(results, baseline):
+    previous = {(row['case'], row['n'], row['compiler']): row for row in baseline}
+
+    print('| case | N | compiler | time, s | peak memory, MiB | instantiations (clang) / instantiation time, s (gcc) | time vs baseline |')
+    print('|------|---|----------|---------|------------------|-------------------------------------------------------|------------------|')
+    for row in results:
+        if row.get('failed'):
+            print(f"| {row['case']} | {row['n']} | {row['compiler']} | failed | | | |")
+            continue
+
+        delta = ''
+        old = previous.get((row['case'], row['n'], row['compiler']))
+        if old and not old.get('failed') and old['seconds'] > 0:
+            delta = f"{(row['seconds'] / old['seconds'] - 1.0) * 100.0:+.1f}%"
+
+        print(f"| {row['case']} | {row['n']} | {row['compiler']} | {row['seconds']:.3f} | {row['peak_mib']:.1f} | {row['instantiations']:g} | {delta} |")
+
+
+def check_growth(results):
+    """Names of the cases of GROWTH_LIMITS that grew faster than allowed, with the offending sizes."""
+    violations = []
+    for name, limit in GROWTH_LIMITS.items():
+        for compiler in {row['compiler'] for row in results if row['case'] == name}:
+            rows = [row for row in results if row['case'] == name and row['compiler'] == compiler and not row.get('failed')]
+            # instantiation count of clang or instantiation seconds of gcc, 0 if the compiler did not report it
+            for previous, row in zip(rows, rows[1:]):
+                if previous['instantiations'] > 0 and row['instantiations'] / previous['instantiations'] > limit:
+                    violations.append(f"{name} {compiler}: N = {previous['n']} -> {row['n']}, "
+                                      f"x{row['instantiations'] / previous['instantiations']:.2f} > x{limit:g}")
+    return violations
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--compilers', nargs='+', default=[c for c in ('g++', 'clang++') if shutil.which(c)])
+    parser.add_argument('--cases', nargs='+', default=list(CASES), choices=list(CASES))
+    parser.add_argument('--repeat', type=int, default=1, help='compilations per case, the fastest one is reported')
+    parser.add_argument('--json', help='file to store the raw results')
+    parser.add_argument('--baseline', help='raw results of a previous run to compare with')
+    options = parser.parse_args()
+
+    if not options.compilers:
+        parser.error('no compiler found, pass --compilers')
+
+    baseline = []
+    if options.baseline:
+        with open(options.baseline) as file:
+            baseline = json.load(file)
+
+    results = measure(options.compilers, options.cases, options.repeat)
+    print_table(results, baseline)
+
+    if options.json:
+        with open(options.json, 'w') as file:
+            json.dump(results, file, indent=2)
+
+    violations = check_growth(results)
+    for violation in violations:
+        sys.stderr.write(f'growth limit exceeded: {violation}\n')
+
+    return 1 if violations or any(row.get('failed') for row in results) else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,62 @@
+#include "Benchmark.hpp"
+#include "Points.hpp"
+
+#include "../Derivative/Dag.hpp"
+
+#include <cmath> // std::abs, std::fmax
+
+using namespace Simplification;
+using namespace Benchmark;
+
+namespace
+{
+	template<typename Expr>
+	void Compare(const char *pName, const Points &rPoints)
+	{
+		using Shared = Sharing::Dag<Expr>;
+
+		const std::size_t count = rPoints.size();
+
+		std::vector<double> tree(count), dag(count);
+
+		const auto treeTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				tree[i] = Expr::calc(rPoints[i]);
+
+			DoNotOptimize(tree);
+		});
+
+		const auto dagTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				dag[i] = Shared::calc(rPoints[i]);
+
+			DoNotOptimize(dag);
+		});
+
+		double maxError = 0.0;
+		for (std::size_t i = 0; i < count; ++i)
+			maxError = std::fmax(maxError, std::abs(tree[i] - dag[i]));
+
+		std::printf(" %s (%zu tree nodes, %zu unique, max |calc - dag| = %g)\n", pName, NodeCount<Expr>::value, Shared::SIZE, maxError);
+		Report("Node::calc", treeTime, count);
+		Report("Dag::calc", dagTime, count, treeTime.ns);
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunDag()
+{
+	std::printf("Common-subexpression elimination\n");
+
+	const Points points(1u << 16);
+
+	using Quotient = decltype(Sin(x0) / (x0 * x1 + Ln(x1)));
+	using Power = Node<WrapPow, decltype(x0 / x1), decltype(x0 * x1)>;
+
+	Compare<Quotient::der<'x', 0>>("d/dx0 sin(x0) / (x0 * x1 + ln(x1))", points);
+	Compare<Quotient::der<'x', 0>::der<'x', 1>>("d2/dx0dx1 of the above", points);
+	Compare<Power::der<'x', 0>>("d/dx0 (x0 / x1) ^ (x0 * x1)", points);
+	Compare<Power::der<'x', 0>::der<'x', 1>>("d2/dx0dx1 of the above", points);
+}
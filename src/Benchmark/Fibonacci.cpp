@@ -0,0 +1,79 @@
+#include "Benchmark.hpp"
+
+#include "../Fibonacci/Fibonacci.hpp"
+
+#include <vector> // std::vector
+
+using namespace Benchmark;
+
+namespace
+{
+	//====================================================================================================================================
+	//!
+	//! \brief	Linear iteration, the runtime counterpart of the former two-way recursive template
+	//!
+	//====================================================================================================================================
+
+	size_t CalcLinear(size_t n, size_t mod)
+	{
+		size_t a = 1, b = 1;
+		for (size_t i = 1; i < n; ++i)
+		{
+			const size_t next = mod ? (a + b) % mod : a + b;
+			a = b;
+			b = next;
+		}
+
+		return b;
+	}
+
+	void Compare(const char *pName, const std::vector<size_t> &rIndices, size_t mod)
+	{
+		const std::size_t count = rIndices.size();
+
+		std::vector<size_t> linear(count), doubling(count), batch(count);
+
+		const auto linearTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				linear[i] = CalcLinear(rIndices[i], mod);
+
+			DoNotOptimize(linear);
+		});
+
+		const auto doublingTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				doubling[i] = FibonacciEngine::Calc(rIndices[i], mod);
+
+			DoNotOptimize(doubling);
+		});
+
+		const auto batchTime = Measure([&]
+		{
+			FibonacciEngine::CalcBatch(rIndices.data(), batch.data(), count, mod);
+
+			DoNotOptimize(batch);
+		});
+
+		std::printf(" %s (results %s)\n", pName, linear == doubling && doubling == batch ? "equal" : "DIFFER");
+		Report("linear iteration", linearTime, count);
+		Report("FibonacciEngine::Calc", doublingTime, count, linearTime.ns);
+		Report("FibonacciEngine::CalcBatch", batchTime, count, linearTime.ns);
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunFibonacci()
+{
+	std::printf("Fibonacci numbers\n");
+
+	std::vector<size_t> small(1u << 14), large(1u << 8);
+	for (std::size_t i = 0; i < small.size(); ++i)
+		small[i] = (i * 7919) % (FibonacciEngine::MAX_INDEX + 1);
+	for (std::size_t i = 0; i < large.size(); ++i)
+		large[i] = 100000 + (i * 7919) % 100000;
+
+	Compare("N <= 92, exact", small, 0);
+	Compare("N in [1e5, 2e5), mod 1e9 + 7", large, 1000000007);
+}
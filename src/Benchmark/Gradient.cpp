@@ -0,0 +1,214 @@
+#include "Benchmark.hpp"
+#include "Points.hpp"
+
+#include "../Derivative/Adjoint.hpp"
+#include "../Derivative/Dual.hpp"
+
+#include <cmath>   // std::abs, std::fmax, std::isfinite
+#include <utility> // std::index_sequence
+
+using namespace Simplification;
+using namespace Benchmark;
+
+namespace
+{
+	struct Gradient
+	{
+		double value, dx0, dx1;
+	};
+
+	template<typename Expr>
+	Gradient CalcPerVariable(const Point &rPoint)
+	{
+		return { Expr::calc(rPoint), Expr::template der<'x', 0>::calc(rPoint), Expr::template der<'x', 1>::calc(rPoint) };
+	}
+
+	template<typename Expr>
+	Gradient CalcPerVariableSimplified(const Point &rPoint)
+	{
+		return { Expr::calc(rPoint), SimplifyResult<typename Expr::template der<'x', 0>>::calc(rPoint), SimplifyResult<typename Expr::template der<'x', 1>>::calc(rPoint) };
+	}
+
+	template<typename Expr>
+	Gradient CalcForward(const Point &rPoint)
+	{
+		const auto dual = ForwardMode::CalcGradient<Expr>(rPoint);
+
+		return { dual.value, dual.tangent[0], dual.tangent[1] };
+	}
+
+	template<typename Expr>
+	Gradient CalcReverse(const Point &rPoint)
+	{
+		const auto result = ReverseMode::CalcGradient<Expr>(rPoint);
+
+		return { result.value, result.gradient[0], result.gradient[1] };
+	}
+
+	template<typename Func>
+	Measurement MeasureGradient(const Points &rPoints, std::vector<Gradient> &rResult, Func func)
+	{
+		return Measure([&]
+		{
+			for (std::size_t i = 0; i < rPoints.size(); ++i)
+				rResult[i] = func(rPoints[i]);
+
+			DoNotOptimize(rResult);
+		});
+	}
+
+	double MaxError(const std::vector<Gradient> &rExpected, const std::vector<Gradient> &rActual)
+	{
+		double maxError = 0.0;
+		for (std::size_t i = 0; i < rExpected.size(); ++i)
+		{
+			maxError = std::fmax(maxError, std::abs(rExpected[i].value - rActual[i].value));
+			maxError = std::fmax(maxError, std::abs(rExpected[i].dx0 - rActual[i].dx0));
+			maxError = std::fmax(maxError, std::abs(rExpected[i].dx1 - rActual[i].dx1));
+		}
+
+		return maxError;
+	}
+
+	template<typename Expr>
+	void Compare(const char *pName, const Points &rPoints)
+	{
+		std::vector<Gradient> perVariable(rPoints.size()), simplified(rPoints.size()), forward(rPoints.size()), reverse(rPoints.size());
+
+		const auto perVariableTime = MeasureGradient(rPoints, perVariable, CalcPerVariable<Expr>);
+		const auto simplifiedTime  = MeasureGradient(rPoints, simplified, CalcPerVariableSimplified<Expr>);
+		const auto forwardTime     = MeasureGradient(rPoints, forward, CalcForward<Expr>);
+		const auto reverseTime     = MeasureGradient(rPoints, reverse, CalcReverse<Expr>);
+
+		std::printf(" %s (max |der - forward| = %g, max |der - reverse| = %g)\n", pName, MaxError(perVariable, forward), MaxError(perVariable, reverse));
+		Report("calc + der<x0>::calc + der<x1>::calc", perVariableTime, rPoints.size());
+		Report("the same with simplified der", simplifiedTime, rPoints.size(), perVariableTime.ns);
+		Report("ForwardMode::CalcGradient", forwardTime, rPoints.size(), perVariableTime.ns);
+		Report("ReverseMode::CalcGradient", reverseTime, rPoints.size(), perVariableTime.ns);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	sin(x_0) * x_1 + sin(x_1) * x_2 + ... + sin(x_K) * x_(K + 1)
+	//!
+	//====================================================================================================================================
+
+	template<int K>
+	struct Chain
+	{
+		using res = Node<WrapAdd, typename Chain<K - 1>::res, Node<WrapMul, Node<WrapSin, Node<Variable<'x', K>>>, Node<Variable<'x', K + 1>>>>;
+	};
+
+	template<>
+	struct Chain<0>
+	{
+		using res = Node<WrapMul, Node<WrapSin, Node<Variable<'x', 0>>>, Node<Variable<'x', 1>>>;
+	};
+
+	struct ArrayPoint
+	{
+		using value_type = double;
+
+		const double *pValues;
+
+		template<int INDEX>
+		double operator()(Node<Variable<'x', INDEX>>) const noexcept { return pValues[INDEX]; }
+	};
+
+	template<typename Expr, std::size_t... Is>
+	void CompareWide(std::index_sequence<Is...>)
+	{
+		constexpr std::size_t VARIABLES = sizeof...(Is);
+		constexpr std::size_t COUNT = 1u << 12;
+
+		std::vector<double> values(COUNT * VARIABLES);
+		for (std::size_t i = 0; i < values.size(); ++i)
+			values[i] = 0.5 + static_cast<double>(i % 101) / 101.0;
+
+		std::vector<std::array<double, VARIABLES>> perVariable(COUNT), forward(COUNT), reverse(COUNT);
+
+		const auto perVariableTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < COUNT; ++i)
+			{
+				const ArrayPoint point{ values.data() + i * VARIABLES };
+				perVariable[i] = { Expr::template der<'x', static_cast<int>(Is)>::calc(point)... };
+			}
+
+			DoNotOptimize(perVariable);
+		});
+
+		const auto forwardTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < COUNT; ++i)
+				forward[i] = ForwardMode::CalcGradient<Expr>(ArrayPoint{ values.data() + i * VARIABLES }).tangent;
+
+			DoNotOptimize(forward);
+		});
+
+		const auto reverseTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < COUNT; ++i)
+				reverse[i] = ReverseMode::CalcGradient<Expr>(ArrayPoint{ values.data() + i * VARIABLES }).gradient;
+
+			DoNotOptimize(reverse);
+		});
+
+		double maxError = 0.0;
+		for (std::size_t i = 0; i < COUNT; ++i)
+			for (std::size_t k = 0; k < VARIABLES; ++k)
+				maxError = std::fmax(maxError, std::fmax(std::abs(perVariable[i][k] - forward[i][k]), std::abs(perVariable[i][k] - reverse[i][k])));
+
+		std::printf(" chain of %zu variables, %zu nodes (max error = %g)\n", VARIABLES, NodeCount<Expr>::value, maxError);
+		Report("der<x_k>::calc for every k", perVariableTime, COUNT);
+		Report("ForwardMode::CalcGradient", forwardTime, COUNT, perVariableTime.ns);
+		Report("ReverseMode::CalcGradient", reverseTime, COUNT, perVariableTime.ns);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Forward and reverse mode on negative bases, where log of the base is NaN, and on zero, where x ^ y / x is 0 / 0:
+	//!			exponents which do not depend on the variables must bring neither into the gradient
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr>
+	void CheckBases(const char *pName)
+	{
+		double maxError = 0.0;
+		bool finite = true;
+		for (const double base : { -3.0, -1.5, -0.25, 0.0 })
+		{
+			const Point point{ base, 2.0 };
+			const Gradient forward = CalcForward<Expr>(point), reverse = CalcReverse<Expr>(point);
+
+			finite = finite && std::isfinite(forward.dx0) && std::isfinite(forward.dx1) && std::isfinite(reverse.dx0) && std::isfinite(reverse.dx1);
+			maxError = std::fmax(maxError, std::fmax(std::abs(forward.dx0 - reverse.dx0), std::abs(forward.dx1 - reverse.dx1)));
+		}
+
+		std::printf(" %s at negative and zero bases: forward %s reverse mode (max error = %g)\n", pName, finite && maxError < 1e-12 ? "equal to" : "DIFFER from", maxError);
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunGradient()
+{
+	std::printf("Gradient by forward and reverse mode\n");
+
+	const Points points(1u << 16);
+
+	using Quotient = decltype(Sin(x0) / (x0 * x1 + Ln(x1)));
+	using Power = Node<WrapPow, decltype(x0 / x1), decltype(x0 * x1)>;
+	using Nested = decltype(Sin(Cos(x0 * x1) * Ln(x0 + x1)) / (x0 * x0 + x1));
+
+	Compare<Quotient>("sin(x0) / (x0 * x1 + ln(x1))", points);
+	Compare<Power>("(x0 / x1) ^ (x0 * x1)", points);
+	Compare<Nested>("sin(cos(x0 * x1) * ln(x0 + x1)) / (x0 * x0 + x1)", points);
+
+	CheckBases<Node<WrapMul, Node<WrapPow, X0, Node<Number<2>>>, X1>>("x0 ^ 2 * x1");
+	CheckBases<Node<WrapPow, decltype(x0 * x1), Node<Number<3>>>>("(x0 * x1) ^ 3");
+	CheckBases<Node<WrapMul, Node<WrapPow, X0, Node<WrapAdd, Node<Number<1>>, Node<Number<1>>>>, X1>>("x0 ^ (1 + 1) * x1");
+
+	CompareWide<Chain<7>::res>(std::make_index_sequence<9>{ });
+	CompareWide<Chain<31>::res>(std::make_index_sequence<33>{ });
+}
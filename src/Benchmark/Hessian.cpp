@@ -0,0 +1,112 @@
+#include "Benchmark.hpp"
+#include "Points.hpp"
+
+#include "../Derivative/Symbolic.hpp"
+
+#include <cmath> // std::abs, std::fmax
+
+using namespace Simplification;
+using namespace Benchmark;
+
+namespace
+{
+	using Result = Symbolic::SecondOrder<double, 2>;
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Value, gradient and Hessian by nesting der by hand, every entry is a separate tree
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, template<typename> class Transform>
+	Result CalcNested(const Point &rPoint)
+	{
+		using D0 = typename Expr::template der<'x', 0>;
+		using D1 = typename Expr::template der<'x', 1>;
+
+		Result result;
+		result.value = Expr::calc(rPoint);
+		result.gradient = { Transform<D0>::calc(rPoint), Transform<D1>::calc(rPoint) };
+		result.hessian[0][0] = Transform<typename D0::template der<'x', 0>>::calc(rPoint);
+		result.hessian[0][1] = Transform<typename D0::template der<'x', 1>>::calc(rPoint);
+		result.hessian[1][0] = Transform<typename D1::template der<'x', 0>>::calc(rPoint);
+		result.hessian[1][1] = Transform<typename D1::template der<'x', 1>>::calc(rPoint);
+
+		return result;
+	}
+
+	template<typename T>
+	using Unchanged = T;
+
+	template<typename T>
+	using Simplified = SimplifyResult<T>;
+
+	template<typename Expr>
+	constexpr std::size_t NESTED_NODES = NodeCount<Expr>::value
+		+ NodeCount<typename Expr::template der<'x', 0>>::value
+		+ NodeCount<typename Expr::template der<'x', 1>>::value
+		+ NodeCount<typename Expr::template der<'x', 0>::template der<'x', 0>>::value
+		+ NodeCount<typename Expr::template der<'x', 0>::template der<'x', 1>>::value
+		+ NodeCount<typename Expr::template der<'x', 1>::template der<'x', 0>>::value
+		+ NodeCount<typename Expr::template der<'x', 1>::template der<'x', 1>>::value;
+
+	template<typename Func>
+	Measurement MeasureAll(const Points &rPoints, std::vector<Result> &rResult, Func func)
+	{
+		return Measure([&]
+		{
+			for (std::size_t i = 0; i < rPoints.size(); ++i)
+				rResult[i] = func(rPoints[i]);
+
+			DoNotOptimize(rResult);
+		});
+	}
+
+	double MaxError(const std::vector<Result> &rExpected, const std::vector<Result> &rActual)
+	{
+		double maxError = 0.0;
+		for (std::size_t i = 0; i < rExpected.size(); ++i)
+		{
+			maxError = std::fmax(maxError, std::abs(rExpected[i].value - rActual[i].value));
+			for (std::size_t j = 0; j < 2; ++j)
+			{
+				maxError = std::fmax(maxError, std::abs(rExpected[i].gradient[j] - rActual[i].gradient[j]));
+				for (std::size_t k = 0; k < 2; ++k)
+					maxError = std::fmax(maxError, std::abs(rExpected[i].hessian[j][k] - rActual[i].hessian[j][k]));
+			}
+		}
+
+		return maxError;
+	}
+
+	template<typename Expr>
+	void Compare(const char *pName, const Points &rPoints)
+	{
+		using Hessian = Symbolic::Hessian<Expr, X0, X1>;
+		using All = Sharing::Forest<JoinResult<TypeList<Expr>, typename Hessian::gradient::entries, typename Hessian::entries>>;
+
+		std::vector<Result> nested(rPoints.size()), simplified(rPoints.size()), fused(rPoints.size());
+
+		const auto nestedTime     = MeasureAll(rPoints, nested, CalcNested<Expr, Unchanged>);
+		const auto simplifiedTime = MeasureAll(rPoints, simplified, CalcNested<Expr, Simplified>);
+		const auto fusedTime      = MeasureAll(rPoints, fused, [](const Point &rPoint) { return Hessian::calcAll(rPoint); });
+
+		std::printf(" %s (%zu nodes in 7 nested trees, %zu unique nodes fused, max error = %g)\n", pName, NESTED_NODES<Expr>, All::SIZE,
+			std::fmax(MaxError(nested, simplified), MaxError(nested, fused)));
+		Report("nested der", nestedTime, rPoints.size());
+		Report("nested der, simplified", simplifiedTime, rPoints.size(), nestedTime.ns);
+		Report("Hessian::calcAll", fusedTime, rPoints.size(), nestedTime.ns);
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunHessian()
+{
+	std::printf("Value, gradient and Hessian\n");
+
+	const Points points(1u << 16);
+
+	Compare<decltype((Num<1> - x0) * (Num<1> - x0) + Num<100> * (x1 - x0 * x0) * (x1 - x0 * x0))>("Rosenbrock", points);
+	Compare<decltype(Sin(x0) * Cos(x1) + x0 * x1)>("sin(x0) * cos(x1) + x0 * x1", points);
+	Compare<decltype(Sin(x0) / (x0 * x1 + Ln(x1)))>("sin(x0) / (x0 * x1 + ln(x1))", points);
+}
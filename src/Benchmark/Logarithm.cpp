@@ -0,0 +1,111 @@
+#include "Benchmark.hpp"
+
+#include "../Logarithm/Logarithm.hpp"
+
+#include <vector> // std::vector
+
+using namespace Benchmark;
+
+namespace
+{
+	//====================================================================================================================================
+	//!
+	//! \brief	Recursion on x / 2, the runtime counterpart of the former recursive template with its base case fixed
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	int FloorLog2Recursive(T value)
+	{
+		return (value < 2 ? (value ? 0 : -1) : 1 + FloorLog2Recursive<T>(value / 2));
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Loop over the bits
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	int FloorLog2Loop(T value)
+	{
+		int result = -1;
+		for (; value; value >>= 1)
+			++result;
+
+		return result;
+	}
+
+	template<typename T>
+	void Compare(const char *pName, const std::vector<T> &rValues)
+	{
+		const std::size_t count = rValues.size();
+
+		std::vector<int> recursive(count), loop(count), scalar(count), batch(count), ceil(count);
+
+		const auto recursiveTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				recursive[i] = FloorLog2Recursive(rValues[i]);
+
+			DoNotOptimize(recursive);
+		});
+
+		const auto loopTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				loop[i] = FloorLog2Loop(rValues[i]);
+
+			DoNotOptimize(loop);
+		});
+
+		const auto scalarTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				scalar[i] = LogarithmEngine::FloorLog2(rValues[i]);
+
+			DoNotOptimize(scalar);
+		});
+
+		const auto batchTime = Measure([&]
+		{
+			LogarithmEngine::FloorLog2Batch(rValues.data(), batch.data(), count);
+
+			DoNotOptimize(batch);
+		});
+
+		const auto ceilTime = Measure([&]
+		{
+			LogarithmEngine::CeilLog2Batch(rValues.data(), ceil.data(), count);
+
+			DoNotOptimize(ceil);
+		});
+
+		std::printf(" %s (results %s)\n", pName, recursive == loop && loop == scalar && scalar == batch ? "equal" : "DIFFER");
+		Report("recursion on x / 2", recursiveTime, count);
+		Report("loop over the bits", loopTime, count, recursiveTime.ns);
+		Report("LogarithmEngine::FloorLog2", scalarTime, count, recursiveTime.ns);
+		Report("LogarithmEngine::FloorLog2Batch", batchTime, count, recursiveTime.ns);
+		Report("LogarithmEngine::CeilLog2Batch", ceilTime, count, recursiveTime.ns);
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunLogarithm()
+{
+	std::printf("Integer binary logarithms\n");
+
+	// magnitudes spread over every bit width, as bucket sizes and histogram values are
+	std::vector<std::uint32_t> narrow(1u << 14);
+	std::vector<std::uint64_t> wide(1u << 14);
+	for (std::size_t i = 0; i < narrow.size(); ++i)
+	{
+		const std::uint64_t random = (i + 1) * 0x9E3779B97F4A7C15ull;
+
+		narrow[i] = static_cast<std::uint32_t>(random >> 32) >> (i % 32);
+		wide[i] = random >> (i % 64);
+	}
+
+	Compare("32-bit values", narrow);
+	Compare("64-bit values", wide);
+}
@@ -0,0 +1,116 @@
+#include "Benchmark.hpp"
+#include "Points.hpp"
+
+#include "../Derivative/Native.hpp"
+#include "../Derivative/Symbolic.hpp"
+
+#include <chrono> // std::chrono::steady_clock
+#include <cmath>  // std::abs, std::fmax
+
+using namespace Simplification;
+using namespace Benchmark;
+
+namespace
+{
+	//====================================================================================================================================
+	//!
+	//! \brief	 Compares the recursive Node::calc, the program and the runtime interpreter with the compiled shared object
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr>
+	void Compare(const char *pName, const Points &rPoints, const Native::Options &rOptions)
+	{
+		const std::size_t count = rPoints.size();
+
+		const auto start = std::chrono::steady_clock::now();
+		const Native::Function native = Native::Compile<Expr>(rOptions);
+		const double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		const auto loadStart = std::chrono::steady_clock::now();
+		const Native::Function cached = Native::Compile<Expr>(rOptions);
+		const double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+
+		Runtime::Context context;
+		const Runtime::Program program = context.compile(context.parse(Printing::ToString<Expr>()));
+		std::vector<double> registers(program.registers);
+
+		std::vector<double> tree(count), interpreted(count), compiled(count), batch(count), nativeBatch(count);
+
+		const auto treeTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				tree[i] = Expr::calc(rPoints[i]);
+
+			DoNotOptimize(tree);
+		});
+
+		const auto interpretedTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const double variables[] = { rPoints.x0s[i], rPoints.x1s[i] };
+				interpreted[i] = program.calc(variables, registers.data());
+			}
+
+			DoNotOptimize(interpreted);
+		});
+
+		const auto compiledTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const double variables[] = { rPoints.x0s[i], rPoints.x1s[i] };
+				compiled[i] = native.calc(variables);
+			}
+
+			DoNotOptimize(compiled);
+		});
+
+		const auto batchTime = Measure([&]
+		{
+			Batching::CalcBatch<Expr>(rPoints, batch.data(), count);
+			DoNotOptimize(batch);
+		});
+
+		const double *const columns[] = { rPoints.x0s.data(), rPoints.x1s.data() };
+		const auto nativeBatchTime = Measure([&]
+		{
+			cached.calcBatch(columns, nativeBatch.data(), count);
+			DoNotOptimize(nativeBatch);
+		});
+
+		double maxError = 0.0;
+		for (std::size_t i = 0; i < count; ++i)
+			maxError = std::fmax(maxError, std::fmax(std::abs(tree[i] - compiled[i]), std::fmax(std::abs(tree[i] - nativeBatch[i]), std::abs(tree[i] - interpreted[i]))));
+
+		std::printf(" %s (%zu instructions, max error = %g, built in %.0f ms%s, loaded from the cache in %.2f ms)\n", pName, Lowering::Program<Expr>::SIZE,
+			maxError, buildSeconds * 1e3, native.built() ? "" : " (already cached)", loadSeconds * 1e3);
+		Report("Node::calc", treeTime, count);
+		Report("Runtime::Program::calc", interpretedTime, count, treeTime.ns);
+		Report("Native::Function::calc", compiledTime, count, treeTime.ns);
+		Report("Batching::CalcBatch", batchTime, count, treeTime.ns);
+		Report("Native::Function::calcBatch", nativeBatchTime, count, treeTime.ns);
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunNative()
+{
+	std::printf("C code compiled by the system compiler against calc\n");
+
+	const Points points(1u << 16);
+
+	Native::Options options;
+	options.directory = std::filesystem::temp_directory_path().append("derivative-native-benchmark");
+	std::filesystem::remove_all(options.directory);
+
+	using Quotient = decltype(Sin(x0) / (x0 * x1 + Ln(x1)));
+	using Root = decltype(Sqrt(x0 * x0 + Num<1>) / (Num<2> + Sin(x0 * x1)));
+
+	Compare<Symbolic::DerivativeResult<Quotient, X0>>("d/dx0 sin(x0) / (x0 * x1 + ln(x1))", points, options);
+	Compare<Symbolic::DerivativeResult<Symbolic::DerivativeResult<Quotient, X0>, X1>>("d2/dx0dx1 of the above", points, options);
+	Compare<Symbolic::DerivativeResult<Symbolic::DerivativeResult<Root, X0>, X0>>("d2/dx0^2 (x0 * x0 + 1) ^ (1 / 2) / (2 + sin(x0 * x1))", points, options);
+
+	std::filesystem::remove_all(options.directory);
+}
@@ -0,0 +1,145 @@
+#include "Benchmark.hpp"
+#include "Points.hpp"
+
+#include "../Derivative/Parallel.hpp"
+
+#include <algorithm> // std::max
+#include <cmath>     // std::abs, std::fmax
+#include <stdexcept> // std::invalid_argument
+#include <thread>    // std::thread
+#include <vector>    // std::vector
+
+using namespace Simplification;
+using namespace Benchmark;
+
+namespace
+{
+	using Expr = decltype(Sin(Ln(x0 + Num<2>)) * Cos(x0 * x1) + Sqrt(x0 * x0 + x1 * x1) / (Num<2> + Sin(x1)));
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Thread counts from 1 to the number of hardware threads, doubling, and the number of hardware threads itself
+	//!
+	//====================================================================================================================================
+
+	std::vector<std::size_t> ThreadCounts()
+	{
+		const std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+
+		std::vector<std::size_t> counts;
+		for (std::size_t threads = 1; threads < hardware; threads *= 2)
+			counts.push_back(threads);
+
+		counts.push_back(hardware);
+		return counts;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Runs calc for every thread count, the single-threaded Batching::CalcBatch is the baseline
+	//!
+	//====================================================================================================================================
+
+	template<typename Serial, typename Calc>
+	void Scale(const char *pName, std::size_t count, Serial serial, Calc calc)
+	{
+		const auto serialTime = Measure(serial);
+
+		std::printf(" %s, %zu points\n", pName, count);
+		Report("single thread, no pool", serialTime, count);
+
+		for (const std::size_t threads : ThreadCounts())
+		{
+			Parallel::ThreadPool pool(threads);
+
+			char name[64];
+			std::snprintf(name, sizeof(name), "%zu threads", threads);
+			Report(name, Measure([&] { calc(pool); }), count, serialTime.ns);
+		}
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Whether the column equals the expected one up to rounding, a point may take the SIMD path in one split and the scalar one in
+	//!			 the other
+	//!
+	//====================================================================================================================================
+
+	bool Matches(const std::vector<double> &rExpected, const double *pActual)
+	{
+		for (std::size_t i = 0; i < rExpected.size(); ++i)
+			if (!(std::abs(pActual[i] - rExpected[i]) <= 1e-12 * std::fmax(1.0, std::abs(rExpected[i]))))
+				return false;
+
+		return true;
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunParallel()
+{
+	constexpr std::size_t COUNT = 1u << 22;
+
+	std::printf("Parallel evaluation on %u hardware threads\n", std::thread::hardware_concurrency());
+
+	const Points points(COUNT);
+	std::vector<double> result(COUNT), d0(COUNT), d1(COUNT);
+	double *const pGradient[] = { d0.data(), d1.data() };
+
+	Scale("formula over a point set", COUNT,
+		[&] { Batching::CalcBatch<Expr>(points, result.data(), COUNT); DoNotOptimize(result); },
+		[&](Parallel::ThreadPool &rPool) { Parallel::CalcBatch<Expr>(rPool, points, result.data(), COUNT); DoNotOptimize(result); });
+
+	Scale("gradient over a point set", COUNT,
+		[&]
+		{
+			Batching::CalcBatch<Symbolic::DerivativeResult<Expr, X0>>(points, d0.data(), COUNT);
+			Batching::CalcBatch<Symbolic::DerivativeResult<Expr, X1>>(points, d1.data(), COUNT);
+			DoNotOptimize(d0);
+			DoNotOptimize(d1);
+		},
+		[&](Parallel::ThreadPool &rPool) { Parallel::CalcGradient<Expr, ErrorPolicy::Sticky, X0, X1>(rPool, points, pGradient, COUNT); DoNotOptimize(d0); DoNotOptimize(d1); });
+
+	const Parallel::Grid<X0, X1> grid({ { { 1.0, 2.0, 2048 }, { 1.0, 2.0, 2048 } } });
+
+	Scale("formula over a 2048 x 2048 grid", COUNT,
+		[&] { Parallel::ThreadPool pool(1); Parallel::CalcGrid<Expr>(pool, grid, result.data()); DoNotOptimize(result); },
+		[&](Parallel::ThreadPool &rPool) { Parallel::CalcGrid<Expr>(rPool, grid, result.data()); DoNotOptimize(result); });
+
+	Scale("gradient over a 2048 x 2048 grid", COUNT,
+		[&] { Parallel::ThreadPool pool(1); Parallel::CalcGridGradient<Expr>(pool, grid, pGradient); DoNotOptimize(d0); DoNotOptimize(d1); },
+		[&](Parallel::ThreadPool &rPool) { Parallel::CalcGridGradient<Expr>(rPool, grid, pGradient); DoNotOptimize(d0); DoNotOptimize(d1); });
+
+	// all threads against the single-threaded results, the outputs of a gradient in different positions of their cache lines
+	Parallel::ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()));
+	std::vector<double> e0(COUNT + 3), e1(COUNT + 3);
+	double *const pShifted[] = { e0.data() + 1, e1.data() + 3 };
+
+	Batching::CalcBatch<Symbolic::DerivativeResult<Expr, X0>>(points, d0.data(), COUNT);
+	Batching::CalcBatch<Symbolic::DerivativeResult<Expr, X1>>(points, d1.data(), COUNT);
+	Parallel::CalcGradient<Expr, ErrorPolicy::Sticky, X0, X1>(pool, points, pShifted, COUNT);
+	bool equal = Matches(d0, pShifted[0]) && Matches(d1, pShifted[1]);
+
+	Parallel::ThreadPool single(1);
+	Parallel::CalcGridGradient<Expr>(single, grid, pGradient);
+	Parallel::CalcGridGradient<Expr>(pool, grid, pShifted);
+	equal = equal && Matches(d0, pShifted[0]) && Matches(d1, pShifted[1]);
+
+	std::printf(" %zu threads against a single thread, outputs not aligned alike (results %s)\n", pool.size(), equal ? "equal" : "DIFFER");
+
+	// no points at an output which does not start a cache line, the chunk split once gave one chunk for them
+	result[1] = -1.0;
+	Parallel::CalcBatch<Expr>(pool, points, result.data() + 1, 0);
+
+	bool rejected = false;
+	try
+	{
+		Parallel::Grid<X0, X1>({ { { 0.0, 1.0, 0 }, { 0.0, 1.0, 4 } } });
+	}
+	catch (const std::invalid_argument&)
+	{
+		rejected = true;
+	}
+
+	std::printf(" empty point set, axis without steps (results %s)\n", result[1] == -1.0 && rejected ? "equal" : "DIFFER");
+}
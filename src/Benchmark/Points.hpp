@@ -0,0 +1,66 @@
+#pragma once
+
+#ifndef __POINTS_HPP_INCLUDED__
+#define __POINTS_HPP_INCLUDED__
+
+#include "../Derivative/Simplify.hpp"
+
+#include <cstddef> // std::size_t
+#include <vector>  // std::vector
+
+namespace Benchmark
+{
+	using X0 = Node<Variable<'x', 0>>;
+	using X1 = Node<Variable<'x', 1>>;
+
+	constexpr X0 x0;
+	constexpr X1 x1;
+
+	//====================================================================================================================================
+	//!
+	//! \brief	One point for Node::calc
+	//!
+	//====================================================================================================================================
+
+	struct Point
+	{
+		using value_type = double;
+
+		double x0, x1;
+
+		double operator()(X0) const noexcept { return x0; }
+		double operator()(X1) const noexcept { return x1; }
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Structure-of-arrays set of points
+	//!
+	//====================================================================================================================================
+
+	struct Points
+	{
+		std::vector<double> x0s, x1s;
+
+		explicit Points(std::size_t count) :
+			x0s(count),
+			x1s(count)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				x0s[i] = 1.0 + static_cast<double>(i % 1000) / 1000.0;
+				x1s[i] = 2.0 - static_cast<double>(i % 777) / 777.0;
+			}
+		}
+
+		std::size_t size() const noexcept { return x0s.size(); }
+
+		Point operator[](std::size_t i) const noexcept { return { x0s[i], x1s[i] }; }
+
+		const double* operator()(X0) const noexcept { return x0s.data(); }
+		const double* operator()(X1) const noexcept { return x1s.data(); }
+	};
+
+} // namespace Benchmark
+
+#endif /* __POINTS_HPP_INCLUDED__ */
@@ -0,0 +1,82 @@
+#include "Benchmark.hpp"
+#include "Points.hpp"
+
+#include "../Derivative/Batch.hpp"
+#include "../Derivative/Program.hpp"
+
+using namespace Simplification;
+using namespace Benchmark;
+
+namespace
+{
+	//====================================================================================================================================
+	//!
+	//! \brief	 Measures per-point and batch evaluation of the expression with every error policy
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr>
+	void Compare(const char *pName, const Points &rPoints)
+	{
+		const std::size_t count = rPoints.size();
+
+		std::vector<double> result(count);
+
+		const auto perPoint = [&](auto policy)
+		{
+			return Measure([&]
+			{
+				for (std::size_t i = 0; i < count; ++i)
+					result[i] = Expr::calc(rPoints[i], policy);
+
+				DoNotOptimize(result);
+			});
+		};
+
+		const auto batch = [&](auto policy)
+		{
+			return Measure([&]
+			{
+				Batching::CalcBatch<Expr>(rPoints, result.data(), count, policy);
+				policy.check();
+				DoNotOptimize(result);
+			});
+		};
+
+		const auto program = [&](auto policy)
+		{
+			return Measure([&]
+			{
+				Lowering::CalcBatch<Expr>(rPoints, result.data(), count, policy);
+				policy.check();
+				DoNotOptimize(result);
+			});
+		};
+
+		const auto throwingTime = perPoint(ErrorPolicy::Throwing{ });
+
+		std::printf(" %s (%zu nodes)\n", pName, NodeCount<Expr>::value);
+		Report("Node::calc, Throwing", throwingTime, count);
+		Report("Node::calc, Sticky", perPoint(ErrorPolicy::Sticky{ }), count, throwingTime.ns);
+		Report("Node::calc, Ieee", perPoint(ErrorPolicy::Ieee{ }), count, throwingTime.ns);
+		Report("Batching::CalcBatch, Throwing", batch(ErrorPolicy::Throwing{ }), count, throwingTime.ns);
+		Report("Batching::CalcBatch, Sticky", batch(ErrorPolicy::Sticky{ }), count, throwingTime.ns);
+		Report("Batching::CalcBatch, Ieee", batch(ErrorPolicy::Ieee{ }), count, throwingTime.ns);
+		Report("Lowering::CalcBatch, Throwing", program(ErrorPolicy::Throwing{ }), count, throwingTime.ns);
+		Report("Lowering::CalcBatch, Sticky", program(ErrorPolicy::Sticky{ }), count, throwingTime.ns);
+		Report("Lowering::CalcBatch, Ieee", program(ErrorPolicy::Ieee{ }), count, throwingTime.ns);
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunPolicy()
+{
+	std::printf("Error policies on division by zero\n");
+
+	const Points points(1u << 16);
+
+	using Rational = decltype(x0 / x1 + x1 / (x0 + x1));
+	Compare<Rational>("x0 / x1 + x1 / (x0 + x1)", points);
+	Compare<Rational::der<'x', 1>>("d/dx1 of the above", points);
+	Compare<Rational::der<'x', 1>::der<'x', 1>>("d2/dx1^2 of the above", points);
+}
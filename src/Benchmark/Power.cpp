@@ -0,0 +1,211 @@
+#include "Benchmark.hpp"
+
+#include "../Fibonacci/Fibonacci.hpp"
+#include "../Power/Power.hpp"
+
+#include <array>  // std::array
+#include <cmath>  // std::pow
+#include <vector> // std::vector
+
+using namespace Benchmark;
+
+namespace
+{
+	//====================================================================================================================================
+	//!
+	//! \brief	Random 64-bit numbers, the same on every run
+	//!
+	//====================================================================================================================================
+
+	std::vector<std::uint64_t> Random(std::size_t count, std::uint64_t seed)
+	{
+		std::vector<std::uint64_t> values(count);
+		for (auto &rValue : values)
+		{
+			seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+			rValue = seed ^ (seed >> 29);
+		}
+
+		return values;
+	}
+
+	void CompareModular(const char *pName, std::uint64_t mod)
+	{
+		const std::vector<std::uint64_t> bases = Random(1u << 12, mod), exponents = Random(1u << 12, ~mod);
+		const std::size_t count = bases.size();
+
+		std::vector<std::uint64_t> division(count), montgomery(count);
+
+		const auto divisionTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				division[i] = PowerEngine::PowMod(bases[i], exponents[i], mod);
+
+			DoNotOptimize(division);
+		});
+
+		const PowerEngine::Montgomery ring(mod);
+		const auto montgomeryTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				montgomery[i] = ring.pow(bases[i], exponents[i]);
+
+			DoNotOptimize(montgomery);
+		});
+
+		std::printf(" %s, 64-bit exponents (results %s)\n", pName, division == montgomery ? "equal" : "DIFFER");
+		Report("PowerEngine::PowMod, 128-bit division", divisionTime, count);
+		Report("PowerEngine::Montgomery::pow", montgomeryTime, count, divisionTime.ns);
+	}
+
+	void CompareFloating()
+	{
+		const std::vector<std::uint64_t> random = Random(1u << 14, 1);
+		const std::size_t count = random.size();
+
+		std::vector<double> bases(count);
+		std::vector<long long> exponents(count);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			bases[i] = 0.5 + static_cast<double>(random[i] >> 11) * 0x1.0p-53;
+			exponents[i] = static_cast<long long>(random[i] % 129) - 64;
+		}
+
+		std::vector<double> library(count), squaring(count);
+
+		const auto libraryTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				library[i] = std::pow(bases[i], static_cast<double>(exponents[i]));
+
+			DoNotOptimize(library);
+		});
+
+		const auto squaringTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				squaring[i] = PowerEngine::PowFloating(bases[i], exponents[i]);
+
+			DoNotOptimize(squaring);
+		});
+
+		double error = 0.0;
+		for (std::size_t i = 0; i < count; ++i)
+			error = std::fmax(error, std::fabs(squaring[i] / library[i] - 1.0));
+
+		std::printf(" double in [0.5, 1.5) ^ [-64, 64] (relative difference %.1e)\n", error);
+		Report("std::pow", libraryTime, count);
+		Report("PowerEngine::PowFloating", squaringTime, count, libraryTime.ns);
+	}
+
+	void CompareRecurrences()
+	{
+		constexpr std::uint64_t MOD = 1000000007;
+
+		const PowerEngine::Modular modular{ MOD };
+		const PowerEngine::Montgomery montgomery(MOD);
+
+		// Fibonacci numbers, where fast doubling is the specialised algorithm to compare with
+		{
+			const std::vector<std::uint64_t> indices = Random(1u << 10, 7);
+			const std::size_t count = indices.size();
+
+			std::vector<std::uint64_t> doubling(count), division(count), reduced(count);
+
+			const auto doublingTime = Measure([&]
+			{
+				for (std::size_t i = 0; i < count; ++i)
+					doubling[i] = FibonacciEngine::Calc(indices[i], MOD);
+
+				DoNotOptimize(doubling);
+			});
+
+			const auto divisionTime = Measure([&]
+			{
+				for (std::size_t i = 0; i < count; ++i)
+					division[i] = PowerEngine::Recurrence(modular, std::array<std::uint64_t, 2>{ 1, 1 }, std::array<std::uint64_t, 2>{ 1, 1 }, indices[i]);
+
+				DoNotOptimize(division);
+			});
+
+			const std::uint64_t one = montgomery.to(1);
+			const auto montgomeryTime = Measure([&]
+			{
+				for (std::size_t i = 0; i < count; ++i)
+					reduced[i] = montgomery.from(PowerEngine::Recurrence(montgomery, std::array<std::uint64_t, 2>{ one, one },
+						std::array<std::uint64_t, 2>{ one, one }, indices[i]));
+
+				DoNotOptimize(reduced);
+			});
+
+			std::printf(" Fibonacci modulo 1e9 + 7, 64-bit indices (results %s)\n", doubling == division && division == reduced ? "equal" : "DIFFER");
+			Report("FibonacciEngine::Calc, fast doubling", doublingTime, count);
+			Report("PowerEngine::Recurrence, Modular", divisionTime, count, doublingTime.ns);
+			Report("PowerEngine::Recurrence, Montgomery", montgomeryTime, count, doublingTime.ns);
+		}
+
+		// a(n) = a(n - 1) + 2 a(n - 2) + 3 a(n - 3) + 4 a(n - 4), against stepping through every term
+		{
+			constexpr std::array<std::uint64_t, 4> COEFFICIENTS = { 1, 2, 3, 4 };
+			constexpr std::array<std::uint64_t, 4> INITIAL = { 1, 1, 2, 3 };
+
+			std::vector<std::uint64_t> indices = Random(1u << 6, 11);
+			for (auto &rIndex : indices)
+				rIndex = 100000 + rIndex % 100000;
+
+			const std::size_t count = indices.size();
+
+			std::vector<std::uint64_t> stepping(count), reduced(count);
+
+			const auto steppingTime = Measure([&]
+			{
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					std::array<std::uint64_t, 4> terms = INITIAL;
+					for (std::uint64_t n = 4; n <= indices[i]; ++n)
+					{
+						std::uint64_t next = 0;
+						for (std::size_t j = 0; j < 4; ++j)
+							next = modular.add(next, modular.multiply(COEFFICIENTS[j], terms[(n - 1 - j) % 4]));
+
+						terms[n % 4] = next;
+					}
+
+					stepping[i] = terms[indices[i] % 4];
+				}
+
+				DoNotOptimize(stepping);
+			});
+
+			std::array<std::uint64_t, 4> coefficients{ }, initial{ };
+			for (std::size_t j = 0; j < 4; ++j)
+			{
+				coefficients[j] = montgomery.to(COEFFICIENTS[j]);
+				initial[j] = montgomery.to(INITIAL[j]);
+			}
+
+			const auto montgomeryTime = Measure([&]
+			{
+				for (std::size_t i = 0; i < count; ++i)
+					reduced[i] = montgomery.from(PowerEngine::Recurrence(montgomery, coefficients, initial, indices[i]));
+
+				DoNotOptimize(reduced);
+			});
+
+			std::printf(" order 4 recurrence modulo 1e9 + 7, n in [1e5, 2e5) (results %s)\n", stepping == reduced ? "equal" : "DIFFER");
+			Report("stepping through every term", steppingTime, count);
+			Report("PowerEngine::Recurrence, Montgomery", montgomeryTime, count, steppingTime.ns);
+		}
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunPower()
+{
+	std::printf("Exponentiation by squaring\n");
+
+	CompareModular("modulo 1e9 + 7", 1000000007);
+	CompareModular("modulo 2^61 - 1", (1ull << 61) - 1);
+	CompareFloating();
+	CompareRecurrences();
+}
@@ -0,0 +1,94 @@
+#include "Benchmark.hpp"
+#include "Points.hpp"
+
+#include "../Derivative/Profiling.hpp"
+
+#include <cmath>   // std::isnan, std::abs, std::fmax
+#include <cstring> // std::memcmp
+
+using namespace Simplification;
+using namespace Benchmark;
+
+namespace
+{
+	//====================================================================================================================================
+	//!
+	//! \brief	 Measures Node::calc of the expression without profiling, with the disabled and with the enabled policy
+	//!
+	//! \param   pName    Name of the case
+	//! \param   rPoints  Points to evaluate
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr>
+	void Compare(const char *pName, const Points &rPoints)
+	{
+		const std::size_t count = rPoints.size();
+
+		std::vector<double> plain(count), disabled(count), enabled(count);
+
+		const auto plainTime = Measure([&]
+		{
+			ErrorPolicy::Ieee policy;
+			for (std::size_t i = 0; i < count; ++i)
+				plain[i] = Expr::calc(rPoints[i], policy);
+
+			DoNotOptimize(plain);
+		});
+
+		const auto disabledTime = Measure([&]
+		{
+			Profiling::Policy<ErrorPolicy::Ieee, false> policy;
+			for (std::size_t i = 0; i < count; ++i)
+				disabled[i] = Expr::calc(rPoints[i], policy);
+
+			DoNotOptimize(disabled);
+		});
+
+		const auto enabledTime = Measure([&]
+		{
+			Profiling::Policy<ErrorPolicy::Ieee> policy;
+			for (std::size_t i = 0; i < count; ++i)
+				enabled[i] = Expr::calc(rPoints[i], policy);
+
+			DoNotOptimize(enabled);
+		});
+
+		// the disabled policy must give the same bits, NaN included. Profiled nodes are not contracted into FMA with their parents,
+		// so the enabled one may differ in the last bit
+		const bool same = !std::memcmp(plain.data(), disabled.data(), count * sizeof(double));
+
+		double maxError = 0.0;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			if (!std::isnan(plain[i]) || !std::isnan(enabled[i]))
+				maxError = std::fmax(maxError, std::abs(enabled[i] - plain[i]) / std::fmax(1.0, std::abs(plain[i])));
+		}
+
+		std::printf(" %s (%zu nodes, disabled %s, enabled max relative error = %g)\n", pName, NodeCount<Expr>::value,
+			same ? "bitwise equal" : "DIFFERS", maxError);
+		Report("Node::calc, Ieee", plainTime, count);
+		Report("Node::calc, Profiling::Policy disabled", disabledTime, count, plainTime.ns);
+		Report("Node::calc, Profiling::Policy enabled", enabledTime, count, plainTime.ns);
+
+		// one more pass alone, so the counts are the ones of count points
+		Profiling::Clear();
+		Profiling::Policy<ErrorPolicy::Ieee> policy;
+		for (std::size_t i = 0; i < count; ++i)
+			enabled[i] = Expr::calc(rPoints[i], policy);
+
+		std::printf("%s", Profiling::Dump(5).c_str());
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunProfiling()
+{
+	std::printf("Per-node profiling of Node::calc\n");
+
+	const Points points(1u << 14);
+
+	using Quotient = decltype(Sin(x0) / (x0 * x1 + Ln(x1 - x0)));
+	Compare<Quotient>("sin(x0) / (x0 * x1 + ln(x1 - x0))", points);
+	Compare<SimplifyResult<Quotient::der<'x', 0>::der<'x', 1>>>("d2/dx0dx1 of the above, simplified", points);
+}
@@ -0,0 +1,104 @@
+#include "Benchmark.hpp"
+#include "Points.hpp"
+
+#include "../Derivative/Batch.hpp"
+#include "../Derivative/Dag.hpp"
+#include "../Derivative/Program.hpp"
+
+#include <cmath> // std::abs, std::fmax
+
+using namespace Simplification;
+using namespace Benchmark;
+
+namespace
+{
+	double MaxError(const std::vector<double> &rExpected, const std::vector<double> &rActual)
+	{
+		double maxError = 0.0;
+		for (std::size_t i = 0; i < rExpected.size(); ++i)
+			maxError = std::fmax(maxError, std::abs(rExpected[i] - rActual[i]));
+
+		return maxError;
+	}
+
+	template<typename Expr>
+	void Compare(const char *pName, const Points &rPoints)
+	{
+		using Code = Lowering::Program<Expr>;
+
+		const std::size_t count = rPoints.size();
+
+		std::vector<double> tree(count), dag(count), program(count), interpreted(count), batch(count), programBatch(count);
+
+		const auto treeTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				tree[i] = Expr::calc(rPoints[i]);
+
+			DoNotOptimize(tree);
+		});
+
+		const auto dagTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				dag[i] = Sharing::Dag<Expr>::calc(rPoints[i]);
+
+			DoNotOptimize(dag);
+		});
+
+		const auto programTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				program[i] = Code::calc(rPoints[i]);
+
+			DoNotOptimize(program);
+		});
+
+		const auto interpretedTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				interpreted[i] = Code::interpret(rPoints[i]);
+
+			DoNotOptimize(interpreted);
+		});
+
+		const auto batchTime = Measure([&]
+		{
+			Batching::CalcBatch<Expr>(rPoints, batch.data(), count);
+
+			DoNotOptimize(batch);
+		});
+
+		const auto programBatchTime = Measure([&]
+		{
+			Lowering::CalcBatch<Expr>(rPoints, programBatch.data(), count);
+
+			DoNotOptimize(programBatch);
+		});
+
+		std::printf(" %s (%zu tree nodes, %zu instructions, %zu registers, max |calc - program| = %g)\n", pName, NodeCount<Expr>::value, Code::SIZE,
+			Code::REGISTERS, std::fmax(MaxError(tree, program), std::fmax(MaxError(tree, interpreted), MaxError(tree, programBatch))));
+		Report("Node::calc", treeTime, count);
+		Report("Dag::calc", dagTime, count, treeTime.ns);
+		Report("Program::calc", programTime, count, treeTime.ns);
+		Report("Program::interpret", interpretedTime, count, treeTime.ns);
+		Report("Batching::CalcBatch", batchTime, count, treeTime.ns);
+		Report("Lowering::CalcBatch", programBatchTime, count, treeTime.ns);
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunProgram()
+{
+	std::printf("Instruction program and interpreter\n");
+
+	const Points points(1u << 16);
+
+	using Polynomial = decltype(x0 * x0 * x1 + x0 * x1 - x1 / (x0 + x1));
+	using Quotient = decltype(Sin(x0) / (x0 * x1 + Ln(x1)));
+
+	Compare<Polynomial>("x0 * x0 * x1 + x0 * x1 - x1 / (x0 + x1)", points);
+	Compare<Polynomial::der<'x', 0>::der<'x', 1>>("d2/dx0dx1 of the above", points);
+	Compare<Quotient::der<'x', 0>>("d/dx0 sin(x0) / (x0 * x1 + ln(x1))", points);
+	Compare<Quotient::der<'x', 0>::der<'x', 1>>("d2/dx0dx1 of the above", points);
+}
@@ -0,0 +1,204 @@
+#include "Benchmark.hpp"
+
+#include "../Derivative/Runtime.hpp"
+
+#include <cmath>     // std::abs, std::fmax
+#include <limits>    // std::numeric_limits
+#include <stdexcept> // std::invalid_argument
+
+using namespace Benchmark;
+
+namespace
+{
+	//====================================================================================================================================
+	//!
+	//! \brief	 Formula as it would come from configuration: terms with shared subexpressions and distinct constants
+	//!
+	//====================================================================================================================================
+
+	std::string MakeFormula(int terms)
+	{
+		std::string formula = "0";
+		for (int k = 1; k <= terms; ++k)
+		{
+			const std::string number = std::to_string(k);
+			formula += " + sin(x_0 * " + number + " + x_1) * ln(x_1 + " + number + ") / (x_0 ^ 2 + " + number + ")";
+		}
+
+		return formula;
+	}
+
+	using X0 = Node<Variable<'x', 0>>;
+	using X1 = Node<Variable<'x', 1>>;
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Whether Context::parse reads Node::dump of Expr back into the same tree, i.e. the same text is dumped again
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr>
+	bool RoundTrips(Runtime::Context &rContext)
+	{
+		const std::string text = Expr::dump();
+		const std::string again = Runtime::Context::dump(rContext.parse(text));
+		if (again != text)
+			std::printf("  \"%s\" is read back as \"%s\"\n", text.c_str(), again.c_str());
+
+		return (again == text);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Whether Context::simplify of Expr gives the tree of Simplification::SimplifyResult, the cost-driven rules included
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr>
+	bool SimplifiesAlike(Runtime::Context &rContext)
+	{
+		const std::string expected = Simplification::SimplifyResult<Expr>::dump();
+		const std::string actual = Runtime::Context::dump(rContext.simplify(rContext.parse(Expr::dump())));
+		if (actual != expected)
+			std::printf("  \"%s\" is simplified to \"%s\" at compile time, \"%s\" at run time\n", Expr::dump().c_str(), expected.c_str(), actual.c_str());
+
+		return (actual == expected);
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunRuntime()
+{
+	std::printf("Runtime expressions\n");
+
+	const std::string formula = MakeFormula(600);
+
+	Runtime::Context context;
+	const Runtime::Expression *pFormula = context.parse(formula);
+	const Runtime::Expression *pDerivative = context.derivative(pFormula, 'x', 0);
+	const Runtime::Expression *pSimplified = context.simplify(pDerivative);
+
+	const std::size_t nodes = context.treeSize(pFormula);
+
+	// negative constants and negations as bases, exponents and operands, the minimum of llong_t included
+	const bool roundTrips =
+		RoundTrips<Node<WrapPow, Node<Number<-2>>, Node<Number<2>>>>(context) &
+		RoundTrips<Node<WrapPow, Node<WrapNeg, X0>, Node<Number<2>>>>(context) &
+		RoundTrips<Node<WrapNeg, Node<WrapPow, X0, Node<Number<2>>>>>(context) &
+		RoundTrips<Node<WrapPow, Node<Number<-3>>, Node<WrapPow, X1, Node<Number<-1>>>>>(context) &
+		RoundTrips<Node<WrapMul, Node<WrapNeg, Node<Number<-2>>>, Node<WrapSub, X0, Node<Number<-7>>>>>(context) &
+		RoundTrips<Node<WrapDiv, Node<WrapSin, Node<Number<-1>>>, Node<Number<std::numeric_limits<llong_t>::min()>>>>(context) &
+		(Runtime::Context::dump(context.parse(Runtime::Context::dump(pSimplified))) == Runtime::Context::dump(pSimplified));
+
+	std::printf(" dump -> parse -> dump with negative constants: %s\n", roundTrips ? "equal" : "DIFFER");
+
+	// a sum nested a million parentheses deep and a negation chain of the same depth read back, an index beyond int rejected
+	Runtime::Context deepContext;
+	const Runtime::Expression *pDeep = deepContext.variable('x', 1);
+	for (int k = 0; k < 1000000; ++k)
+		pDeep = deepContext.binary(BinaryFunction::ADD, pDeep, deepContext.unary(UnaryFunction::NEG, deepContext.number(k % 7)));
+	const std::string deep = Runtime::Context::dump(pDeep);
+	bool deepEqual = (deepContext.parse(deep) == pDeep) && (deepContext.parse(std::string(1000000, '-') + "x_1") != nullptr);
+
+	try
+	{
+		deepContext.parse("x_0 + x_4294967296");
+		deepEqual = false;
+	}
+	catch (const std::invalid_argument&)
+	{
+	}
+
+	std::printf(" %zu characters deep expression, variable index beyond int (results %s)\n", deep.size(), deepEqual ? "equal" : "DIFFER");
+
+	// powers by multiplication and factoring only where the cost model finds them cheaper, nested and in both operand orders
+	using SinX1 = Node<WrapSin, X1>;
+	const bool alike =
+		SimplifiesAlike<Node<WrapAdd, Node<WrapMul, X0, X1>, Node<WrapMul, X0, SinX1>>>(context) &
+		SimplifiesAlike<Node<WrapSub, Node<WrapMul, SinX1, X0>, Node<WrapMul, X1, X0>>>(context) &
+		SimplifiesAlike<Node<WrapAdd, Node<WrapMul, X0, X1>, Node<WrapMul, X0, X1>>>(context) &
+		SimplifiesAlike<Node<WrapAdd, Node<WrapMul, X0, X1>, Node<WrapMul, X1, X0>>>(context) &
+		SimplifiesAlike<Node<WrapPow, X0, Node<Number<3>>>>(context) &
+		SimplifiesAlike<Node<WrapPow, X0, Node<Number<12>>>>(context) &
+		SimplifiesAlike<Node<WrapPow, SinX1, Node<Number<2>>>>(context) &
+		SimplifiesAlike<Node<WrapPow, Node<WrapLn, X1>, Node<Number<7>>>>(context) &
+		SimplifiesAlike<Node<WrapAdd, Node<WrapMul, X0, Node<WrapPow, X1, Node<Number<2>>>>, Node<WrapMul, X0, Node<WrapPow, X1, Node<Number<3>>>>>>(context) &
+		SimplifiesAlike<Node<WrapSub, Node<WrapMul, Node<WrapMul, X0, X1>, SinX1>, Node<WrapMul, Node<WrapMul, X0, X1>, Node<WrapCos, X1>>>>(context);
+
+	std::printf(" simplify at run time and at compile time: %s\n", alike ? "equal" : "DIFFER");
+
+	std::printf(" %zu-term formula: %zu tree nodes, %zu unique; d/dx0 %zu tree nodes, simplified %zu, %zu unique nodes in the context\n", std::size_t{ 600 },
+		nodes, context.postOrder(pFormula).size(), context.treeSize(pDerivative), context.treeSize(pSimplified), context.size());
+	std::printf(" arena: %zu bytes in %zu chunks\n", context.arena().bytes(), context.arena().chunks());
+
+	// every run starts from an empty context, so the cost of creating the nodes is included
+	const auto parseTime = Measure([&]
+	{
+		Runtime::Context fresh;
+		DoNotOptimize(fresh.parse(formula));
+	});
+
+	const auto derivativeTime = Measure([&]
+	{
+		Runtime::Context fresh;
+		DoNotOptimize(fresh.derivative(fresh.parse(formula), 'x', 0));
+	});
+
+	const auto simplifyTime = Measure([&]
+	{
+		Runtime::Context fresh;
+		DoNotOptimize(fresh.simplify(fresh.derivative(fresh.parse(formula), 'x', 0)));
+	});
+
+	const auto compileTime = Measure([&]
+	{
+		Runtime::Context fresh;
+		const auto program = fresh.compile(fresh.simplify(fresh.derivative(fresh.parse(formula), 'x', 0)));
+		DoNotOptimize(program);
+	});
+
+	std::printf(" whole pipeline: parse %.3f ms, + derivative %.3f ms, + simplify %.3f ms, + compile %.3f ms\n", parseTime.ns * 1e-6,
+		derivativeTime.ns * 1e-6, simplifyTime.ns * 1e-6, compileTime.ns * 1e-6);
+	Report("parse", parseTime, nodes);
+	Report("parse + derivative", derivativeTime, nodes);
+	Report("parse + derivative + simplify", simplifyTime, nodes);
+	Report("parse + derivative + simplify + compile", compileTime, nodes);
+
+	const Runtime::Program program = context.compile(pSimplified);
+
+	const std::size_t count = 1u << 12;
+	std::vector<double> x0s(count), x1s(count), perPoint(count), batch(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		x0s[i] = 1.0 + static_cast<double>(i % 1000) / 1000.0;
+		x1s[i] = 2.0 - static_cast<double>(i % 777) / 777.0;
+	}
+
+	const double *columns[] = { x0s.data(), x1s.data() };
+
+	std::vector<double> registers(program.registers);
+	const auto perPointTime = Measure([&]
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			const double variables[] = { x0s[i], x1s[i] };
+			perPoint[i] = program.calc(variables, registers.data());
+		}
+
+		DoNotOptimize(perPoint);
+	});
+
+	const auto batchTime = Measure([&]
+	{
+		program.calcBatch(columns, batch.data(), count);
+		DoNotOptimize(batch);
+	});
+
+	double maxError = 0.0;
+	for (std::size_t i = 0; i < count; ++i)
+		maxError = std::fmax(maxError, std::abs(perPoint[i] - batch[i]));
+
+	std::printf(" d/dx0: %zu instructions, %zu registers (max |calc - calcBatch| = %g)\n", program.code.size(), program.registers, maxError);
+	Report("Program::calc", perPointTime, count);
+	Report("Program::calcBatch", batchTime, count, perPointTime.ns);
+}
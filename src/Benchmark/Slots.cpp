@@ -0,0 +1,130 @@
+#include "Benchmark.hpp"
+#include "Points.hpp"
+
+#include "../Derivative/Variables.hpp"
+
+#include <map>     // std::map
+#include <utility> // std::pair
+
+using namespace Simplification;
+using namespace Benchmark;
+
+namespace
+{
+	using Y0 = Node<Variable<'y', 0>>;
+	using Y1 = Node<Variable<'y', 1>>;
+
+	constexpr Y0 y0;
+	constexpr Y1 y1;
+
+	using Expr = decltype(Sin(x0 * y1) + x1 * y0 / (Num<2> + Cos(x0 + y0)) - y1 * x1);
+	using Layout = Slots<VariablesOfResult<Expr>>;
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Functor which looks the variable up in a map, as a caller without the slot table would write it
+	//!
+	//====================================================================================================================================
+
+	struct MapValues
+	{
+		using value_type = double;
+
+		const std::map<std::pair<char, int>, double> &rValues;
+
+		template<char NAME, int INDEX>
+		double operator()(Node<Variable<NAME, INDEX>>) const { return rValues.at({ NAME, INDEX }); }
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Functor which switches on the name and the index at run time
+	//!
+	//====================================================================================================================================
+
+	struct SwitchValues
+	{
+		using value_type = double;
+
+		const double *pX;
+		const double *pY;
+
+		template<char NAME, int INDEX>
+		double operator()(Node<Variable<NAME, INDEX>>) const noexcept
+		{
+			volatile char name = NAME;
+			switch (name)
+			{
+			case 'x': return pX[INDEX];
+			case 'y': return pY[INDEX];
+			default:  return 0.0;
+			}
+		}
+	};
+
+} // anonymous namespace
+
+void Benchmark::RunSlots()
+{
+	constexpr std::size_t COUNT = 1u << 16;
+
+	std::printf("Variable lookup: map, switch and dense slots (");
+	for (const auto &rInfo : Layout::table)
+		std::printf(" %c%d", rInfo.name, rInfo.index);
+	std::printf(" )\n");
+
+	const Points points(COUNT);
+
+	std::vector<std::array<double, Layout::SIZE>> dense(COUNT);
+	for (std::size_t i = 0; i < COUNT; ++i)
+	{
+		dense[i][Layout::slot<X0>] = points.x0s[i];
+		dense[i][Layout::slot<X1>] = points.x1s[i];
+		dense[i][Layout::slot<Y0>] = points.x0s[i] * 0.5;
+		dense[i][Layout::slot<Y1>] = points.x1s[i] * 0.5;
+	}
+
+	std::vector<double> mapped(COUNT), switched(COUNT), slotted(COUNT);
+
+	const auto mapTime = Measure([&]
+	{
+		std::map<std::pair<char, int>, double> values;
+		for (std::size_t i = 0; i < COUNT; ++i)
+		{
+			values[{ 'x', 0 }] = dense[i][Layout::slot<X0>];
+			values[{ 'x', 1 }] = dense[i][Layout::slot<X1>];
+			values[{ 'y', 0 }] = dense[i][Layout::slot<Y0>];
+			values[{ 'y', 1 }] = dense[i][Layout::slot<Y1>];
+			mapped[i] = Expr::calc(MapValues{ values });
+		}
+
+		DoNotOptimize(mapped);
+	});
+
+	const auto switchTime = Measure([&]
+	{
+		for (std::size_t i = 0; i < COUNT; ++i)
+		{
+			const double x[] = { dense[i][Layout::slot<X0>], dense[i][Layout::slot<X1>] };
+			const double y[] = { dense[i][Layout::slot<Y0>], dense[i][Layout::slot<Y1>] };
+			switched[i] = Expr::calc(SwitchValues{ x, y });
+		}
+
+		DoNotOptimize(switched);
+	});
+
+	const auto slotTime = Measure([&]
+	{
+		for (std::size_t i = 0; i < COUNT; ++i)
+			slotted[i] = CalcDense<Expr>(dense[i]);
+
+		DoNotOptimize(slotted);
+	});
+
+	const bool same = (mapped == switched && switched == slotted);
+
+	std::printf(" %s (results %s)\n", "sin(x0 * y1) + x1 * y0 / (2 + cos(x0 + y0)) - y1 * x1", same ? "equal" : "DIFFER");
+	Report("std::map functor", mapTime, COUNT);
+	Report("switch functor", switchTime, COUNT, mapTime.ns);
+	Report("CalcDense", slotTime, COUNT, mapTime.ns);
+}
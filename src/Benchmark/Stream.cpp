@@ -0,0 +1,171 @@
+#include "Benchmark.hpp"
+#include "Points.hpp"
+
+#include "../Derivative/Stream.hpp"
+
+#include <cmath>      // std::signbit
+#include <cstdint>    // std::uint64_t
+#include <cstdio>     // std::remove
+#include <cstdlib>    // std::strtod
+#include <cstring>    // std::memcpy, std::strlen
+#include <filesystem> // std::filesystem::temp_directory_path
+#include <stdexcept>  // std::invalid_argument
+
+using namespace Simplification;
+using namespace Benchmark;
+
+namespace
+{
+	using Expr = decltype(Sin(Ln(x0 + Num<2>)) * Cos(x0 * x1) + Sqrt(x0 * x0 + x1 * x1) / (Num<2> + Sin(x1)));
+	using Outputs = Streaming::WithGradient<Expr, X0, X1>;
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Reports time per row and the input bytes per second
+	//!
+	//====================================================================================================================================
+
+	void ReportStream(const char *pName, const Measurement &rMeasurement, std::uint64_t rows, std::uint64_t bytes, double baselineNs = 0.0)
+	{
+		Report(pName, rMeasurement, static_cast<std::size_t>(rows), baselineNs);
+		std::printf("  %-48s %10.3f GB/s of input\n", "", static_cast<double>(bytes) / rMeasurement.ns);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Reads the whole columnar file into vectors and calculates it at once, what the streaming evaluator replaces
+	//!
+	//====================================================================================================================================
+
+	void LoadAndCalc(const char *pInput, const char *pOutput, std::uint64_t rows)
+	{
+		Points points(static_cast<std::size_t>(rows));
+
+		Streaming::File input(pInput, "rb");
+		char header[Streaming::HEADER_SIZE];
+		input.read(header, sizeof(header));
+		input.read(points.x0s.data(), rows * sizeof(double));
+		input.read(points.x1s.data(), rows * sizeof(double));
+
+		std::vector<double> value(rows), d0(rows), d1(rows);
+		double *const pResults[] = { value.data(), d0.data(), d1.data() };
+		ErrorPolicy::Sticky policy;
+		Parallel::Outputs<Outputs>::calc(points, pResults, 0, static_cast<std::size_t>(rows), policy);
+
+		Streaming::ColumnarWriter output(pOutput, Outputs::size, rows);
+		for (std::size_t k = 0; k < Outputs::size; ++k)
+			output.write(k, 0, pResults[k], static_cast<std::size_t>(rows));
+
+		output.flush();
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunStream()
+{
+	constexpr std::uint64_t COLUMNAR_ROWS = 1u << 23;
+	constexpr std::uint64_t CSV_ROWS = 1u << 21;
+
+	const auto directory = std::filesystem::temp_directory_path();
+	const std::string columnar = std::filesystem::path(directory).append("derivative_stream_input.bin").string();
+	const std::string csv = std::filesystem::path(directory).append("derivative_stream_input.csv").string();
+	const std::string output = std::filesystem::path(directory).append("derivative_stream_output").string();
+
+	std::printf("Streaming the formula and its gradient over files\n");
+
+	{
+		const Points points(static_cast<std::size_t>(COLUMNAR_ROWS));
+
+		Streaming::ColumnarWriter writer(columnar.c_str(), 2, COLUMNAR_ROWS);
+		writer.write(0, 0, points.x0s.data(), points.size());
+		writer.write(1, 0, points.x1s.data(), points.size());
+		writer.flush();
+
+		Streaming::File file(csv.c_str(), "wb");
+		file.write("x0,x1\n", 6);
+
+		char line[80];
+		for (std::size_t i = 0; i < CSV_ROWS; ++i)
+		{
+			char *pLine = Streaming::FormatDouble(line, points.x0s[i] + 1e-7 * static_cast<double>(i));
+			*pLine++ = ',';
+			pLine = Streaming::FormatDouble(pLine, points.x1s[i]);
+			*pLine++ = '\n';
+			file.write(line, static_cast<std::size_t>(pLine - line));
+		}
+	}
+
+	const std::uint64_t columnarBytes = COLUMNAR_ROWS * 2 * sizeof(double);
+
+	std::printf(" columnar, %llu rows, %llu MiB, chunks of %zu rows\n", static_cast<unsigned long long>(COLUMNAR_ROWS), static_cast<unsigned long long>(columnarBytes >> 20), Streaming::CHUNK_ROWS);
+
+	const auto loadTime = Measure([&] { LoadAndCalc(columnar.c_str(), output.c_str(), COLUMNAR_ROWS); }, 1.0);
+	ReportStream("load into vectors, then calculate", loadTime, COLUMNAR_ROWS, columnarBytes);
+
+	const auto mappedTime = Measure([&] { Streaming::EvaluateColumnar<Outputs>(columnar.c_str(), output.c_str()); }, 1.0);
+	ReportStream("Streaming::EvaluateColumnar", mappedTime, COLUMNAR_ROWS, columnarBytes, loadTime.ns);
+
+	Streaming::Statistics statistics;
+	const auto csvTime = Measure([&] { statistics = Streaming::EvaluateCsv<Outputs>(csv.c_str(), output.c_str()); }, 1.0);
+
+	std::printf(" CSV, %llu rows, %llu MiB\n", static_cast<unsigned long long>(statistics.rows), static_cast<unsigned long long>(statistics.bytesRead >> 20));
+	ReportStream("Streaming::EvaluateCsv", csvTime, statistics.rows, statistics.bytesRead);
+
+	using Cheap = TypeList<decltype(x0 * x1 + x0)>;
+
+	std::printf(" x0 * x1 + x0 alone, bound by reading and writing\n");
+	ReportStream("Streaming::EvaluateColumnar", Measure([&] { Streaming::EvaluateColumnar<Cheap>(columnar.c_str(), output.c_str()); }, 1.0), COLUMNAR_ROWS, columnarBytes);
+	ReportStream("Streaming::EvaluateCsv", Measure([&] { Streaming::EvaluateCsv<Cheap>(csv.c_str(), output.c_str()); }, 1.0), statistics.rows, statistics.bytesRead);
+
+	// rows of a crafted header whose column offsets wrap around to the size of the file, and chunks without rows
+	const std::string crafted = std::filesystem::path(directory).append("derivative_stream_crafted.bin").string();
+	{
+		Streaming::ColumnarHeader header{ { }, 2, (std::uint64_t{ 1 } << 61) + 1 };
+		std::memcpy(header.magic, Streaming::COLUMNAR_MAGIC, sizeof(header.magic));
+
+		char bytes[Streaming::HEADER_SIZE + 2 * sizeof(double)] = { };
+		std::memcpy(bytes, &header, sizeof(header));
+
+		Streaming::File file(crafted.c_str(), "wb");
+		file.write(bytes, sizeof(bytes));
+	}
+
+	const auto rejects = [](auto evaluate)
+	{
+		try
+		{
+			evaluate();
+		}
+		catch (const std::invalid_argument&)
+		{
+			return true;
+		}
+
+		return false;
+	};
+
+	const bool rejected =
+		rejects([&] { Streaming::EvaluateColumnar<Cheap>(crafted.c_str(), output.c_str()); }) &&
+		rejects([&] { Streaming::EvaluateColumnar<Cheap>(columnar.c_str(), output.c_str(), 0); }) &&
+		rejects([&] { Streaming::EvaluateCsv<Cheap>(csv.c_str(), output.c_str(), 0); });
+
+	std::printf(" crafted row count, chunks without rows (results %s)\n", rejected ? "equal" : "DIFFER");
+
+	// fields beyond the range of double as std::strtod reads them, whichever branch ParseDouble takes
+	bool sameAsStrtod = true;
+	for (const char *pField : { "1e400", "-1e400", "+1e400", "1e-400", "-1e-400", "10000e305", "-0.001e-321", "0.000000001e-320", "1e-2147483649", "2.5e1" })
+	{
+		double value = 0.0;
+		const double expected = std::strtod(pField, nullptr);
+		Streaming::ParseDouble(pField, pField + std::strlen(pField), value);
+
+		sameAsStrtod = sameAsStrtod && value == expected && std::signbit(value) == std::signbit(expected);
+	}
+
+	std::printf(" doubles beyond the range of double (results %s)\n", sameAsStrtod ? "equal" : "DIFFER");
+
+	std::remove(crafted.c_str());
+	std::remove(columnar.c_str());
+	std::remove(csv.c_str());
+	std::remove(output.c_str());
+}
@@ -0,0 +1,79 @@
+#include "Benchmark.hpp"
+#include "Points.hpp"
+
+#include "../Derivative/Taylor.hpp"
+
+#include <cmath> // std::abs, std::fmax
+
+using namespace Simplification;
+using namespace Benchmark;
+
+namespace
+{
+	//====================================================================================================================================
+	//!
+	//! \brief	 Compares Node::calc with the Taylor polynomial of order ORDER by x0 on [center - radius, center + radius], the results
+	//!			 are equal if the error stays within Taylor::errorBound
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, std::size_t ORDER>
+	void Compare(const char *pName, double center, double radius)
+	{
+		constexpr std::size_t COUNT = 1u << 16;
+
+		Points points(COUNT);
+		for (std::size_t i = 0; i < COUNT; ++i)
+			points.x0s[i] = center - radius + 2 * radius * static_cast<double>(i) / (COUNT - 1);
+
+		const Approximation::Taylor<Expr, X0, ORDER> taylor(Point{ center, points.x1s[0] }, radius);
+
+		std::vector<double> exact(COUNT), approximate(COUNT), batch(COUNT);
+
+		const auto exactTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < COUNT; ++i)
+				exact[i] = Expr::calc(Point{ points.x0s[i], points.x1s[0] });
+
+			DoNotOptimize(exact);
+		});
+
+		const auto approximateTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < COUNT; ++i)
+				approximate[i] = taylor.calc(points.x0s[i]);
+
+			DoNotOptimize(approximate);
+		});
+
+		const auto batchTime = Measure([&]
+		{
+			taylor.calcBatch(points.x0s.data(), batch.data(), COUNT);
+			DoNotOptimize(batch);
+		});
+
+		double maxError = 0.0;
+		for (std::size_t i = 0; i < COUNT; ++i)
+			maxError = std::fmax(maxError, std::fmax(std::abs(exact[i] - approximate[i]), std::abs(exact[i] - batch[i])));
+
+		std::printf(" %s, order %zu around %g +- %g (max error = %g, bound = %g, results %s)\n", pName, ORDER, center, radius, maxError, taylor.errorBound(),
+			maxError <= taylor.errorBound() ? "equal" : "DIFFER");
+		Report("Node::calc", exactTime, COUNT);
+		Report("Taylor::calc", approximateTime, COUNT, exactTime.ns);
+		Report("Taylor::calcBatch", batchTime, COUNT, exactTime.ns);
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunTaylor()
+{
+	std::printf("Taylor polynomial against the exact expression\n");
+
+	using Nested = decltype(Sin(Ln(x0 + Num<2>)) * Cos(x0 * x1));
+	Compare<Nested, 2>("sin(ln(x0 + 2)) * cos(x0 * x1)", 1.0, 0.1);
+	Compare<Nested, 4>("sin(ln(x0 + 2)) * cos(x0 * x1)", 1.0, 0.1);
+
+	using Root = decltype(Sqrt(x0 * x0 + Num<1>) / (Num<2> + Sin(x0)));
+	Compare<Root, 2>("(x0 * x0 + 1) ^ (1 / 2) / (2 + sin(x0))", 0.5, 0.05);
+	Compare<Root, 4>("(x0 * x0 + 1) ^ (1 / 2) / (2 + sin(x0))", 0.5, 0.05);
+}
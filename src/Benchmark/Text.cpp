@@ -0,0 +1,117 @@
+#include "Benchmark.hpp"
+#include "Points.hpp"
+
+#include <sstream> // std::ostringstream
+
+using namespace Simplification;
+using namespace Benchmark;
+
+namespace
+{
+	//====================================================================================================================================
+	//!
+	//! \brief	The former Node::dump: recursive concatenation of std::string temporaries, kept to compare against
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	struct LegacyDump;
+
+	template<llong_t N>
+	struct LegacyDump<Node<Number<N>>>
+	{
+		static std::string dump() { return std::to_string(N); }
+	};
+
+	template<char NAME, int INDEX>
+	struct LegacyDump<Node<Variable<NAME, INDEX>>>
+	{
+		static std::string dump() { return (std::string{ NAME, '_' } + std::to_string(INDEX)); }
+	};
+
+	template<UnaryFunction UF, typename Child>
+	struct LegacyDump<Node<Wrap4UF<UF>, Child>>
+	{
+		static std::string dump() { return (std::string(GetFunctionName(UF)) + "(" + LegacyDump<Child>::dump() + ")"); }
+	};
+
+	template<BinaryFunction BF, typename Left, typename Right>
+	struct LegacyDump<Node<Wrap4BF<BF>, Left, Right>>
+	{
+		static std::string dump()
+		{
+			auto left  = LegacyDump<Left>::dump();
+			auto right = LegacyDump<Right>::dump();
+
+			if (IsNodeBinary<Left>::value)
+				left = "(" + left + ")";
+
+			if (IsNodeBinary<Right>::value)
+				right = "(" + right + ")";
+
+			return (left + " " + std::string(GetFunctionName(BF)) + " " + right);
+		}
+	};
+
+	template<typename Expr>
+	void Compare(const char *pName)
+	{
+		constexpr std::size_t REPEAT = 1000;
+		constexpr std::size_t SIZE = Printing::Text<Expr>::value.size;
+
+		if (LegacyDump<Expr>::dump() != Expr::dump())
+			std::printf(" %s: text differs from the former dump()\n", pName);
+
+		const auto legacyTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < REPEAT; ++i)
+				DoNotOptimize(LegacyDump<Expr>::dump());
+		});
+
+		const auto dumpTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < REPEAT; ++i)
+				DoNotOptimize(Expr::dump());
+		});
+
+		char buffer[SIZE + 1];
+		const auto bufferTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < REPEAT; ++i)
+			{
+				Printing::Write<Expr>(buffer, sizeof(buffer));
+				DoNotOptimize(buffer);
+			}
+		});
+
+		std::ostringstream stream;
+		const auto streamTime = Measure([&]
+		{
+			for (std::size_t i = 0; i < REPEAT; ++i)
+			{
+				stream.seekp(0);
+				Printing::Write<Expr>(stream);
+			}
+
+			DoNotOptimize(stream);
+		});
+
+		std::printf(" %s (%zu nodes, %zu characters)\n", pName, NodeCount<Expr>::value, SIZE);
+		Report("former dump()", legacyTime, REPEAT);
+		Report("dump()", dumpTime, REPEAT, legacyTime.ns);
+		Report("Printing::Write into buffer", bufferTime, REPEAT, legacyTime.ns);
+		Report("Printing::Write into std::ostream", streamTime, REPEAT, legacyTime.ns);
+	}
+
+} // anonymous namespace
+
+void Benchmark::RunText()
+{
+	std::printf("Text of expressions\n");
+
+	using Quotient = decltype(Sin(x0) / (x0 * x1 + Ln(x1)));
+
+	Compare<Quotient>("sin(x0) / (x0 * x1 + ln(x1))");
+	Compare<Quotient::der<'x', 0>>("d/dx0 of the above");
+	Compare<Quotient::der<'x', 0>::der<'x', 1>>("d2/dx0dx1 of the above");
+}
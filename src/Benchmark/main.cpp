@@ -0,0 +1,51 @@
+#include "Benchmark.hpp"
+
+#include <cstring> // std::strcmp
+
+//====================================================================================================================================
+//!
+//! \brief	Runs the suites given on the command line, all suites without arguments
+//!
+//====================================================================================================================================
+
+int main(int argc, char *argv[])
+{
+	static const struct
+	{
+		const char *pName;
+		void (*pRun)();
+	} s_Suites[] =
+	{
+		{ "calc",      Benchmark::RunCalc      },
+		{ "batch",     Benchmark::RunBatch     },
+		{ "dag",       Benchmark::RunDag       },
+		{ "gradient",  Benchmark::RunGradient  },
+		{ "fibonacci", Benchmark::RunFibonacci },
+		{ "program",   Benchmark::RunProgram   },
+		{ "runtime",   Benchmark::RunRuntime   },
+		{ "text",      Benchmark::RunText      },
+		{ "policy",    Benchmark::RunPolicy    },
+		{ "hessian",   Benchmark::RunHessian   },
+		{ "taylor",    Benchmark::RunTaylor    },
+		{ "parallel",  Benchmark::RunParallel  },
+		{ "slots",     Benchmark::RunSlots     },
+		{ "stream",    Benchmark::RunStream    },
+		{ "native",    Benchmark::RunNative    },
+		{ "binomial",  Benchmark::RunBinomial  },
+		{ "log2",      Benchmark::RunLogarithm },
+		{ "power",     Benchmark::RunPower     },
+		{ "profile",   Benchmark::RunProfiling },
+	};
+
+	for (const auto &rSuite : s_Suites)
+	{
+		bool selected = (argc == 1);
+		for (int i = 1; i < argc && !selected; ++i)
+			selected = !std::strcmp(argv[i], rSuite.pName);
+
+		if (selected)
+			rSuite.pRun();
+	}
+
+	return 0;
+}
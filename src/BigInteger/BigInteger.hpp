@@ -0,0 +1,632 @@
+#pragma once
+
+#ifndef __BIG_INTEGER_HPP_INCLUDED__
+#define __BIG_INTEGER_HPP_INCLUDED__
+
+#include <array>     // std::array
+#include <cstddef>   // size_t
+#include <cstdint>   // std::uint32_t, std::uint64_t
+#include <ostream>   // std::ostream
+#include <stdexcept> // std::overflow_error
+#include <string>    // std::string
+
+//====================================================================================================================================
+//!
+//! \brief	Signed integers of fixed capacity usable in constant expressions: exact factorials, powers and Fibonacci numbers
+//!			computed at compile time and embedded into the binary
+//!
+//! \note	Overflow of the capacity throws std::overflow_error, which is a compile error in constant expressions
+//!
+//====================================================================================================================================
+
+namespace Multiprecision
+{
+
+	using limb_t = std::uint32_t;
+	using wide_t = std::uint64_t;
+
+	constexpr size_t LIMB_BITS = 32;
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Size in limbs from which Karatsuba is faster than schoolbook multiplication
+	//!
+	//====================================================================================================================================
+
+	constexpr size_t KARATSUBA_THRESHOLD = 32;
+
+	constexpr size_t BitWidth(std::uint64_t value) noexcept
+	{
+		size_t bits = 0;
+		for (; value; value >>= 1)
+			++bits;
+
+		return bits;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Capacity for a number of the given bits with a spare limb, at least the two limbs of long long
+	//!
+	//====================================================================================================================================
+
+	constexpr size_t LimbsForBits(size_t bits) noexcept
+	{
+		return (bits > LIMB_BITS ? (bits + LIMB_BITS - 1) / LIMB_BITS + 1 : 2);
+	}
+
+#pragma region Magnitudes
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Number of limbs without the leading zeros, limbs are stored from the least significant one
+	//!
+	//====================================================================================================================================
+
+	constexpr size_t Normalize(const limb_t *pLimbs, size_t size) noexcept
+	{
+		while (size && !pLimbs[size - 1])
+			--size;
+
+		return size;
+	}
+
+	constexpr int Compare(const limb_t *pLeft, size_t leftSize, const limb_t *pRight, size_t rightSize) noexcept
+	{
+		if (leftSize != rightSize)
+			return (leftSize < rightSize ? -1 : 1);
+
+		for (size_t i = leftSize; i-- > 0;)
+			if (pLeft[i] != pRight[i])
+				return (pLeft[i] < pRight[i] ? -1 : 1);
+
+		return 0;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 target += source, targetSize >= sourceSize
+	//!
+	//! \return  Carry out of the target
+	//!
+	//====================================================================================================================================
+
+	constexpr limb_t AddTo(limb_t *pTarget, size_t targetSize, const limb_t *pSource, size_t sourceSize) noexcept
+	{
+		wide_t carry = 0;
+		for (size_t i = 0; i < targetSize && (i < sourceSize || carry); ++i)
+		{
+			carry += static_cast<wide_t>(pTarget[i]) + (i < sourceSize ? pSource[i] : 0);
+			pTarget[i] = static_cast<limb_t>(carry);
+			carry >>= LIMB_BITS;
+		}
+
+		return static_cast<limb_t>(carry);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 target -= source, targetSize >= sourceSize
+	//!
+	//! \return  Borrow out of the target, 0 if target was not less than source
+	//!
+	//====================================================================================================================================
+
+	constexpr limb_t SubtractFrom(limb_t *pTarget, size_t targetSize, const limb_t *pSource, size_t sourceSize) noexcept
+	{
+		limb_t borrow = 0;
+		for (size_t i = 0; i < targetSize && (i < sourceSize || borrow); ++i)
+		{
+			const wide_t subtrahend = static_cast<wide_t>(i < sourceSize ? pSource[i] : 0) + borrow;
+			borrow = (pTarget[i] < subtrahend);
+			pTarget[i] = static_cast<limb_t>(pTarget[i] - subtrahend);
+		}
+
+		return borrow;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 result = left * right, the result has leftSize + rightSize limbs
+	//!
+	//====================================================================================================================================
+
+	constexpr void MultiplySchoolbook(const limb_t *pLeft, size_t leftSize, const limb_t *pRight, size_t rightSize, limb_t *pResult) noexcept
+	{
+		for (size_t i = 0; i < leftSize + rightSize; ++i)
+			pResult[i] = 0;
+
+		for (size_t i = 0; i < leftSize; ++i)
+		{
+			const wide_t left = pLeft[i];
+			limb_t *pRow = pResult + i;
+
+			wide_t carry = 0;
+			for (size_t j = 0; j < rightSize; ++j)
+			{
+				carry += left * pRight[j] + pRow[j];
+				pRow[j] = static_cast<limb_t>(carry);
+				carry >>= LIMB_BITS;
+			}
+
+			pRow[rightSize] = static_cast<limb_t>(carry);
+		}
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Scratch limbs of MultiplyKaratsuba for size limbs, with the smallest threshold, so it bounds every threshold
+	//!
+	//====================================================================================================================================
+
+	constexpr size_t KaratsubaScratch(size_t size) noexcept
+	{
+		size_t scratch = 0;
+		for (; size > 4; size = size - size / 2 + 1)
+			scratch += 4 * (size - size / 2 + 1);
+
+		return scratch;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 result = left * right for two numbers of size limbs: three half-size products instead of four
+	//!
+	//! \param   pResult    Output, 2 * size limbs
+	//! \param   pScratch   KaratsubaScratch(size) limbs
+	//! \param   threshold  Size from which the product is split, at least 4
+	//!
+	//====================================================================================================================================
+
+	constexpr void MultiplyKaratsuba(const limb_t *pLeft, const limb_t *pRight, size_t size, limb_t *pResult, limb_t *pScratch, size_t threshold) noexcept
+	{
+		if (size < threshold || size <= 4)
+		{
+			MultiplySchoolbook(pLeft, size, pRight, size, pResult);
+			return;
+		}
+
+		const size_t low = size / 2;
+		const size_t high = size - low;
+
+		// z0 = low * low and z2 = high * high go straight to their places in the result
+		MultiplyKaratsuba(pLeft, pRight, low, pResult, pScratch, threshold);
+		MultiplyKaratsuba(pLeft + low, pRight + low, high, pResult + 2 * low, pScratch, threshold);
+
+		// z1 = (low + high) * (low + high) - z0 - z2
+		limb_t *pLeftSum = pScratch;
+		limb_t *pRightSum = pLeftSum + high + 1;
+		limb_t *pMiddle = pRightSum + high + 1;
+
+		for (size_t i = 0; i < high; ++i)
+		{
+			pLeftSum[i] = pLeft[low + i];
+			pRightSum[i] = pRight[low + i];
+		}
+
+		pLeftSum[high] = AddTo(pLeftSum, high, pLeft, low);
+		pRightSum[high] = AddTo(pRightSum, high, pRight, low);
+
+		MultiplyKaratsuba(pLeftSum, pRightSum, high + 1, pMiddle, pMiddle + 2 * (high + 1), threshold);
+
+		SubtractFrom(pMiddle, 2 * (high + 1), pResult, 2 * low);
+		SubtractFrom(pMiddle, 2 * (high + 1), pResult + 2 * low, 2 * high);
+
+		AddTo(pResult + low, size + high, pMiddle, Normalize(pMiddle, 2 * (high + 1)));
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Scratch limbs of Multiply for operands of at most size limbs
+	//!
+	//====================================================================================================================================
+
+	constexpr size_t MultiplyScratch(size_t size) noexcept
+	{
+		return 3 * size + KaratsubaScratch(size);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 result = left * right: schoolbook for short operands, Karatsuba otherwise: over chunks of the
+	//!			 shorter size if the other one is at least twice as long
+	//!
+	//! \param   pResult    Output, leftSize + rightSize limbs
+	//! \param   pScratch   MultiplyScratch(max(leftSize, rightSize)) limbs
+	//! \param   threshold  Size from which Karatsuba is used
+	//!
+	//====================================================================================================================================
+
+	constexpr void Multiply(const limb_t *pLeft, size_t leftSize, const limb_t *pRight, size_t rightSize, limb_t *pResult, limb_t *pScratch,
+		size_t threshold = KARATSUBA_THRESHOLD) noexcept
+	{
+		if (leftSize < rightSize)
+		{
+			Multiply(pRight, rightSize, pLeft, leftSize, pResult, pScratch, threshold);
+			return;
+		}
+
+		if (rightSize < threshold)
+		{
+			MultiplySchoolbook(pLeft, leftSize, pRight, rightSize, pResult);
+			return;
+		}
+
+		limb_t *pProduct = pScratch;
+		limb_t *pPadded = pProduct + 2 * leftSize;
+		limb_t *pKaratsuba = pPadded + leftSize;
+
+		// operands of close sizes: one product with the shorter one padded costs less than two chunks
+		if (leftSize < 2 * rightSize)
+		{
+			for (size_t i = 0; i < leftSize; ++i)
+				pPadded[i] = (i < rightSize ? pRight[i] : 0);
+
+			MultiplyKaratsuba(pLeft, pPadded, leftSize, pProduct, pKaratsuba, threshold);
+
+			// the top limbs of the padded product are zero
+			for (size_t i = 0; i < leftSize + rightSize; ++i)
+				pResult[i] = pProduct[i];
+
+			return;
+		}
+
+		for (size_t i = 0; i < leftSize + rightSize; ++i)
+			pResult[i] = 0;
+
+		pPadded = pProduct + 2 * rightSize;
+		pKaratsuba = pPadded + rightSize;
+
+		for (size_t offset = 0; offset < leftSize; offset += rightSize)
+		{
+			const limb_t *pChunk = pLeft + offset;
+			if (leftSize - offset < rightSize)
+			{
+				for (size_t i = 0; i < rightSize; ++i)
+					pPadded[i] = (offset + i < leftSize ? pLeft[offset + i] : 0);
+
+				pChunk = pPadded;
+			}
+
+			MultiplyKaratsuba(pChunk, pRight, rightSize, pProduct, pKaratsuba, threshold);
+			AddTo(pResult + offset, leftSize + rightSize - offset, pProduct, Normalize(pProduct, 2 * rightSize));
+		}
+	}
+
+#pragma endregion
+
+#pragma region BigInteger
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Signed integer of at most LIMBS 32-bit limbs
+	//!
+	//====================================================================================================================================
+
+	template<size_t LIMBS>
+	class BigInteger
+	{
+	public:
+		static_assert(LIMBS >= 2, "BigInteger holds at least 64 bits");
+
+		static constexpr size_t CAPACITY = LIMBS;
+
+		//====================================================================================================================================
+		//!
+		//! \brief	Maximal number of decimal digits, a limb has less than 10
+		//!
+		//====================================================================================================================================
+
+		static constexpr size_t DIGITS = 10 * LIMBS;
+
+		constexpr BigInteger() noexcept :
+			m_Limbs{ }
+		{
+		}
+
+		constexpr BigInteger(long long value) noexcept :
+			m_Limbs{ },
+			m_Negative(value < 0)
+		{
+			// the magnitude of LLONG_MIN is representable as unsigned
+			const std::uint64_t magnitude = (value < 0 ? 0 - static_cast<std::uint64_t>(value) : static_cast<std::uint64_t>(value));
+
+			m_Limbs[0] = static_cast<limb_t>(magnitude);
+			m_Limbs[1] = static_cast<limb_t>(magnitude >> LIMB_BITS);
+			m_Size = Normalize(m_Limbs.data(), 2);
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Number from its limbs, the least significant first
+		//!
+		//! \throw   std::overflow_error if the number does not fit into LIMBS limbs
+		//!
+		//====================================================================================================================================
+
+		static constexpr BigInteger FromLimbs(const limb_t *pLimbs, size_t size, bool negative)
+		{
+			size = Normalize(pLimbs, size);
+			if (size > LIMBS)
+				throw std::overflow_error("BigInteger capacity exceeded");
+
+			BigInteger result;
+			for (size_t i = 0; i < size; ++i)
+				result.m_Limbs[i] = pLimbs[i];
+
+			result.m_Size = size;
+			result.m_Negative = (negative && size);
+
+			return result;
+		}
+
+		constexpr const limb_t* data() const noexcept { return m_Limbs.data(); }
+		constexpr size_t size() const noexcept { return m_Size; }
+		constexpr bool negative() const noexcept { return m_Negative; }
+		constexpr bool isZero() const noexcept { return !m_Size; }
+
+		constexpr size_t bits() const noexcept { return (m_Size ? (m_Size - 1) * LIMB_BITS + BitWidth(m_Limbs[m_Size - 1]) : 0); }
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 The same number with another capacity
+		//!
+		//! \throw   std::overflow_error if it does not fit
+		//!
+		//====================================================================================================================================
+
+		template<size_t OTHER>
+		constexpr BigInteger<OTHER> resize() const
+		{
+			return BigInteger<OTHER>::FromLimbs(m_Limbs.data(), m_Size, m_Negative);
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Value as unsigned long long
+		//!
+		//! \throw   std::overflow_error if it is negative or too large
+		//!
+		//====================================================================================================================================
+
+		constexpr unsigned long long toUnsigned() const
+		{
+			if (m_Negative || m_Size > 2)
+				throw std::overflow_error("BigInteger does not fit into unsigned long long");
+
+			return (static_cast<unsigned long long>(m_Limbs[1]) << LIMB_BITS) | m_Limbs[0];
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 this * factor for a single-limb factor, the step of the leaves of product trees
+		//!
+		//! \throw   std::overflow_error if the product does not fit
+		//!
+		//====================================================================================================================================
+
+		constexpr BigInteger multiplied(limb_t factor) const
+		{
+			BigInteger result;
+			wide_t carry = 0;
+			for (size_t i = 0; i < m_Size; ++i)
+			{
+				carry += static_cast<wide_t>(m_Limbs[i]) * factor;
+				result.m_Limbs[i] = static_cast<limb_t>(carry);
+				carry >>= LIMB_BITS;
+			}
+
+			result.m_Size = m_Size;
+			if (carry)
+			{
+				if (m_Size == LIMBS)
+					throw std::overflow_error("BigInteger capacity exceeded");
+
+				result.m_Limbs[result.m_Size++] = static_cast<limb_t>(carry);
+			}
+
+			result.m_Size = Normalize(result.m_Limbs.data(), result.m_Size);
+			result.m_Negative = (m_Negative && result.m_Size);
+
+			return result;
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Writes the decimal digits, pLast - pFirst must be at least DIGITS + 1 characters
+		//!
+		//! \return  End of the written text, it is not zero-terminated
+		//!
+		//====================================================================================================================================
+
+		constexpr char* toChars(char *pFirst) const noexcept
+		{
+			if (!m_Size)
+			{
+				*pFirst = '0';
+				return pFirst + 1;
+			}
+
+			// repeated division by 10^9, the digits come out backwards
+			std::array<limb_t, LIMBS> quotient = m_Limbs;
+			size_t size = m_Size;
+
+			char *pLast = pFirst;
+			while (size)
+			{
+				wide_t remainder = 0;
+				for (size_t i = size; i-- > 0;)
+				{
+					const wide_t current = (remainder << LIMB_BITS) | quotient[i];
+					quotient[i] = static_cast<limb_t>(current / 1000000000u);
+					remainder = current % 1000000000u;
+				}
+
+				size = Normalize(quotient.data(), size);
+				for (int digit = 0; digit < 9 && (size || remainder); ++digit, remainder /= 10)
+					*pLast++ = static_cast<char>('0' + remainder % 10);
+			}
+
+			if (m_Negative)
+				*pLast++ = '-';
+
+			for (char *pLeft = pFirst, *pRight = pLast - 1; pLeft < pRight; ++pLeft, --pRight)
+			{
+				const char c = *pLeft;
+				*pLeft = *pRight;
+				*pRight = c;
+			}
+
+			return pLast;
+		}
+
+		std::string toString() const
+		{
+			std::string text(DIGITS + 1, '\0');
+			text.resize(static_cast<size_t>(toChars(&text[0]) - text.data()));
+
+			return text;
+		}
+
+		constexpr BigInteger operator-() const noexcept
+		{
+			BigInteger result = *this;
+			result.m_Negative = (!m_Negative && m_Size);
+
+			return result;
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Sum with the signs, the magnitudes are added or the smaller one is subtracted from the larger one
+		//!
+		//! \throw   std::overflow_error if the sum does not fit
+		//!
+		//====================================================================================================================================
+
+		friend constexpr BigInteger operator+(const BigInteger &rLeft, const BigInteger &rRight)
+		{
+			if (rLeft.m_Negative == rRight.m_Negative)
+			{
+				std::array<limb_t, LIMBS + 1> sum{ };
+				for (size_t i = 0; i < rLeft.m_Size; ++i)
+					sum[i] = rLeft.m_Limbs[i];
+
+				sum[LIMBS] = AddTo(sum.data(), LIMBS, rRight.m_Limbs.data(), rRight.m_Size);
+
+				return FromLimbs(sum.data(), LIMBS + 1, rLeft.m_Negative);
+			}
+
+			const bool leftLarger = (Compare(rLeft.m_Limbs.data(), rLeft.m_Size, rRight.m_Limbs.data(), rRight.m_Size) >= 0);
+			const BigInteger &rLarger = (leftLarger ? rLeft : rRight);
+			const BigInteger &rSmaller = (leftLarger ? rRight : rLeft);
+
+			BigInteger result = rLarger;
+			SubtractFrom(result.m_Limbs.data(), result.m_Size, rSmaller.m_Limbs.data(), rSmaller.m_Size);
+			result.m_Size = Normalize(result.m_Limbs.data(), result.m_Size);
+			result.m_Negative = (rLarger.m_Negative && result.m_Size);
+
+			return result;
+		}
+
+		friend constexpr BigInteger operator-(const BigInteger &rLeft, const BigInteger &rRight)
+		{
+			return (rLeft + -rRight);
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Product, Karatsuba from KARATSUBA_THRESHOLD limbs
+		//!
+		//! \throw   std::overflow_error if the product does not fit
+		//!
+		//====================================================================================================================================
+
+		friend constexpr BigInteger operator*(const BigInteger &rLeft, const BigInteger &rRight)
+		{
+			return Multiplied(rLeft, rRight, KARATSUBA_THRESHOLD);
+		}
+
+		static constexpr BigInteger Multiplied(const BigInteger &rLeft, const BigInteger &rRight, size_t threshold)
+		{
+			if (rLeft.m_Size + rRight.m_Size > 2 * LIMBS)
+				throw std::overflow_error("BigInteger capacity exceeded");
+
+			std::array<limb_t, 2 * LIMBS> product{ };
+			std::array<limb_t, MultiplyScratch(LIMBS)> scratch{ };
+
+			Multiply(rLeft.m_Limbs.data(), rLeft.m_Size, rRight.m_Limbs.data(), rRight.m_Size, product.data(), scratch.data(), threshold);
+
+			return FromLimbs(product.data(), rLeft.m_Size + rRight.m_Size, rLeft.m_Negative != rRight.m_Negative);
+		}
+
+		friend constexpr bool operator==(const BigInteger &rLeft, const BigInteger &rRight) noexcept
+		{
+			return (rLeft.m_Negative == rRight.m_Negative && !Compare(rLeft.m_Limbs.data(), rLeft.m_Size, rRight.m_Limbs.data(), rRight.m_Size));
+		}
+
+		friend constexpr bool operator!=(const BigInteger &rLeft, const BigInteger &rRight) noexcept
+		{
+			return !(rLeft == rRight);
+		}
+
+		friend constexpr bool operator<(const BigInteger &rLeft, const BigInteger &rRight) noexcept
+		{
+			if (rLeft.m_Negative != rRight.m_Negative)
+				return rLeft.m_Negative;
+
+			const int order = Compare(rLeft.m_Limbs.data(), rLeft.m_Size, rRight.m_Limbs.data(), rRight.m_Size);
+
+			return (rLeft.m_Negative ? order > 0 : order < 0);
+		}
+
+		friend std::ostream& operator<<(std::ostream &rStream, const BigInteger &rValue)
+		{
+			return (rStream << rValue.toString());
+		}
+
+	private:
+		std::array<limb_t, LIMBS> m_Limbs;
+		size_t m_Size = 0;
+		bool m_Negative = false;
+	};
+
+#pragma endregion
+
+#pragma region Products
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Product of the integers in [first, last] by a balanced product tree: the operands of every multiplication have
+	//!			 about the same size, so Karatsuba applies to the large ones instead of one huge times one small number
+	//!
+	//! \param   first  First factor, at least 1
+	//! \param   last   Last factor, less than 2^32
+	//!
+	//! \throw   std::overflow_error if the product does not fit
+	//!
+	//====================================================================================================================================
+
+	template<size_t LIMBS>
+	constexpr BigInteger<LIMBS> RangeProduct(std::uint64_t first, std::uint64_t last)
+	{
+		// a leaf of 16 factors is one pass of single-limb multiplications over a number of a few limbs
+		if (last < first + 16)
+		{
+			BigInteger<LIMBS> result = 1;
+			for (std::uint64_t factor = first; factor <= last; ++factor)
+				result = result.multiplied(static_cast<limb_t>(factor));
+
+			return result;
+		}
+
+		const std::uint64_t middle = first + (last - first) / 2;
+
+		return RangeProduct<LIMBS>(first, middle) * RangeProduct<LIMBS>(middle + 1, last);
+	}
+
+#pragma endregion
+
+} // namespace Multiprecision
+
+#endif /* __BIG_INTEGER_HPP_INCLUDED__ */
@@ -0,0 +1,249 @@
+#pragma once
+
+//====================================================================================================================================
+//!
+//!	\file   Adjoint.hpp
+//!
+//! \brief	Reverse-mode (adjoint) differentiation over the DAG of unique subtrees
+//!
+//====================================================================================================================================
+
+#include "Dag.hpp"
+#include "Variables.hpp"
+
+#include <utility> // std::index_sequence
+
+namespace ReverseMode
+{
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Value of the expression and its derivatives by every variable of VariablesOfResult<Expr>
+	//!
+	//====================================================================================================================================
+
+	template<typename T, std::size_t N>
+	struct Gradient
+	{
+		T value;
+		std::array<T, N> gradient;
+	};
+
+#pragma region Local partial derivatives
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Derivative of the unary function by its argument, result is the already calculated value of the node
+	//!
+	//====================================================================================================================================
+
+	template<UnaryFunction UF>
+	struct UnaryPartial;
+
+	template<>
+	struct UnaryPartial<UnaryFunction::SIN>
+	{
+		template<typename T>
+		static T calc(T arg, T) { return std::cos(arg); }
+	};
+
+	template<>
+	struct UnaryPartial<UnaryFunction::COS>
+	{
+		template<typename T>
+		static T calc(T arg, T) { return -std::sin(arg); }
+	};
+
+	template<>
+	struct UnaryPartial<UnaryFunction::LG>
+	{
+		template<typename T>
+		static T calc(T arg, T) { return 1 / (arg * std::log(T(10))); }
+	};
+
+	template<>
+	struct UnaryPartial<UnaryFunction::LN>
+	{
+		template<typename T>
+		static T calc(T arg, T) noexcept { return 1 / arg; }
+	};
+
+	template<>
+	struct UnaryPartial<UnaryFunction::NEG>
+	{
+		template<typename T>
+		static T calc(T, T) noexcept { return -1; }
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Derivatives of the binary function by its left and right arguments
+	//!
+	//====================================================================================================================================
+
+	template<BinaryFunction BF>
+	struct BinaryPartial;
+
+	template<>
+	struct BinaryPartial<BinaryFunction::ADD>
+	{
+		template<typename T>
+		static T left(T, T, T) noexcept { return 1; }
+
+		template<typename T>
+		static T right(T, T, T) noexcept { return 1; }
+	};
+
+	template<>
+	struct BinaryPartial<BinaryFunction::SUB>
+	{
+		template<typename T>
+		static T left(T, T, T) noexcept { return 1; }
+
+		template<typename T>
+		static T right(T, T, T) noexcept { return -1; }
+	};
+
+	template<>
+	struct BinaryPartial<BinaryFunction::MUL>
+	{
+		template<typename T>
+		static T left(T, T rightArg, T) noexcept { return rightArg; }
+
+		template<typename T>
+		static T right(T leftArg, T, T) noexcept { return leftArg; }
+	};
+
+	template<>
+	struct BinaryPartial<BinaryFunction::DIV>
+	{
+		template<typename T>
+		static T left(T, T rightArg, T) noexcept { return 1 / rightArg; }
+
+		template<typename T>
+		static T right(T, T rightArg, T result) noexcept { return -result / rightArg; }
+	};
+
+	template<>
+	struct BinaryPartial<BinaryFunction::POW>
+	{
+		// y * x ^ (y - 1), not result * y / x, which is 0 / 0 for x = 0
+		template<typename T>
+		static T left(T leftArg, T rightArg, T) noexcept { return rightArg * std::pow(leftArg, rightArg - 1); }
+
+		template<typename T>
+		static T right(T leftArg, T, T result) { return result * std::log(leftArg); }
+	};
+
+#pragma endregion
+
+#pragma region Backward steps
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Propagates the adjoint of one unique node to the adjoints of its children
+	//!
+	//====================================================================================================================================
+
+	template<typename Nodes, typename T>
+	struct BackStep
+	{
+		template<typename Slots>
+		static void calc(const Slots&, Slots&) noexcept { }
+	};
+
+	template<typename Nodes, UnaryFunction UF, typename Child>
+	struct BackStep<Nodes, Node<Wrap4UF<UF>, Child>>
+	{
+		template<typename Slots>
+		static void calc(const Slots &rValues, Slots &rAdjoints)
+		{
+			constexpr std::size_t SELF  = IndexOfValue<Nodes, Node<Wrap4UF<UF>, Child>>;
+			constexpr std::size_t CHILD = IndexOfValue<Nodes, Child>;
+
+			rAdjoints[CHILD] += rAdjoints[SELF] * UnaryPartial<UF>::calc(rValues[CHILD], rValues[SELF]);
+		}
+	};
+
+	template<typename Nodes, BinaryFunction BF, typename Left, typename Right>
+	struct BackStep<Nodes, Node<Wrap4BF<BF>, Left, Right>>
+	{
+		template<typename Slots>
+		static void calc(const Slots &rValues, Slots &rAdjoints)
+		{
+			constexpr std::size_t SELF  = IndexOfValue<Nodes, Node<Wrap4BF<BF>, Left, Right>>;
+			constexpr std::size_t LEFT  = IndexOfValue<Nodes, Left>;
+			constexpr std::size_t RIGHT = IndexOfValue<Nodes, Right>;
+
+			const auto adjoint = rAdjoints[SELF];
+
+			rAdjoints[LEFT]  += adjoint * BinaryPartial<BF>::left(rValues[LEFT], rValues[RIGHT], rValues[SELF]);
+			rAdjoints[RIGHT] += adjoint * BinaryPartial<BF>::right(rValues[LEFT], rValues[RIGHT], rValues[SELF]);
+		}
+	};
+
+#pragma endregion
+
+#pragma region Reverse sweep
+
+	template<typename Expr, typename Nodes = Sharing::UniqueNodesResult<Expr>, typename Vars = VariablesOfResult<Expr>>
+	struct Reverse;
+
+	template<typename Expr, typename... Nodes, typename... Vars>
+	struct Reverse<Expr, TypeList<Nodes...>, TypeList<Vars...>>
+	{
+		using nodes = TypeList<Nodes...>;
+
+		//====================================================================================================================================
+		//!
+		//! \brief	Size of the tape, i.e. unique subtrees of Expr
+		//!
+		//====================================================================================================================================
+
+		static constexpr std::size_t SIZE = sizeof...(Nodes);
+
+		template<typename Slots, std::size_t... Is>
+		static void Backward(const Slots &rValues, Slots &rAdjoints, std::index_sequence<Is...>)
+		{
+			(BackStep<nodes, TypeAtResult<nodes, SIZE - 1 - Is>>::calc(rValues, rAdjoints), ...);
+		}
+
+		template<typename Vector>
+		static Gradient<typename Vector::value_type, sizeof...(Vars)> calc(const Vector &rValues)
+		{
+			using value_type = typename Vector::value_type;
+
+			ErrorPolicy::Throwing policy;
+
+			std::array<value_type, SIZE> values;
+			(Sharing::Step<nodes, Nodes>::calc(values, rValues, policy), ...);
+
+			std::array<value_type, SIZE> adjoints{ };
+			adjoints.back() = 1;
+			Backward(values, adjoints, std::make_index_sequence<SIZE>{ });
+
+			return { values.back(), { adjoints[IndexOfValue<nodes, Vars>]... } };
+		}
+	};
+
+#pragma endregion
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Calculates value and gradient of the expression by one forward and one backward sweep
+	//!
+	//! \param   rValues  The same functor as for Node::calc
+	//!
+	//! \return  Value and gradient, gradient[k] is the derivative by the k-th variable of VariablesOfResult<Expr>
+	//!
+	//! \throw   std::overflow_error, std::invalid_argument
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Vector>
+	auto CalcGradient(const Vector &rValues)
+	{
+		return Reverse<Expr>::calc(rValues);
+	}
+
+} // namespace ReverseMode
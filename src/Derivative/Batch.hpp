@@ -0,0 +1,337 @@
+#pragma once
+
+//====================================================================================================================================
+//!
+//!	\file   Batch.hpp
+//!
+//! \brief	Batched evaluation of Node expressions over columns of points
+//!
+//====================================================================================================================================
+
+#include "Differentiation.hpp"
+
+#include <cstddef>   // std::size_t
+
+#if defined(__AVX512F__) || defined(__AVX__)
+#include <immintrin.h>
+#endif /* defined(__AVX512F__) || defined(__AVX__) */
+
+namespace Batching
+{
+
+#pragma region Packs
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Pack of one value, used for the tail of the batch and when no vector extension is available
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	struct ScalarPack
+	{
+		using value_type = T;
+		using reg = T;
+
+		static constexpr std::size_t WIDTH = 1;
+
+		static reg load(const T *pData) noexcept { return *pData; }
+		static void store(T *pData, reg value) noexcept { *pData = value; }
+		static reg broadcast(T value) noexcept { return value; }
+
+		static reg add(reg left, reg right) noexcept { return (left + right); }
+		static reg sub(reg left, reg right) noexcept { return (left - right); }
+		static reg mul(reg left, reg right) noexcept { return (left * right); }
+		static reg div(reg left, reg right) noexcept { return (left / right); }
+		static reg neg(reg value) noexcept { return (-value); }
+
+		static bool anyZero(reg value) noexcept { return !value; }
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Widest double register available for the target, falls back to the scalar pack
+	//!
+	//====================================================================================================================================
+
+#if defined(__AVX512F__)
+
+	struct Simd
+	{
+		using value_type = double;
+		using reg = __m512d;
+
+		static constexpr std::size_t WIDTH = 8;
+
+		static reg load(const double *pData) noexcept { return _mm512_loadu_pd(pData); }
+		static void store(double *pData, reg value) noexcept { _mm512_storeu_pd(pData, value); }
+		static reg broadcast(double value) noexcept { return _mm512_set1_pd(value); }
+
+		static reg add(reg left, reg right) noexcept { return _mm512_add_pd(left, right); }
+		static reg sub(reg left, reg right) noexcept { return _mm512_sub_pd(left, right); }
+		static reg mul(reg left, reg right) noexcept { return _mm512_mul_pd(left, right); }
+		static reg div(reg left, reg right) noexcept { return _mm512_div_pd(left, right); }
+		static reg neg(reg value) noexcept { return _mm512_mul_pd(value, _mm512_set1_pd(-1.0)); }
+
+		static bool anyZero(reg value) noexcept { return _mm512_cmp_pd_mask(value, _mm512_setzero_pd(), _CMP_EQ_OQ) != 0; }
+	};
+
+#elif defined(__AVX__)
+
+	struct Simd
+	{
+		using value_type = double;
+		using reg = __m256d;
+
+		static constexpr std::size_t WIDTH = 4;
+
+		static reg load(const double *pData) noexcept { return _mm256_loadu_pd(pData); }
+		static void store(double *pData, reg value) noexcept { _mm256_storeu_pd(pData, value); }
+		static reg broadcast(double value) noexcept { return _mm256_set1_pd(value); }
+
+		static reg add(reg left, reg right) noexcept { return _mm256_add_pd(left, right); }
+		static reg sub(reg left, reg right) noexcept { return _mm256_sub_pd(left, right); }
+		static reg mul(reg left, reg right) noexcept { return _mm256_mul_pd(left, right); }
+		static reg div(reg left, reg right) noexcept { return _mm256_div_pd(left, right); }
+		static reg neg(reg value) noexcept { return _mm256_xor_pd(value, _mm256_set1_pd(-0.0)); }
+
+		static bool anyZero(reg value) noexcept { return _mm256_movemask_pd(_mm256_cmp_pd(value, _mm256_setzero_pd(), _CMP_EQ_OQ)) != 0; }
+	};
+
+#else
+
+	using Simd = ScalarPack<double>;
+
+#endif /* defined(__AVX512F__) */
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Applies function to every lane of the register, used for operations without vector instruction
+	//!
+	//====================================================================================================================================
+
+	template<typename Pack, typename Func>
+	typename Pack::reg ForEachLane(typename Pack::reg value, Func func)
+	{
+		if constexpr (Pack::WIDTH == 1)
+			return func(value);
+		else
+		{
+			alignas(64) typename Pack::value_type lanes[Pack::WIDTH];
+
+			Pack::store(lanes, value);
+			for (auto &rLane : lanes)
+				rLane = func(rLane);
+
+			return Pack::load(lanes);
+		}
+	}
+
+	template<typename Pack, typename Func>
+	typename Pack::reg ForEachLane(typename Pack::reg left, typename Pack::reg right, Func func)
+	{
+		if constexpr (Pack::WIDTH == 1)
+			return func(left, right);
+		else
+		{
+			alignas(64) typename Pack::value_type lefts[Pack::WIDTH];
+			alignas(64) typename Pack::value_type rights[Pack::WIDTH];
+
+			Pack::store(lefts, left);
+			Pack::store(rights, right);
+			for (std::size_t i = 0; i < Pack::WIDTH; ++i)
+				lefts[i] = func(lefts[i], rights[i]);
+
+			return Pack::load(lefts);
+		}
+	}
+
+#pragma endregion
+
+#pragma region Kernels
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Unary operation over a pack, only NEG has a vector instruction
+	//!
+	//====================================================================================================================================
+
+	template<UnaryFunction UF>
+	struct UnaryKernel
+	{
+		template<typename Pack>
+		static typename Pack::reg apply(typename Pack::reg value)
+		{
+			return ForEachLane<Pack>(value, [](auto lane) { return UnaryOperation<UF>::calc(lane); });
+		}
+	};
+
+	template<>
+	struct UnaryKernel<UnaryFunction::NEG>
+	{
+		template<typename Pack>
+		static typename Pack::reg apply(typename Pack::reg value) noexcept { return Pack::neg(value); }
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Binary operation over a pack, only DIV consults the error policy, once for the whole pack
+	//!
+	//====================================================================================================================================
+
+	template<BinaryFunction BF>
+	struct BinaryKernel;
+
+	template<>
+	struct BinaryKernel<BinaryFunction::ADD>
+	{
+		template<typename Pack, typename Policy>
+		static typename Pack::reg apply(typename Pack::reg left, typename Pack::reg right, Policy&) noexcept { return Pack::add(left, right); }
+	};
+
+	template<>
+	struct BinaryKernel<BinaryFunction::SUB>
+	{
+		template<typename Pack, typename Policy>
+		static typename Pack::reg apply(typename Pack::reg left, typename Pack::reg right, Policy&) noexcept { return Pack::sub(left, right); }
+	};
+
+	template<>
+	struct BinaryKernel<BinaryFunction::MUL>
+	{
+		template<typename Pack, typename Policy>
+		static typename Pack::reg apply(typename Pack::reg left, typename Pack::reg right, Policy&) noexcept { return Pack::mul(left, right); }
+	};
+
+	template<>
+	struct BinaryKernel<BinaryFunction::DIV>
+	{
+		template<typename Pack, typename Policy>
+		static typename Pack::reg apply(typename Pack::reg left, typename Pack::reg right, Policy &rPolicy) noexcept(noexcept(rPolicy.report(true)))
+		{
+			if constexpr (std::is_integral_v<typename Pack::value_type>)
+				return BinaryOperation<BinaryFunction::DIV>::calc(left, right, rPolicy);
+			else
+			{
+				if constexpr (Policy::CHECKED)
+					rPolicy.report(Pack::anyZero(right));
+
+				return Pack::div(left, right);
+			}
+		}
+	};
+
+	template<>
+	struct BinaryKernel<BinaryFunction::POW>
+	{
+		template<typename Pack, typename Policy>
+		static typename Pack::reg apply(typename Pack::reg left, typename Pack::reg right, Policy&)
+		{
+			return ForEachLane<Pack>(left, right, [](auto base, auto exponent) { return std::pow(base, exponent); });
+		}
+	};
+
+#pragma endregion
+
+#pragma region Batch evaluation of nodes
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Evaluates the node for Pack::WIDTH consecutive points starting from the index, the whole tree is kept in registers
+	//!
+	//! \note	rColumns(Node<Variable<NAME, INDEX>>{ }) must return pointer to the first element of the variable column
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	struct Batch;
+
+	template<llong_t N>
+	struct Batch<Node<Number<N>>>
+	{
+		template<typename Pack, typename Columns, typename Policy>
+		static typename Pack::reg calc(const Columns&, std::size_t, Policy&) noexcept
+		{
+			return Pack::broadcast(static_cast<typename Pack::value_type>(N));
+		}
+	};
+
+	template<char NAME, int INDEX>
+	struct Batch<Node<Variable<NAME, INDEX>>>
+	{
+		template<typename Pack, typename Columns, typename Policy>
+		static typename Pack::reg calc(const Columns &rColumns, std::size_t index, Policy&) noexcept
+		{
+			return Pack::load(rColumns(Node<Variable<NAME, INDEX>>{ }) + index);
+		}
+	};
+
+	template<UnaryFunction UF, typename Child>
+	struct Batch<Node<Wrap4UF<UF>, Child>>
+	{
+		template<typename Pack, typename Columns, typename Policy>
+		static typename Pack::reg calc(const Columns &rColumns, std::size_t index, Policy &rPolicy)
+		{
+			return UnaryKernel<UF>::template apply<Pack>(Batch<Child>::template calc<Pack>(rColumns, index, rPolicy));
+		}
+	};
+
+	template<BinaryFunction BF, typename Left, typename Right>
+	struct Batch<Node<Wrap4BF<BF>, Left, Right>>
+	{
+		template<typename Pack, typename Columns, typename Policy>
+		static typename Pack::reg calc(const Columns &rColumns, std::size_t index, Policy &rPolicy)
+		{
+			const auto left  = Batch<Left>::template calc<Pack>(rColumns, index, rPolicy);
+			const auto right = Batch<Right>::template calc<Pack>(rColumns, index, rPolicy);
+
+			return BinaryKernel<BF>::template apply<Pack>(left, right, rPolicy);
+		}
+	};
+
+#pragma endregion
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Evaluates expression Expr at count points
+	//!
+	//! \param   rColumns  Functor, that maps every variable node to its column
+	//! \param   pResult   Output column with at least count elements
+	//! \param   count     Number of points
+	//! \param   rPolicy   What to do on division by zero, see ErrorPolicy; its check() is left to the caller
+	//!
+	//! \throw   std::overflow_error by ErrorPolicy::Throwing
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Columns, typename Value, typename Policy>
+	void CalcBatch(const Columns &rColumns, Value *pResult, std::size_t count, Policy &rPolicy)
+	{
+		std::size_t i = 0;
+
+		if constexpr (std::is_same_v<Value, double>)
+			for (; i + Simd::WIDTH <= count; i += Simd::WIDTH)
+				Simd::store(pResult + i, Batch<Expr>::template calc<Simd>(rColumns, i, rPolicy));
+
+		for (; i < count; ++i)
+			*(pResult + i) = Batch<Expr>::template calc<ScalarPack<Value>>(rColumns, i, rPolicy);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Evaluates expression Expr at count points with a fresh policy and checks it once after the whole batch
+	//!
+	//! \throw   std::overflow_error if any division by zero occurred with ErrorPolicy::Sticky, the result is calculated for every point anyway
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Policy = ErrorPolicy::Sticky, typename Columns, typename Value>
+	void CalcBatch(const Columns &rColumns, Value *pResult, std::size_t count)
+	{
+		Policy policy;
+
+		CalcBatch<Expr>(rColumns, pResult, count, policy);
+		policy.check();
+	}
+
+} // namespace Batching
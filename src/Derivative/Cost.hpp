@@ -0,0 +1,184 @@
+#pragma once
+
+//====================================================================================================================================
+//!
+//!	\file   Cost.hpp
+//!
+//! \brief	Compile-time cost model of Node trees: size, depth, operations by kind and estimated cycles of Node::calc
+//!
+//====================================================================================================================================
+
+#include "Differentiation.hpp"
+
+#include <array>   // std::array
+#include <cstddef> // std::size_t
+
+namespace CostModel
+{
+
+	constexpr std::size_t UNARY_FUNCTIONS = static_cast<std::size_t>(UnaryFunction::NEG) + 1;
+	constexpr std::size_t BINARY_FUNCTIONS = static_cast<std::size_t>(BinaryFunction::POW) + 1;
+
+#pragma region Cost tables
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Default cost table: approximate latencies in cycles of the double operations on x86-64, the functions are the ones of
+	//!			glibc with arguments off their fast paths
+	//!
+	//! \note	Any struct with the same members can be passed as Table, e.g. throughputs or the costs of another platform
+	//!
+	//====================================================================================================================================
+
+	struct Cycles
+	{
+		static constexpr std::size_t NUMBER = 0;
+		static constexpr std::size_t VARIABLE = 1;
+
+		static constexpr std::size_t of(UnaryFunction uf) noexcept
+		{
+			switch (uf)
+			{
+			case UnaryFunction::SIN:
+				return 50;
+			case UnaryFunction::COS:
+				return 45;
+			case UnaryFunction::LG:
+				return 70;
+			case UnaryFunction::LN:
+				return 48;
+			case UnaryFunction::NEG:
+				return 1;
+			default:
+				return 0;
+			}
+		}
+
+		static constexpr std::size_t of(BinaryFunction bf) noexcept
+		{
+			switch (bf)
+			{
+			case BinaryFunction::ADD:
+			case BinaryFunction::SUB:
+			case BinaryFunction::MUL:
+				return 4;
+			case BinaryFunction::DIV:
+				return 14;
+			case BinaryFunction::POW:
+				return 100;
+			default:
+				return 0;
+			}
+		}
+	};
+
+#pragma endregion
+
+#pragma region Metrics
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Metrics of a tree, equal subtrees are counted every time they occur as Node::calc evaluates them
+	//!
+	//====================================================================================================================================
+
+	struct Metrics
+	{
+		std::size_t nodes;
+		std::size_t depth;
+		std::size_t numbers;
+		std::size_t variables;
+		std::array<std::size_t, UNARY_FUNCTIONS> unary;
+		std::array<std::size_t, BINARY_FUNCTIONS> binary;
+
+		//! Estimated cycles of Node::calc by the cost table
+		std::size_t cycles;
+
+		constexpr std::size_t count(UnaryFunction uf) const noexcept { return unary[static_cast<std::size_t>(uf)]; }
+
+		constexpr std::size_t count(BinaryFunction bf) const noexcept { return binary[static_cast<std::size_t>(bf)]; }
+
+		static constexpr Metrics Leaf(bool isNumber, std::size_t cycles) noexcept
+		{
+			return { 1, 1, isNumber ? 1u : 0u, isNumber ? 0u : 1u, { }, { }, cycles };
+		}
+
+		static constexpr Metrics Unary(UnaryFunction uf, const Metrics &rChild, std::size_t cycles) noexcept
+		{
+			Metrics result = rChild;
+			++result.nodes;
+			++result.depth;
+			++result.unary[static_cast<std::size_t>(uf)];
+			result.cycles += cycles;
+
+			return result;
+		}
+
+		static constexpr Metrics Binary(BinaryFunction bf, const Metrics &rLeft, const Metrics &rRight, std::size_t cycles) noexcept
+		{
+			Metrics result = rLeft;
+			result.nodes += rRight.nodes + 1;
+			result.depth = 1 + (rLeft.depth < rRight.depth ? rRight.depth : rLeft.depth);
+			result.numbers += rRight.numbers;
+			result.variables += rRight.variables;
+			for (std::size_t i = 0; i < UNARY_FUNCTIONS; ++i)
+				result.unary[i] += rRight.unary[i];
+
+			for (std::size_t i = 0; i < BINARY_FUNCTIONS; ++i)
+				result.binary[i] += rRight.binary[i];
+
+			++result.binary[static_cast<std::size_t>(bf)];
+			result.cycles += rRight.cycles + cycles;
+
+			return result;
+		}
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Metrics of the tree T by the cost table Table, a constant expression, so budgets of hot formulas can be checked:
+	//!
+	//!			static_assert(CostModel::Cost<Formula>::value.cycles <= 200, "Formula got slower");
+	//!			static_assert(CostModel::Cost<Formula>::value.count(BinaryFunction::POW) == 0, "Formula calls pow");
+	//!
+	//====================================================================================================================================
+
+	template<typename T, typename Table = Cycles>
+	struct Cost;
+
+	template<llong_t N, typename Table>
+	struct Cost<Node<Number<N>>, Table>
+	{
+		static constexpr Metrics value = Metrics::Leaf(true, Table::NUMBER);
+	};
+
+	template<char NAME, int INDEX, typename Table>
+	struct Cost<Node<Variable<NAME, INDEX>>, Table>
+	{
+		static constexpr Metrics value = Metrics::Leaf(false, Table::VARIABLE);
+	};
+
+	template<UnaryFunction UF, typename Child, typename Table>
+	struct Cost<Node<Wrap4UF<UF>, Child>, Table>
+	{
+		static constexpr Metrics value = Metrics::Unary(UF, Cost<Child, Table>::value, Table::of(UF));
+	};
+
+	template<BinaryFunction BF, typename Left, typename Right, typename Table>
+	struct Cost<Node<Wrap4BF<BF>, Left, Right>, Table>
+	{
+		static constexpr Metrics value = Metrics::Binary(BF, Cost<Left, Table>::value, Cost<Right, Table>::value, Table::of(BF));
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	The cheaper of two equivalent trees by the cost table, T on a tie
+	//!
+	//====================================================================================================================================
+
+	template<typename T, typename Candidate, typename Table = Cycles>
+	using CheaperResult = std::conditional_t<(Cost<Candidate, Table>::value.cycles < Cost<T, Table>::value.cycles), Candidate, T>;
+
+#pragma endregion
+
+} // namespace CostModel
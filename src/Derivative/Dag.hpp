@@ -0,0 +1,236 @@
+#pragma once
+
+//====================================================================================================================================
+//!
+//!	\file   Dag.hpp
+//!
+//! \brief	Common-subexpression elimination: Node tree as a DAG of unique subtree types
+//!
+//====================================================================================================================================
+
+#include "Differentiation.hpp"
+#include "TypeList.hpp"
+
+#include <array> // std::array
+
+namespace Sharing
+{
+
+#pragma region Unique nodes
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Collects every unique subtree of T in post-order, so children always precede their parents
+	//!
+	//====================================================================================================================================
+
+	template<typename T, typename Visited = TypeList<>, typename Enable = void>
+	struct UniqueNodes
+	{
+		using res = PushBackUniqueResult<Visited, T>;
+	};
+
+	template<typename T, typename Visited>
+	struct UniqueNodes<T, Visited, std::enable_if_t<Contains<Visited, T>::value>>
+	{
+		using res = Visited;
+	};
+
+	template<UnaryFunction UF, typename Child, typename Visited>
+	struct UniqueNodes<Node<Wrap4UF<UF>, Child>, Visited, std::enable_if_t<!Contains<Visited, Node<Wrap4UF<UF>, Child>>::value>>
+	{
+		using res = PushBackUniqueResult<typename UniqueNodes<Child, Visited>::res, Node<Wrap4UF<UF>, Child>>;
+	};
+
+	template<BinaryFunction BF, typename Left, typename Right, typename Visited>
+	struct UniqueNodes<Node<Wrap4BF<BF>, Left, Right>, Visited, std::enable_if_t<!Contains<Visited, Node<Wrap4BF<BF>, Left, Right>>::value>>
+	{
+		using res = PushBackUniqueResult<typename UniqueNodes<Right, typename UniqueNodes<Left, Visited>::res>::res, Node<Wrap4BF<BF>, Left, Right>>;
+	};
+
+	template<typename T>
+	using UniqueNodesResult = typename UniqueNodes<T>::res;
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Unique subtrees of every root, a subtree shared by several roots is listed once
+	//!
+	//====================================================================================================================================
+
+	template<typename Roots, typename Visited = TypeList<>>
+	struct UniqueNodesOfAll;
+
+	template<typename Visited>
+	struct UniqueNodesOfAll<TypeList<>, Visited>
+	{
+		using res = Visited;
+	};
+
+	template<typename Root, typename... Roots, typename Visited>
+	struct UniqueNodesOfAll<TypeList<Root, Roots...>, Visited>
+	{
+		using res = typename UniqueNodesOfAll<TypeList<Roots...>, typename UniqueNodes<Root, Visited>::res>::res;
+	};
+
+	template<typename Roots>
+	using UniqueNodesOfAllResult = typename UniqueNodesOfAll<Roots>::res;
+
+#pragma endregion
+
+#pragma region Steps
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Evaluates one unique node into its slot, the slots of the children are already filled
+	//!
+	//====================================================================================================================================
+
+	template<typename Nodes, typename T>
+	struct Step;
+
+	template<typename Nodes, llong_t N>
+	struct Step<Nodes, Node<Number<N>>>
+	{
+		template<typename Slots, typename Vector, typename Policy>
+		static void calc(Slots &rSlots, const Vector&, Policy&) noexcept
+		{
+			rSlots[IndexOfValue<Nodes, Node<Number<N>>>] = N;
+		}
+	};
+
+	template<typename Nodes, char NAME, int INDEX>
+	struct Step<Nodes, Node<Variable<NAME, INDEX>>>
+	{
+		template<typename Slots, typename Vector, typename Policy>
+		static void calc(Slots &rSlots, const Vector &rValues, Policy&) noexcept
+		{
+			rSlots[IndexOfValue<Nodes, Node<Variable<NAME, INDEX>>>] = rValues(Node<Variable<NAME, INDEX>>{ });
+		}
+	};
+
+	template<typename Nodes, UnaryFunction UF, typename Child>
+	struct Step<Nodes, Node<Wrap4UF<UF>, Child>>
+	{
+		template<typename Slots, typename Vector, typename Policy>
+		static void calc(Slots &rSlots, const Vector&, Policy&) noexcept
+		{
+			rSlots[IndexOfValue<Nodes, Node<Wrap4UF<UF>, Child>>] = UnaryOperation<UF>::calc(rSlots[IndexOfValue<Nodes, Child>]);
+		}
+	};
+
+	template<typename Nodes, BinaryFunction BF, typename Left, typename Right>
+	struct Step<Nodes, Node<Wrap4BF<BF>, Left, Right>>
+	{
+		template<typename Slots, typename Vector, typename Policy>
+		static void calc(Slots &rSlots, const Vector&, Policy &rPolicy)
+		{
+			rSlots[IndexOfValue<Nodes, Node<Wrap4BF<BF>, Left, Right>>] =
+				BinaryOperation<BF>::calc(rSlots[IndexOfValue<Nodes, Left>], rSlots[IndexOfValue<Nodes, Right>], rPolicy);
+		}
+	};
+
+#pragma endregion
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Expression Expr evaluated as a DAG: every unique subtree is calculated once per point
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Nodes = UniqueNodesResult<Expr>>
+	struct Dag;
+
+	template<typename Expr, typename... Nodes>
+	struct Dag<Expr, TypeList<Nodes...>>
+	{
+		using nodes = TypeList<Nodes...>;
+
+		//====================================================================================================================================
+		//!
+		//! \brief	Number of scratch slots, i.e. unique subtrees of Expr
+		//!
+		//====================================================================================================================================
+
+		static constexpr std::size_t SIZE = sizeof...(Nodes);
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Calculates the expression
+		//!
+		//! \param   rValues  The same functor as for Node::calc
+		//! \param   rPolicy  What to do on division by zero, see ErrorPolicy
+		//!
+		//! \return  The same value as Expr::calc
+		//!
+		//! \throw   std::overflow_error by ErrorPolicy::Throwing, the default
+		//!
+		//====================================================================================================================================
+
+		template<typename Vector>
+		static typename Vector::value_type calc(const Vector &rValues)
+		{
+			ErrorPolicy::Throwing policy;
+
+			return calc(rValues, policy);
+		}
+
+		template<typename Vector, typename Policy>
+		static typename Vector::value_type calc(const Vector &rValues, Policy &rPolicy)
+		{
+			std::array<typename Vector::value_type, SIZE> slots;
+
+			(Step<nodes, Nodes>::calc(slots, rValues, rPolicy), ...);
+
+			return slots.back();
+		}
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Several expressions evaluated as one DAG: a subtree shared by any of them is calculated once per point
+	//!
+	//====================================================================================================================================
+
+	template<typename Roots, typename Nodes = UniqueNodesOfAllResult<Roots>>
+	struct Forest;
+
+	template<typename... Roots, typename... Nodes>
+	struct Forest<TypeList<Roots...>, TypeList<Nodes...>>
+	{
+		using nodes = TypeList<Nodes...>;
+
+		static constexpr std::size_t SIZE = sizeof...(Nodes);
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Calculates every expression
+		//!
+		//! \param   rValues  The same functor as for Node::calc
+		//! \param   rPolicy  What to do on division by zero, see ErrorPolicy
+		//!
+		//! \return  Values of the roots in the order of the list
+		//!
+		//! \throw   std::overflow_error by ErrorPolicy::Throwing, the default
+		//!
+		//====================================================================================================================================
+
+		template<typename Vector, typename Policy>
+		static std::array<typename Vector::value_type, sizeof...(Roots)> calc(const Vector &rValues, Policy &rPolicy)
+		{
+			std::array<typename Vector::value_type, SIZE> slots;
+
+			(Step<nodes, Nodes>::calc(slots, rValues, rPolicy), ...);
+
+			return { { slots[IndexOfValue<nodes, Roots>]... } };
+		}
+
+		template<typename Vector>
+		static std::array<typename Vector::value_type, sizeof...(Roots)> calc(const Vector &rValues)
+		{
+			ErrorPolicy::Throwing policy;
+
+			return calc(rValues, policy);
+		}
+	};
+
+} // namespace Sharing
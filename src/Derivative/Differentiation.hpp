@@ -15,6 +15,9 @@
 #endif /* __cplusplus */
 
 #include "Functions.hpp"
+#include "Text.hpp"
+
+#include <string> // std::string
 
 typedef long long llong_t;
 
@@ -67,6 +70,21 @@ struct IsNodeBinary : std::false_type { };
 template<BinaryFunction BF, typename Left, typename Right>
 struct IsNodeBinary<Node<Wrap4BF<BF>, Left, Right>> : std::true_type { };
 
+//====================================================================================================================================
+//!
+//! \brief	Number of nodes in the tree, equal subtrees are counted every time they occur
+//!
+//====================================================================================================================================
+
+template<typename T>
+struct NodeCount : std::integral_constant<std::size_t, 1> { };
+
+template<UnaryFunction UF, typename Child>
+struct NodeCount<Node<Wrap4UF<UF>, Child>> : std::integral_constant<std::size_t, 1 + NodeCount<Child>::value> { };
+
+template<BinaryFunction BF, typename Left, typename Right>
+struct NodeCount<Node<Wrap4BF<BF>, Left, Right>> : std::integral_constant<std::size_t, 1 + NodeCount<Left>::value + NodeCount<Right>::value> { };
+
 #pragma endregion
 
 #pragma region Node specialization for number
@@ -107,7 +125,7 @@ struct Node<Number<N>>
 	//!
 	//====================================================================================================================================
 
-	static std::string dump() { return std::to_string(N); }
+	static std::string dump() { return Printing::ToString<Node>(); }
 
 	//====================================================================================================================================
 	//!
@@ -119,7 +137,7 @@ struct Node<Number<N>>
 	//!
 	//====================================================================================================================================
 
-	static std::string convert2TeX() { return std::to_string(N); }
+	static std::string convert2TeX() { return Printing::ToTeX<Node>(); }
 
 	//====================================================================================================================================
 	//!
@@ -131,6 +149,9 @@ struct Node<Number<N>>
 
 	template<typename Vector>
 	static typename Vector::value_type calc(const Vector&) noexcept { return N; }
+
+	template<typename Vector, typename Policy>
+	static typename Vector::value_type calc(const Vector&, Policy&) noexcept { return N; }
 };
 
 #pragma endregion
@@ -165,7 +186,7 @@ struct Node<Wrap4UF<UF>, Node<Args...>>
 	//!
 	//====================================================================================================================================
 
-	static std::string dump() { return (GetFunctionName(UF) + "(" + Node<Args...>::dump() + ")"); }
+	static std::string dump() { return Printing::ToString<Node>(); }
 
 	//====================================================================================================================================
 	//!
@@ -177,25 +198,36 @@ struct Node<Wrap4UF<UF>, Node<Args...>>
 	//!
 	//====================================================================================================================================
 
-	static std::string convert2TeX() { return ("$" + GetFunctionName(UF) + "(" + Node<Args...>::dump() + ")$");
-	}
+	static std::string convert2TeX() { return Printing::ToTeX<Node>(); }
 
 	//====================================================================================================================================
 	//!
 	//! \brief	 Calculates the node
 	//!
+	//! \param   rValues  Functor which returns value of every variable node
+	//! \param   rPolicy  What to do on division by zero, see ErrorPolicy
+	//!
 	//! \return  Unary function result
 	//!
-	//! \throw   std:invalid_argument, std::bad_alloc
+	//! \throw   std::overflow_error by ErrorPolicy::Throwing, the default
 	//!
 	//====================================================================================================================================
 
 	template<typename Vector>
 	static typename Vector::value_type calc(const Vector &rValues)
 	{
-		const auto child = Node<Args...>::calc(rValues);
+		ErrorPolicy::Throwing policy;
 
-		return CalcUnary(Wrap4UF<UF>, child);
+		return calc(rValues, policy);
+	}
+
+	template<typename Vector, typename Policy>
+	static typename Vector::value_type calc(const Vector &rValues, Policy &rPolicy)
+	{
+		if constexpr (ErrorPolicy::IsProfiling<Policy>::value)
+			return rPolicy.template profile<Node>([&] { return UnaryOperation<UF>::calc(Node<Args...>::calc(rValues, rPolicy)); });
+		else
+			return UnaryOperation<UF>::calc(Node<Args...>::calc(rValues, rPolicy));
 	}
 };
 
@@ -234,39 +266,61 @@ struct Node<Wrap4BF<BF>, Node<LeftArgs...>, Node<RightArgs...>>
 	//!
 	//====================================================================================================================================
 
-	static std::string dump() 
-	{
-		auto left  = Left::dump();
-		auto right = Right::dump();
+	static std::string dump() { return Printing::ToString<Node>(); }
 
-		if (IsNodeBinary<Node<LeftArgs...>>::value)
-			left = "(" + left + ")";
-
-		if (IsNodeBinary<Node<RightArgs...>>::value)
-			right = "(" + right + ")";
-
-		const auto &rFuncName = GetFunctionName(BF);
+	//====================================================================================================================================
+	//!
+	//! \brief	 Converts Node to the TeX
+	//!
+	//! \return  String with binary function(with her arguments)
+	//!
+	//! \throw   std::bad_alloc
+	//!
+	//====================================================================================================================================
 
-		return (left + " " + rFuncName + " " + right); // (rFuncName + "(" + left + ", " + right + ")"));
-	}
+	static std::string convert2TeX() { return Printing::ToTeX<Node>(); }
 
 	//====================================================================================================================================
 	//!
 	//! \brief	 Calculates the node
 	//!
+	//! \param   rValues  Functor which returns value of every variable node
+	//! \param   rPolicy  What to do on division by zero, see ErrorPolicy
+	//!
 	//! \return  Binary function result
 	//!
-	//! \throw   std::overflow_error, std::invalid_argument, std::bad_alloc
+	//! \throw   std::overflow_error by ErrorPolicy::Throwing, the default
 	//!
 	//====================================================================================================================================
 
 	template<typename Vector>
 	static typename Vector::value_type calc(const Vector &rValues)
 	{
-		const auto left  = Node<LeftArgs...>::calc(rValues);
-		const auto right = Node<RightArgs...>::calc(rValues);
+		ErrorPolicy::Throwing policy;
 
-		return CalcBinary(Wrap4BF<BF> { }, left, right);
+		return calc(rValues, policy);
+	}
+
+	template<typename Vector, typename Policy>
+	static typename Vector::value_type calc(const Vector &rValues, Policy &rPolicy)
+	{
+		if constexpr (ErrorPolicy::IsProfiling<Policy>::value)
+		{
+			return rPolicy.template profile<Node>([&]
+			{
+				const auto left  = Node<LeftArgs...>::calc(rValues, rPolicy);
+				const auto right = Node<RightArgs...>::calc(rValues, rPolicy);
+
+				return BinaryOperation<BF>::calc(left, right, rPolicy);
+			});
+		}
+		else
+		{
+			const auto left  = Node<LeftArgs...>::calc(rValues, rPolicy);
+			const auto right = Node<RightArgs...>::calc(rValues, rPolicy);
+
+			return BinaryOperation<BF>::calc(left, right, rPolicy);
+		}
 	}
 };  
 
@@ -310,10 +364,19 @@ struct Node<Variable<NAME, INDEX>>
 	//!
 	//====================================================================================================================================
 
-	static std::string dump()
-	{
-		return (std::string{ NAME, '_' } + std::to_string(INDEX));
-	}
+	static std::string dump() { return Printing::ToString<Node>(); }
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Converts Node to the TeX
+	//!
+	//! \return  String with variable(NAME_{INDEX})
+	//!
+	//! \throw   std::bad_alloc
+	//!
+	//====================================================================================================================================
+
+	static std::string convert2TeX() { return Printing::ToTeX<Node>(); }
 
 	//====================================================================================================================================
 	//!
@@ -325,12 +388,150 @@ struct Node<Variable<NAME, INDEX>>
 
 	template<typename Vector>
 	static typename Vector::value_type calc(const Vector &rValues) noexcept { return rValues(Node{ }); }
+
+	template<typename Vector, typename Policy>
+	static typename Vector::value_type calc(const Vector &rValues, Policy&) noexcept { return rValues(Node{ }); }
 };
 
 #pragma endregion
 
 #pragma endregion
 
+#pragma region Text of nodes
+
+namespace Printing
+{
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Text of the operand of binary node, binary operands are parenthesized
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	constexpr auto OperandText() noexcept
+	{
+		if constexpr (IsNodeBinary<T>::value)
+			return Concat(Literal("("), Text<T>::value, Literal(")"));
+		else
+			return Text<T>::value;
+	}
+
+	template<llong_t N>
+	struct Text<Node<Number<N>>>
+	{
+		static constexpr auto value = IntegerText<N>();
+	};
+
+	template<char NAME, int INDEX>
+	struct Text<Node<Variable<NAME, INDEX>>>
+	{
+		static constexpr auto value = Concat(ConstString<2>{ { NAME, '_', '\0' } }, IntegerText<INDEX>());
+	};
+
+	template<UnaryFunction UF, typename Child>
+	struct Text<Node<Wrap4UF<UF>, Child>>
+	{
+		static constexpr auto value = Concat(FunctionText<UF>(), Literal("("), Text<Child>::value, Literal(")"));
+	};
+
+	template<BinaryFunction BF, typename Left, typename Right>
+	struct Text<Node<Wrap4BF<BF>, Left, Right>>
+	{
+		static constexpr auto value = Concat(OperandText<Left>(), Literal(" "), FunctionText<BF>(), Literal(" "), OperandText<Right>());
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	TeX of the operand of binary node, \frac and powers need no parentheses
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	struct NeedsParentheses : std::false_type { };
+
+	template<typename Left, typename Right>
+	struct NeedsParentheses<Node<WrapAdd, Left, Right>> : std::true_type { };
+
+	template<typename Left, typename Right>
+	struct NeedsParentheses<Node<WrapSub, Left, Right>> : std::true_type { };
+
+	template<typename Left, typename Right>
+	struct NeedsParentheses<Node<WrapMul, Left, Right>> : std::true_type { };
+
+	template<typename T>
+	constexpr auto OperandTeX() noexcept
+	{
+		if constexpr (NeedsParentheses<T>::value)
+			return Concat(Literal("\\left("), TeX<T>::value, Literal("\\right)"));
+		else
+			return TeX<T>::value;
+	}
+
+	template<llong_t N>
+	struct TeX<Node<Number<N>>>
+	{
+		static constexpr auto value = IntegerText<N>();
+	};
+
+	template<char NAME, int INDEX>
+	struct TeX<Node<Variable<NAME, INDEX>>>
+	{
+		static constexpr auto value = Concat(ConstString<3>{ { NAME, '_', '{', '\0' } }, IntegerText<INDEX>(), Literal("}"));
+	};
+
+	template<UnaryFunction UF, typename Child>
+	struct TeX<Node<Wrap4UF<UF>, Child>>
+	{
+		static constexpr auto value = Concat(FunctionTeX<UF>(), Literal("\\left("), TeX<Child>::value, Literal("\\right)"));
+	};
+
+	template<BinaryFunction BF, typename Left, typename Right>
+	struct TeX<Node<Wrap4BF<BF>, Left, Right>>
+	{
+		static constexpr auto value = Concat(OperandTeX<Left>(), Literal(" "), FunctionTeX<BF>(), Literal(" "), OperandTeX<Right>());
+	};
+
+	template<typename Left, typename Right>
+	struct TeX<Node<WrapDiv, Left, Right>>
+	{
+		static constexpr auto value = Concat(Literal("\\frac{"), TeX<Left>::value, Literal("}{"), TeX<Right>::value, Literal("}"));
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	TeX of the base of the power, everything except variables and non-negative numbers is parenthesized
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	struct IsAtom : std::false_type { };
+
+	template<llong_t N>
+	struct IsAtom<Node<Number<N>>> : std::bool_constant<(N >= 0)> { };
+
+	template<char NAME, int INDEX>
+	struct IsAtom<Node<Variable<NAME, INDEX>>> : std::true_type { };
+
+	template<typename T>
+	constexpr auto BaseTeX() noexcept
+	{
+		if constexpr (IsAtom<T>::value)
+			return TeX<T>::value;
+		else
+			return Concat(Literal("\\left("), TeX<T>::value, Literal("\\right)"));
+	}
+
+	template<typename Left, typename Right>
+	struct TeX<Node<WrapPow, Left, Right>>
+	{
+		static constexpr auto value = Concat(BaseTeX<Left>(), Literal("^{"), TeX<Right>::value, Literal("}"));
+	};
+
+} // namespace Printing
+
+#pragma endregion
+
 #pragma region Derivative of variable
 
 template<typename Node, typename Var>
@@ -400,7 +601,7 @@ struct Wrap4UF<UnaryFunction::COS>
 	//====================================================================================================================================
 
 	template<typename Child>
-	using der = Node<WrapNeg, Node<WrapSin>, Child>;
+	using der = Node<WrapNeg, Node<WrapSin, Child>>;
 };
 
 template<>
@@ -413,7 +614,7 @@ struct Wrap4UF<UnaryFunction::LG>
 	//====================================================================================================================================
 
 	template<typename Child>
-	using der = Node<WrapDiv, Node<Number<1>>, Child>;
+	using der = Node<WrapDiv, Node<Number<1>>, Node<WrapMul, Child, Node<WrapLn, Node<Number<10>>>>>;
 };
 
 template<>
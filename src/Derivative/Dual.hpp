@@ -0,0 +1,298 @@
+#pragma once
+
+//====================================================================================================================================
+//!
+//!	\file   Dual.hpp
+//!
+//! \brief	Forward-mode differentiation: value and full gradient in one traversal of the tree
+//!
+//====================================================================================================================================
+
+#include "Variables.hpp"
+
+#include <array> // std::array
+
+namespace ForwardMode
+{
+
+#pragma region Dual number
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Value with N tangent lanes, lane k is the derivative by the k-th variable
+	//!
+	//====================================================================================================================================
+
+	template<typename T, std::size_t N>
+	struct Dual
+	{
+		T value;
+		std::array<T, N> tangent;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Builds dual number with tangent 'scale * rTangent'
+	//!
+	//====================================================================================================================================
+
+	template<typename T, std::size_t N>
+	Dual<T, N> Scaled(T value, T scale, const std::array<T, N> &rTangent) noexcept
+	{
+		Dual<T, N> result{ value, { } };
+		for (std::size_t i = 0; i < N; ++i)
+			result.tangent[i] = scale * rTangent[i];
+
+		return result;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Builds dual number with tangent 'leftScale * rLeft + rightScale * rRight'
+	//!
+	//====================================================================================================================================
+
+	template<typename T, std::size_t N>
+	Dual<T, N> Combined(T value, T leftScale, const std::array<T, N> &rLeft, T rightScale, const std::array<T, N> &rRight) noexcept
+	{
+		Dual<T, N> result{ value, { } };
+		for (std::size_t i = 0; i < N; ++i)
+			result.tangent[i] = leftScale * rLeft[i] + rightScale * rRight[i];
+
+		return result;
+	}
+
+#pragma endregion
+
+#pragma region Unary rules
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Chain rule for unary functions, the same derivatives as Wrap4UF<UF>::der
+	//!
+	//====================================================================================================================================
+
+	template<UnaryFunction UF>
+	struct UnaryRule;
+
+	template<>
+	struct UnaryRule<UnaryFunction::SIN>
+	{
+		template<typename T, std::size_t N>
+		static Dual<T, N> apply(const Dual<T, N> &rArg) { return Scaled(std::sin(rArg.value), std::cos(rArg.value), rArg.tangent); }
+	};
+
+	template<>
+	struct UnaryRule<UnaryFunction::COS>
+	{
+		template<typename T, std::size_t N>
+		static Dual<T, N> apply(const Dual<T, N> &rArg) { return Scaled(std::cos(rArg.value), -std::sin(rArg.value), rArg.tangent); }
+	};
+
+	template<>
+	struct UnaryRule<UnaryFunction::LG>
+	{
+		template<typename T, std::size_t N>
+		static Dual<T, N> apply(const Dual<T, N> &rArg) { return Scaled(std::log10(rArg.value), 1 / (rArg.value * std::log(T(10))), rArg.tangent); }
+	};
+
+	template<>
+	struct UnaryRule<UnaryFunction::LN>
+	{
+		template<typename T, std::size_t N>
+		static Dual<T, N> apply(const Dual<T, N> &rArg) { return Scaled(std::log(rArg.value), 1 / rArg.value, rArg.tangent); }
+	};
+
+	template<>
+	struct UnaryRule<UnaryFunction::NEG>
+	{
+		template<typename T, std::size_t N>
+		static Dual<T, N> apply(const Dual<T, N> &rArg) noexcept { return Scaled(-rArg.value, T(-1), rArg.tangent); }
+	};
+
+#pragma endregion
+
+#pragma region Binary rules
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Derivative rules for binary functions, the same derivatives as Wrap4BF<BF>::der
+	//!
+	//====================================================================================================================================
+
+	template<BinaryFunction BF>
+	struct BinaryRule;
+
+	template<>
+	struct BinaryRule<BinaryFunction::ADD>
+	{
+		template<typename T, std::size_t N>
+		static Dual<T, N> apply(const Dual<T, N> &rLeft, const Dual<T, N> &rRight) noexcept
+		{
+			return Combined(rLeft.value + rRight.value, T(1), rLeft.tangent, T(1), rRight.tangent);
+		}
+	};
+
+	template<>
+	struct BinaryRule<BinaryFunction::SUB>
+	{
+		template<typename T, std::size_t N>
+		static Dual<T, N> apply(const Dual<T, N> &rLeft, const Dual<T, N> &rRight) noexcept
+		{
+			return Combined(rLeft.value - rRight.value, T(1), rLeft.tangent, T(-1), rRight.tangent);
+		}
+	};
+
+	template<>
+	struct BinaryRule<BinaryFunction::MUL>
+	{
+		template<typename T, std::size_t N>
+		static Dual<T, N> apply(const Dual<T, N> &rLeft, const Dual<T, N> &rRight) noexcept
+		{
+			return Combined(rLeft.value * rRight.value, rRight.value, rLeft.tangent, rLeft.value, rRight.tangent);
+		}
+	};
+
+	template<>
+	struct BinaryRule<BinaryFunction::DIV>
+	{
+		template<typename T, std::size_t N>
+		static Dual<T, N> apply(const Dual<T, N> &rLeft, const Dual<T, N> &rRight)
+		{
+			ErrorPolicy::Throwing policy;
+
+			const T quotient = BinaryOperation<BinaryFunction::DIV>::calc(rLeft.value, rRight.value, policy);
+
+			return Combined(quotient, 1 / rRight.value, rLeft.tangent, -quotient / rRight.value, rRight.tangent);
+		}
+	};
+
+	template<>
+	struct BinaryRule<BinaryFunction::POW>
+	{
+		//====================================================================================================================================
+		//!
+		//! \brief	 The log term is left out if the exponent does not depend on the variables, log of a negative or zero base would
+		//!			 turn the gradient into NaN; the left scale is y * x ^ (y - 1), not power * y / x, which is 0 / 0 for x = 0
+		//!
+		//====================================================================================================================================
+
+		template<typename T, std::size_t N>
+		static Dual<T, N> apply(const Dual<T, N> &rLeft, const Dual<T, N> &rRight)
+		{
+			const T power = std::pow(rLeft.value, rRight.value);
+			const T leftScale = rRight.value * std::pow(rLeft.value, rRight.value - 1);
+
+			for (std::size_t i = 0; i < N; ++i)
+			{
+				if (rRight.tangent[i] != 0)
+					return Combined(power, leftScale, rLeft.tangent, power * std::log(rLeft.value), rRight.tangent);
+			}
+
+			return Scaled(power, leftScale, rLeft.tangent);
+		}
+	};
+
+#pragma endregion
+
+#pragma region Forward evaluation of nodes
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Evaluates the node as dual number, Vars is the sorted list of variables which get tangent lanes
+	//!
+	//====================================================================================================================================
+
+	template<typename Vars, typename T>
+	struct Forward;
+
+	template<typename Vars, llong_t N>
+	struct Forward<Vars, Node<Number<N>>>
+	{
+		template<typename Vector>
+		static Dual<typename Vector::value_type, Vars::size> calc(const Vector&) noexcept
+		{
+			return { static_cast<typename Vector::value_type>(N), { } };
+		}
+	};
+
+	template<typename Vars, char NAME, int INDEX>
+	struct Forward<Vars, Node<Variable<NAME, INDEX>>>
+	{
+		template<typename Vector>
+		static Dual<typename Vector::value_type, Vars::size> calc(const Vector &rValues) noexcept
+		{
+			Dual<typename Vector::value_type, Vars::size> result{ rValues(Node<Variable<NAME, INDEX>>{ }), { } };
+			result.tangent[IndexOfValue<Vars, Node<Variable<NAME, INDEX>>>] = 1;
+
+			return result;
+		}
+	};
+
+	template<typename Vars, UnaryFunction UF, typename Child>
+	struct Forward<Vars, Node<Wrap4UF<UF>, Child>>
+	{
+		template<typename Vector>
+		static Dual<typename Vector::value_type, Vars::size> calc(const Vector &rValues)
+		{
+			return UnaryRule<UF>::apply(Forward<Vars, Child>::calc(rValues));
+		}
+	};
+
+	template<typename Vars, BinaryFunction BF, typename Left, typename Right>
+	struct Forward<Vars, Node<Wrap4BF<BF>, Left, Right>>
+	{
+		template<typename Vector>
+		static Dual<typename Vector::value_type, Vars::size> calc(const Vector &rValues)
+		{
+			const auto left  = Forward<Vars, Left>::calc(rValues);
+			const auto right = Forward<Vars, Right>::calc(rValues);
+
+			return BinaryRule<BF>::apply(left, right);
+		}
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Power with a constant exponent M, M * x ^ (M - 1) without the log term, so negative bases have finite gradients
+	//!
+	//====================================================================================================================================
+
+	template<typename Vars, typename Left, llong_t M>
+	struct Forward<Vars, Node<Wrap4BF<BinaryFunction::POW>, Left, Node<Number<M>>>>
+	{
+		template<typename Vector>
+		static Dual<typename Vector::value_type, Vars::size> calc(const Vector &rValues)
+		{
+			using value_type = typename Vector::value_type;
+
+			const auto left = Forward<Vars, Left>::calc(rValues);
+
+			if constexpr (M == 0)
+				return { value_type(1), { } };
+			else
+				return Scaled(std::pow(left.value, value_type(M)), value_type(M) * std::pow(left.value, value_type(M) - 1), left.tangent);
+		}
+	};
+
+#pragma endregion
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Calculates value and gradient of the expression in one traversal
+	//!
+	//! \param   rValues  The same functor as for Node::calc
+	//!
+	//! \return  Dual number, tangent[k] is the derivative by the k-th variable of VariablesOfResult<Expr>
+	//!
+	//! \throw   std::overflow_error
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Vector>
+	Dual<typename Vector::value_type, VariablesOfResult<Expr>::size> CalcGradient(const Vector &rValues)
+	{
+		return Forward<VariablesOfResult<Expr>, Expr>::calc(rValues);
+	}
+
+} // namespace ForwardMode
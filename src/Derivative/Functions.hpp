@@ -1,9 +1,105 @@
 #pragma once
 
-#include <cmath>       // std::sin, std::cos, std::log10, std::log
+#include <cmath>       // std::sin, std::cos, std::log10, std::log, std::pow
 #include <cassert>     // assert
-#include <type_traits> // std::is_arithmetic_v
-#include <string>  
+#include <type_traits> // std::is_arithmetic_v, std::is_integral_v
+#include <stdexcept>   // std::invalid_argument, std::overflow_error
+#include <string_view> // std::string_view
+#include <utility>     // std::declval
+
+#pragma region Error policies
+
+//====================================================================================================================================
+//!
+//! \brief	What the kernels do on division by zero. Every policy has
+//!
+//!			CHECKED          - false if the divisor is not even looked at
+//!			report(bool)     - called with true if any divisor of the operation is zero
+//!			check()          - called once after a batch, throws if an error was remembered
+//!
+//!			and optionally PROFILED, true if Node::calc passes every function node to profile<Node>(calc), see Profiling::Policy
+//!
+//====================================================================================================================================
+
+namespace ErrorPolicy
+{
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Throws std::overflow_error at the first division by zero, the default of Node::calc
+	//!
+	//====================================================================================================================================
+
+	struct Throwing
+	{
+		static constexpr bool CHECKED = true;
+
+		void report(bool divByZero) const
+		{
+			if (divByZero)
+				throw std::overflow_error("Division by zero");
+		}
+
+		void check() const noexcept { }
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	IEEE 754 semantics: division by zero gives inf or NaN which propagates, kernels are noexcept and branch-free
+	//!
+	//! \note	Integer division by zero gives the dividend, since it is undefined behavior otherwise
+	//!
+	//====================================================================================================================================
+
+	struct Ieee
+	{
+		static constexpr bool CHECKED = false;
+
+		void report(bool) const noexcept { }
+		void check() const noexcept { }
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Remembers division by zero without branches, check() throws once after the whole batch is calculated
+	//!
+	//====================================================================================================================================
+
+	class Sticky
+	{
+	public:
+		static constexpr bool CHECKED = true;
+
+		void report(bool divByZero) noexcept { m_DivByZero |= divByZero; }
+
+		void check() const
+		{
+			if (m_DivByZero)
+				throw std::overflow_error("Division by zero");
+		}
+
+		bool failed() const noexcept { return m_DivByZero; }
+		void clear() noexcept { m_DivByZero = false; }
+
+	private:
+		bool m_DivByZero = false;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Checks is Policy::PROFILED true, otherwise Node::calc is the same code as without profiling
+	//!
+	//====================================================================================================================================
+
+	template<typename Policy, typename Enable = void>
+	struct IsProfiling : std::false_type { };
+
+	template<typename Policy>
+	struct IsProfiling<Policy, std::enable_if_t<Policy::PROFILED>> : std::true_type { };
+
+} // namespace ErrorPolicy
+
+#pragma endregion
 
 #pragma region Unary Function
 
@@ -28,34 +124,105 @@ enum class UnaryFunction
 //!
 //! \param   uf  Unary function
 //!
-//! \return  Name of unary function or "undefined"
+//! \return  Name of unary function or "undefined", static storage, so nothing is allocated
 //!
-//! \throw   std::bad_alloc
+//====================================================================================================================================
+
+constexpr std::string_view GetFunctionName(UnaryFunction uf) noexcept
+{
+	switch (uf)
+	{
+	case UnaryFunction::SIN:
+		return "sin";
+	case UnaryFunction::COS:
+		return "cos";
+	case UnaryFunction::LG:
+		return "lg";
+	case UnaryFunction::LN:
+		return "ln";
+	case UnaryFunction::NEG:
+		return "-";
+	default:
+		return "undefined";
+	}
+}
+
+//====================================================================================================================================
+//!
+//! \brief	 Returns TeX command of the function
+//!
+//! \param   uf  Unary function
+//!
+//! \return  TeX command of unary function or "undefined"
 //!
 //====================================================================================================================================
 
-inline std::string GetFunctionName(UnaryFunction uf) 
+constexpr std::string_view GetFunctionTeX(UnaryFunction uf) noexcept
 {
 	switch (uf)
 	{
 	case UnaryFunction::SIN:
-		return std::string("sin");
+		return "\\sin";
 	case UnaryFunction::COS:
-		return std::string("cos");
+		return "\\cos";
 	case UnaryFunction::LG:
-		return std::string("lg");
+		return "\\lg";
 	case UnaryFunction::LN:
-		return std::string("ln");
+		return "\\ln";
 	case UnaryFunction::NEG:
-		return std::string("-");
+		return "-";
 	default:
-		return std::string("undefined");
+		return "undefined";
 	}
 }
 
 //====================================================================================================================================
 //!
-//! \brief	 Calculates unary function
+//! \brief	Unary function selected at compile time, the callers with UF as template parameter have no switch
+//!
+//====================================================================================================================================
+
+template<UnaryFunction UF>
+struct UnaryOperation;
+
+template<>
+struct UnaryOperation<UnaryFunction::SIN>
+{
+	template<typename T>
+	static T calc(T value) noexcept { return std::sin(value); }
+};
+
+template<>
+struct UnaryOperation<UnaryFunction::COS>
+{
+	template<typename T>
+	static T calc(T value) noexcept { return std::cos(value); }
+};
+
+template<>
+struct UnaryOperation<UnaryFunction::LG>
+{
+	template<typename T>
+	static T calc(T value) noexcept { return std::log10(value); }
+};
+
+template<>
+struct UnaryOperation<UnaryFunction::LN>
+{
+	template<typename T>
+	static T calc(T value) noexcept { return std::log(value); }
+};
+
+template<>
+struct UnaryOperation<UnaryFunction::NEG>
+{
+	template<typename T>
+	static T calc(T value) noexcept { return (-value); }
+};
+
+//====================================================================================================================================
+//!
+//! \brief	 Calculates unary function, dispatches at runtime to UnaryOperation
 //!
 //! \param   uf     Unary function
 //! \param   value  Argument of the unary function
@@ -74,15 +241,15 @@ T CalcUnary(UnaryFunction uf, T value)
 	switch (uf)
 	{
 	case UnaryFunction::SIN:
-		return std::sin(value);
+		return UnaryOperation<UnaryFunction::SIN>::calc(value);
 	case UnaryFunction::COS:
-		return std::cos(value);
+		return UnaryOperation<UnaryFunction::COS>::calc(value);
 	case UnaryFunction::LG:
-		return std::log10(value);
+		return UnaryOperation<UnaryFunction::LG>::calc(value);
 	case UnaryFunction::LN:
-		return std::log(value);
+		return UnaryOperation<UnaryFunction::LN>::calc(value);
 	case UnaryFunction::NEG:
-		return (-value);
+		return UnaryOperation<UnaryFunction::NEG>::calc(value);
 	default:
 		throw std::invalid_argument("Undefined unary function\n");
 	}
@@ -126,72 +293,157 @@ enum class BinaryFunction
 //!
 //! \param   bf  Binary function
 //!
-//! \return  Name of binary function or "undefined"
+//! \return  Name of binary function or "undefined", static storage, so nothing is allocated
+//!
+//====================================================================================================================================
+
+constexpr std::string_view GetFunctionName(BinaryFunction bf) noexcept
+{
+	switch (bf)
+	{
+	case BinaryFunction::ADD:
+		return "+";
+	case BinaryFunction::SUB:
+		return "-";
+	case BinaryFunction::MUL:
+		return "*";
+	case BinaryFunction::DIV:
+		return "/";
+	case BinaryFunction::POW:
+		return "^";
+	default:
+		return "undefined";
+	}
+}
+
+//====================================================================================================================================
+//!
+//! \brief	 Returns TeX operator of the function, DIV and POW are written as \frac{}{} and {}^{} instead
 //!
-//! \throw   std::bad_alloc
+//! \param   bf  Binary function
+//!
+//! \return  TeX operator of binary function or "undefined"
 //!
 //====================================================================================================================================
 
-inline std::string GetFunctionName(BinaryFunction bf) 
+constexpr std::string_view GetFunctionTeX(BinaryFunction bf) noexcept
 {
 	switch (bf)
 	{
 	case BinaryFunction::ADD:
-		return std::string("+");
+		return "+";
 	case BinaryFunction::SUB:
-		return std::string("-");
+		return "-";
 	case BinaryFunction::MUL:
-		return std::string("*");
+		return "\\cdot";
 	case BinaryFunction::DIV:
-		return std::string("/");
+		return "\\frac";
 	case BinaryFunction::POW:
-		return std::string("^");
+		return "^";
 	default:
-		return std::string("undefined");
+		return "undefined";
 	}
 }
 
 //====================================================================================================================================
 //!
-//! \brief	 Calculates bianry function
+//! \brief	Binary function selected at compile time, only DIV consults the error policy
+//!
+//====================================================================================================================================
+
+template<BinaryFunction BF>
+struct BinaryOperation;
+
+template<>
+struct BinaryOperation<BinaryFunction::ADD>
+{
+	template<typename T, typename Policy>
+	static T calc(T left, T right, Policy&) noexcept { return (left + right); }
+};
+
+template<>
+struct BinaryOperation<BinaryFunction::SUB>
+{
+	template<typename T, typename Policy>
+	static T calc(T left, T right, Policy&) noexcept { return (left - right); }
+};
+
+template<>
+struct BinaryOperation<BinaryFunction::MUL>
+{
+	template<typename T, typename Policy>
+	static T calc(T left, T right, Policy&) noexcept { return (left * right); }
+};
+
+template<>
+struct BinaryOperation<BinaryFunction::DIV>
+{
+	template<typename T, typename Policy>
+	static T calc(T left, T right, Policy &rPolicy) noexcept(noexcept(rPolicy.report(true)))
+	{
+		if constexpr (Policy::CHECKED)
+			rPolicy.report(right == T(0));
+
+		// Integer division by zero is undefined, the divisor becomes 1 without a branch if the policy has not thrown
+		if constexpr (std::is_integral_v<T>)
+			right += static_cast<T>(right == T(0));
+
+		return (left / right);
+	}
+};
+
+template<>
+struct BinaryOperation<BinaryFunction::POW>
+{
+	template<typename T, typename Policy>
+	static T calc(T left, T right, Policy&) noexcept { return std::pow(left, right); }
+};
+
+//====================================================================================================================================
+//!
+//! \brief	 Calculates binary function, dispatches at runtime to BinaryOperation
 //!
-//! \param   bf     Binary function
-//! \param   left   Left argument
-//! \param   right  Right argument
+//! \param   bf       Binary function
+//! \param   left     Left argument
+//! \param   right    Right argument
+//! \param   rPolicy  Error policy
 //!
-//! \return  Name of binary function or "undefined"
+//! \return  Result of binary function
 //!
-//! \throw   std::invalid_argument, std::bad_alloc
+//! \throw   std::invalid_argument, std::overflow_error if the policy throws
 //!
 //====================================================================================================================================
 
-template<typename T>
-T CalcBinary(BinaryFunction uf, T left, T right)
+template<typename T, typename Policy>
+T CalcBinary(BinaryFunction bf, T left, T right, Policy &rPolicy)
 {
 	static_assert(std::is_arithmetic_v<T>, "Type T must be arithmetic");
 
-	switch (uf)
+	switch (bf)
 	{
 	case BinaryFunction::ADD:
-		return (left + right);
+		return BinaryOperation<BinaryFunction::ADD>::calc(left, right, rPolicy);
 	case BinaryFunction::SUB:
-		return (left - right);
+		return BinaryOperation<BinaryFunction::SUB>::calc(left, right, rPolicy);
 	case BinaryFunction::DIV:
-	{
-		if (!right)
-			throw std::overflow_error("Division by zero");
-
-		return (left / right); 
-	}
+		return BinaryOperation<BinaryFunction::DIV>::calc(left, right, rPolicy);
 	case BinaryFunction::MUL:
-		return (left * right);
+		return BinaryOperation<BinaryFunction::MUL>::calc(left, right, rPolicy);
 	case BinaryFunction::POW:
-		return std::pow(left, right);
+		return BinaryOperation<BinaryFunction::POW>::calc(left, right, rPolicy);
 	default:
-		throw std::invalid_argument("Undefined unary function\n");
+		throw std::invalid_argument("Undefined binary function\n");
 	}
 }
 
+template<typename T>
+T CalcBinary(BinaryFunction bf, T left, T right)
+{
+	ErrorPolicy::Throwing policy;
+
+	return CalcBinary(bf, left, right, policy);
+}
+
 #pragma region Wrapper for binary functions
 
 template<BinaryFunction>
@@ -0,0 +1,578 @@
+#pragma once
+
+//====================================================================================================================================
+//!
+//!	\file   Native.hpp
+//!
+//! \brief	Ahead-of-time backend: lowered programs emitted as C, compiled by the system compiler and loaded as shared objects
+//!
+//====================================================================================================================================
+
+#include "Runtime.hpp"
+#include "Variables.hpp"
+
+#include <atomic>       // std::atomic
+#include <cerrno>       // errno, EEXIST
+#include <cstdint>      // std::uint64_t
+#include <cstdio>       // std::snprintf
+#include <cstdlib>      // std::system, std::getenv
+#include <filesystem>   // std::filesystem::path, std::filesystem::exists, std::filesystem::rename
+#include <fstream>      // std::ofstream
+#include <limits>       // std::numeric_limits
+#include <memory>       // std::shared_ptr
+#include <stdexcept>    // std::runtime_error
+#include <string>       // std::string, std::to_string
+#include <system_error> // std::error_code
+
+#if defined(_WIN32)
+#if !defined(NOMINMAX)
+#define NOMINMAX
+#endif /* !defined(NOMINMAX) */
+#include <windows.h> // LoadLibraryA, GetProcAddress
+#else
+#include <dlfcn.h>    // dlopen, dlsym
+#include <sys/stat.h> // mkdir, lstat
+#include <unistd.h>   // getpid, geteuid
+#endif /* defined(_WIN32) */
+
+namespace Native
+{
+
+#pragma region Code generation
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Names of the functions of every generated shared object
+	//!
+	//====================================================================================================================================
+
+	constexpr const char *CALC_SYMBOL = "derivative_calc";
+	constexpr const char *CALC_BATCH_SYMBOL = "derivative_calc_batch";
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Appends the C statement of one instruction, registers are locals r0, r1, ...; division ORs the zero test into div
+	//!
+	//====================================================================================================================================
+
+	inline void AppendStatement(std::string &rSource, const Lowering::Instruction &rInstruction, bool batch)
+	{
+		const std::string target = "r" + std::to_string(rInstruction.target);
+		const std::string left = "r" + std::to_string(rInstruction.left);
+		const std::string right = "r" + std::to_string(rInstruction.right);
+
+		rSource += "\t\t" + target + " = ";
+
+		switch (rInstruction.code)
+		{
+		case Lowering::OpCode::NUMBER:
+			rSource += (rInstruction.constant == std::numeric_limits<llong_t>::min() ?
+				"(double)(-9223372036854775807LL - 1)" : "(double)" + std::to_string(rInstruction.constant) + "LL");
+			break;
+		case Lowering::OpCode::VARIABLE:
+			rSource += (batch ? "c[" : "v[") + std::to_string(rInstruction.left) + (batch ? "][i]" : "]");
+			break;
+		case Lowering::OpCode::SIN:
+			rSource += "sin(" + left + ")";
+			break;
+		case Lowering::OpCode::COS:
+			rSource += "cos(" + left + ")";
+			break;
+		case Lowering::OpCode::LG:
+			rSource += "log10(" + left + ")";
+			break;
+		case Lowering::OpCode::LN:
+			rSource += "log(" + left + ")";
+			break;
+		case Lowering::OpCode::NEG:
+			rSource += "-" + left;
+			break;
+		case Lowering::OpCode::ADD:
+			rSource += left + " + " + right;
+			break;
+		case Lowering::OpCode::SUB:
+			rSource += left + " - " + right;
+			break;
+		case Lowering::OpCode::MUL:
+			rSource += left + " * " + right;
+			break;
+		case Lowering::OpCode::DIV:
+			rSource += "(div |= (" + right + " == 0.0), " + left + " / " + right + ")";
+			break;
+		case Lowering::OpCode::POW:
+			rSource += "pow(" + left + ", " + right + ")";
+			break;
+		}
+
+		rSource += ";\n";
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Emits the program as C: one function for a point and one loop over columns, every unique subexpression is a temporary
+	//!
+	//! \param   pCode  Instructions after register allocation, the last one is the result
+	//! \param   size   Number of instructions
+	//!
+	//! \return  Source of a translation unit which exports CALC_SYMBOL and CALC_BATCH_SYMBOL
+	//!
+	//! \throw   std::bad_alloc
+	//!
+	//====================================================================================================================================
+
+	inline std::string GenerateC(const Lowering::Instruction *pCode, std::size_t size)
+	{
+		const std::size_t registers = Lowering::CountRegisters(pCode, size);
+
+		std::string declaration = "\t\tdouble";
+		for (std::size_t i = 0; i < registers; ++i)
+			declaration += (i ? ", r" : " r") + std::to_string(i);
+		declaration += ";\n";
+
+		const std::string result = "r" + std::to_string(pCode[size - 1].target);
+
+		std::string source =
+			"/* generated by Native::GenerateC, format 1 */\n"
+			"#include <math.h>\n"
+			"#include <stddef.h>\n"
+			"\n"
+			"#if defined(_WIN32)\n"
+			"#define EXPORT __declspec(dllexport)\n"
+			"#else\n"
+			"#define EXPORT __attribute__((visibility(\"default\")))\n"
+			"#endif\n"
+			"\n";
+
+		source += "EXPORT double " + std::string(CALC_SYMBOL) + "(const double *v, int *pDivByZero)\n{\n\tint div = 0;\n\t{\n" + declaration;
+		for (std::size_t i = 0; i < size; ++i)
+			AppendStatement(source, pCode[i], false);
+		source += "\t\t*pDivByZero |= div;\n\t\treturn " + result + ";\n\t}\n}\n\n";
+
+		source += "EXPORT void " + std::string(CALC_BATCH_SYMBOL) + "(const double *const *c, double *pResult, size_t count, int *pDivByZero)\n{\n"
+			"\tint div = 0;\n\tfor (size_t i = 0; i < count; ++i)\n\t{\n" + declaration;
+		for (std::size_t i = 0; i < size; ++i)
+			AppendStatement(source, pCode[i], true);
+		source += "\t\tpResult[i] = " + result + ";\n\t}\n\t*pDivByZero |= div;\n}\n";
+
+		return source;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 64-bit FNV-1a hash of the text, names the cached shared object
+	//!
+	//====================================================================================================================================
+
+	inline std::uint64_t Hash(const std::string &rText) noexcept
+	{
+		std::uint64_t hash = 0xCBF29CE484222325ull;
+		for (const char c : rText)
+			hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001B3ull;
+
+		return hash;
+	}
+
+#pragma endregion
+
+#pragma region Shared objects
+
+	//====================================================================================================================================
+	//!
+	//! \brief	How the shared objects are built and where they are cached
+	//!
+	//====================================================================================================================================
+
+	struct Options
+	{
+#if defined(_WIN32)
+		std::string compiler = "cl /nologo /O2 /LD";
+		std::string output = "/Fe";
+		std::string extension = ".dll";
+#else
+		std::string compiler = "cc -O2 -fPIC -shared -fno-math-errno";
+		std::string output = "-o ";
+		std::string extension = ".so";
+#endif /* defined(_WIN32) */
+
+		//====================================================================================================================================
+		//!
+		//! \brief	Cache of the shared objects, CacheDirectory() if empty; it must belong to the user and be writable by nobody else
+		//!
+		//====================================================================================================================================
+
+		std::filesystem::path directory;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Loaded shared object, unloaded with the last owner
+	//!
+	//====================================================================================================================================
+
+	class Library
+	{
+	public:
+		//====================================================================================================================================
+		//!
+		//! \brief	 Loads the shared object
+		//!
+		//! \throw   std::runtime_error
+		//!
+		//====================================================================================================================================
+
+		explicit Library(const std::filesystem::path &rPath)
+		{
+#if defined(_WIN32)
+			m_pHandle = LoadLibraryA(rPath.string().c_str());
+			if (!m_pHandle)
+				throw std::runtime_error("Cannot load " + rPath.string());
+#else
+			m_pHandle = ::dlopen(rPath.c_str(), RTLD_NOW | RTLD_LOCAL);
+			if (!m_pHandle)
+				throw std::runtime_error(::dlerror());
+#endif /* defined(_WIN32) */
+		}
+
+		Library(const Library&) = delete;
+		Library& operator=(const Library&) = delete;
+
+		~Library()
+		{
+#if defined(_WIN32)
+			FreeLibrary(static_cast<HMODULE>(m_pHandle));
+#else
+			::dlclose(m_pHandle);
+#endif /* defined(_WIN32) */
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Address of the exported function
+		//!
+		//! \throw   std::runtime_error if there is no such symbol
+		//!
+		//====================================================================================================================================
+
+		template<typename Func>
+		Func* symbol(const char *pName) const
+		{
+#if defined(_WIN32)
+			void *pSymbol = reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(m_pHandle), pName));
+#else
+			void *pSymbol = ::dlsym(m_pHandle, pName);
+#endif /* defined(_WIN32) */
+
+			if (!pSymbol)
+				throw std::runtime_error(std::string("No symbol ") + pName);
+
+			return reinterpret_cast<Func*>(pSymbol);
+		}
+
+	private:
+#if defined(_WIN32)
+		HMODULE m_pHandle;
+#else
+		void *m_pHandle;
+#endif /* defined(_WIN32) */
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Default cache of the shared objects: derivative-native in $XDG_CACHE_HOME or ~/.cache, in %LOCALAPPDATA% on Windows
+	//!
+	//! \throw   std::runtime_error if the variables are not set, std::bad_alloc
+	//!
+	//====================================================================================================================================
+
+	inline std::filesystem::path CacheDirectory()
+	{
+#if defined(_WIN32)
+		const char *pLocal = std::getenv("LOCALAPPDATA");
+		if (!pLocal || !*pLocal)
+			throw std::runtime_error("LOCALAPPDATA is not set");
+
+		return std::filesystem::path(pLocal).append("derivative-native");
+#else
+		const char *pCache = std::getenv("XDG_CACHE_HOME");
+		if (pCache && *pCache == '/')
+			return std::filesystem::path(pCache).append("derivative-native");
+
+		const char *pHome = std::getenv("HOME");
+		if (!pHome || *pHome != '/')
+			throw std::runtime_error("Neither XDG_CACHE_HOME nor HOME is set");
+
+		return std::filesystem::path(pHome).append(".cache").append("derivative-native");
+#endif /* defined(_WIN32) */
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Creates the cache directory with mode 0700 if it is missing and checks that it may be trusted: a directory, not a link,
+	//!			 owned by the effective user and not writable by the group or others, so nobody else can plant a shared object in it
+	//!
+	//! \throw   std::runtime_error if it may not be trusted, std::filesystem::filesystem_error, std::bad_alloc
+	//!
+	//! \note	 On Windows the directory is only created, it is expected in the profile of the user whose ACL keeps others out
+	//!
+	//====================================================================================================================================
+
+	inline void PrepareDirectory(const std::filesystem::path &rDirectory)
+	{
+		if (rDirectory.has_parent_path())
+			std::filesystem::create_directories(rDirectory.parent_path());
+
+#if defined(_WIN32)
+		std::filesystem::create_directory(rDirectory);
+#else
+		if (::mkdir(rDirectory.c_str(), 0700) && errno != EEXIST)
+			throw std::runtime_error("Cannot create " + rDirectory.string());
+
+		struct stat status;
+		if (::lstat(rDirectory.c_str(), &status) || !S_ISDIR(status.st_mode) || status.st_uid != ::geteuid() || (status.st_mode & (S_IWGRP | S_IWOTH)))
+			throw std::runtime_error("Untrusted cache directory " + rDirectory.string());
+#endif /* defined(_WIN32) */
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Whether the cached shared object exists and is a regular file of the effective user
+	//!
+	//====================================================================================================================================
+
+	inline bool IsCached(const std::filesystem::path &rLibrary)
+	{
+#if defined(_WIN32)
+		return std::filesystem::exists(rLibrary);
+#else
+		struct stat status;
+
+		return !::lstat(rLibrary.c_str(), &status) && S_ISREG(status.st_mode) && status.st_uid == ::geteuid();
+#endif /* defined(_WIN32) */
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Returns the cached shared object of the source or builds it: the source and the object are written under names unique
+	//!			 to the build and renamed at the end, so concurrent builds of the same source, by processes or threads, never see
+	//!			 the partial or overwritten files of each other
+	//!
+	//! \param   rSource   Translation unit
+	//! \param   rOptions  Compiler and cache directory, see PrepareDirectory
+	//! \param   pBuilt    Set to true if the compiler ran, false if the object was in the cache
+	//!
+	//! \return  Path of the shared object
+	//!
+	//! \throw   std::runtime_error if the compiler fails or the directory may not be trusted, std::filesystem::filesystem_error,
+	//!			 std::bad_alloc
+	//!
+	//====================================================================================================================================
+
+	inline std::filesystem::path Build(const std::string &rSource, const Options &rOptions, bool *pBuilt = nullptr)
+	{
+		const std::filesystem::path directory = (rOptions.directory.empty() ? CacheDirectory() : rOptions.directory);
+		PrepareDirectory(directory);
+
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(Hash(rOptions.compiler + '\n' + rSource)));
+
+		const std::filesystem::path library = directory / (name + rOptions.extension);
+
+		if (pBuilt)
+			*pBuilt = false;
+
+		if (IsCached(library))
+			return library;
+
+		static std::atomic<unsigned> s_Builds{ 0 };
+
+#if defined(_WIN32)
+		const std::string unique = std::to_string(GetCurrentProcessId()) + '-' + std::to_string(s_Builds++);
+#else
+		const std::string unique = std::to_string(::getpid()) + '-' + std::to_string(s_Builds++);
+#endif /* defined(_WIN32) */
+
+		const std::filesystem::path source = directory / (name + std::string(".c"));
+		const std::filesystem::path temporarySource = directory / (name + ("." + unique) + ".c");
+		const std::filesystem::path temporary = directory / (name + ("." + unique) + rOptions.extension);
+
+		{
+			std::ofstream file(temporarySource, std::ios::binary | std::ios::trunc);
+			file << rSource;
+			if (!file)
+				throw std::runtime_error("Cannot write " + temporarySource.string());
+		}
+
+		const std::string command = rOptions.compiler + ' ' + rOptions.output + '"' + temporary.string() + "\" \"" + temporarySource.string() + '"'
+#if !defined(_WIN32)
+			+ " -lm"
+#endif /* !defined(_WIN32) */
+			;
+
+		if (std::system(command.c_str()))
+		{
+			std::error_code error;
+			std::filesystem::remove(temporary, error);
+			std::filesystem::remove(temporarySource, error);
+			throw std::runtime_error("Compiler failed: " + command);
+		}
+
+		// the source stays next to the object for reading
+		std::filesystem::rename(temporarySource, source);
+		std::filesystem::rename(temporary, library);
+
+		if (pBuilt)
+			*pBuilt = true;
+
+		return library;
+	}
+
+#pragma endregion
+
+#pragma region Function
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Compiled expression, copies share the loaded library
+	//!
+	//====================================================================================================================================
+
+	class Function
+	{
+	public:
+		using Calc = double(const double*, int*);
+		using CalcBatch = void(const double *const*, double*, std::size_t, int*);
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Compiles the instructions or loads them from the cache
+		//!
+		//! \param   pCode     Instructions after register allocation
+		//! \param   size      Number of instructions
+		//! \param   rOptions  Compiler and cache directory
+		//!
+		//! \throw   std::runtime_error, std::filesystem::filesystem_error, std::bad_alloc
+		//!
+		//====================================================================================================================================
+
+		Function(const Lowering::Instruction *pCode, std::size_t size, const Options &rOptions = { })
+		{
+			m_Path = Build(GenerateC(pCode, size), rOptions, &m_Built);
+			m_pLibrary = std::make_shared<Library>(m_Path);
+			m_pCalc = m_pLibrary->symbol<Calc>(CALC_SYMBOL);
+			m_pCalcBatch = m_pLibrary->symbol<CalcBatch>(CALC_BATCH_SYMBOL);
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Calculates the expression for one point
+		//!
+		//! \param   pVariables  Values in the order of the variables of the program
+		//! \param   rPolicy     What to do on division by zero, see ErrorPolicy
+		//!
+		//! \throw   std::overflow_error by ErrorPolicy::Throwing, the default
+		//!
+		//====================================================================================================================================
+
+		template<typename Policy>
+		double calc(const double *pVariables, Policy &rPolicy) const
+		{
+			int divByZero = 0;
+			const double result = m_pCalc(pVariables, &divByZero);
+			rPolicy.report(divByZero != 0);
+
+			return result;
+		}
+
+		double calc(const double *pVariables) const
+		{
+			ErrorPolicy::Throwing policy;
+
+			return calc(pVariables, policy);
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Calculates the expression for count points
+		//!
+		//! \param   ppColumns  Columns in the order of the variables of the program
+		//! \param   pResult    Output, at least count values
+		//! \param   count      Number of points
+		//! \param   rPolicy    What to do on division by zero, see ErrorPolicy; its check() is left to the caller
+		//!
+		//====================================================================================================================================
+
+		template<typename Policy>
+		void calcBatch(const double *const *ppColumns, double *pResult, std::size_t count, Policy &rPolicy) const
+		{
+			int divByZero = 0;
+			m_pCalcBatch(ppColumns, pResult, count, &divByZero);
+			rPolicy.report(divByZero != 0);
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 The same with ErrorPolicy::Sticky which is checked once after the whole batch
+		//!
+		//! \throw   std::overflow_error if any division by zero occurred, the result is calculated for every point anyway
+		//!
+		//====================================================================================================================================
+
+		void calcBatch(const double *const *ppColumns, double *pResult, std::size_t count) const
+		{
+			ErrorPolicy::Sticky policy;
+
+			calcBatch(ppColumns, pResult, count, policy);
+			policy.check();
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Shared object of the function and whether the compiler ran for it or it came from the cache
+		//!
+		//====================================================================================================================================
+
+		const std::filesystem::path& path() const noexcept { return m_Path; }
+		bool built() const noexcept { return m_Built; }
+
+	private:
+		std::filesystem::path m_Path;
+		bool m_Built = false;
+		std::shared_ptr<Library> m_pLibrary;
+		Calc *m_pCalc = nullptr;
+		CalcBatch *m_pCalcBatch = nullptr;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Compiles the expression known at compile time, variables are in the order of Slots<VariablesOfResult<Expr>>
+	//!
+	//! \note	 Simplify a derivative first, e.g. Symbolic::DerivativeResult: the generated code has one temporary per unique subtree
+	//!
+	//! \throw   std::runtime_error, std::filesystem::filesystem_error, std::bad_alloc
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr>
+	Function Compile(const Options &rOptions = { })
+	{
+		using Program = Lowering::Program<Expr>;
+
+		return Function(Program::CODE.data(), Program::SIZE, rOptions);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Compiles the expression known at runtime, variables are in the order of rProgram.variables
+	//!
+	//! \throw   std::runtime_error, std::filesystem::filesystem_error, std::bad_alloc
+	//!
+	//====================================================================================================================================
+
+	inline Function Compile(const Runtime::Program &rProgram, const Options &rOptions = { })
+	{
+		return Function(rProgram.code.data(), rProgram.code.size(), rOptions);
+	}
+
+#pragma endregion
+
+} // namespace Native
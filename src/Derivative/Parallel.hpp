@@ -0,0 +1,641 @@
+#pragma once
+
+//====================================================================================================================================
+//!
+//!	\file   Parallel.hpp
+//!
+//! \brief	Evaluation of expressions over large point sets and parameter grids on a work-stealing thread pool
+//!
+//====================================================================================================================================
+
+#include "Batch.hpp"
+#include "Symbolic.hpp"
+#include "Variables.hpp"
+
+#include <algorithm>          // std::min, std::max
+#include <array>              // std::array
+#include <atomic>             // std::atomic
+#include <condition_variable> // std::condition_variable
+#include <cstdint>            // std::uintptr_t
+#include <exception>          // std::exception_ptr
+#include <memory>             // std::unique_ptr
+#include <mutex>              // std::mutex, std::unique_lock
+#include <stdexcept>          // std::invalid_argument
+#include <thread>             // std::thread
+#include <vector>             // std::vector
+
+namespace Parallel
+{
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Size of the cache line, data written by different threads never shares one
+	//!
+	//====================================================================================================================================
+
+	constexpr std::size_t CACHE_LINE = 64;
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Bytes of the columns of one chunk, so that the chunk stays in L2 while every output is calculated
+	//!
+	//====================================================================================================================================
+
+	constexpr std::size_t CHUNK_BYTES = 128 * 1024;
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Value alone in its cache line
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	struct alignas(CACHE_LINE) Padded
+	{
+		T value;
+	};
+
+#pragma region Thread pool
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Fixed set of workers which run parallel loops, the calling thread is worker 0
+	//!
+	//! \note	Every worker owns a range of the iterations and takes them from its front. A worker with an empty range steals
+	//!			the upper half of the range of another one, so uneven iterations are balanced without a shared queue
+	//!
+	//====================================================================================================================================
+
+	class ThreadPool
+	{
+	public:
+		//====================================================================================================================================
+		//!
+		//! \brief	 Starts threads - 1 background workers
+		//!
+		//! \param   threads  Number of workers including the calling thread, 0 means one per hardware thread
+		//!
+		//! \throw   std::system_error, std::bad_alloc
+		//!
+		//====================================================================================================================================
+
+		explicit ThreadPool(std::size_t threads = 0) :
+			m_Size(threads ? threads : std::max(1u, std::thread::hardware_concurrency())),
+			m_pSlots(new Slot[m_Size])
+		{
+			m_Threads.reserve(m_Size - 1);
+			for (std::size_t worker = 1; worker < m_Size; ++worker)
+				m_Threads.emplace_back(&ThreadPool::loop, this, worker);
+		}
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		~ThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Stop = true;
+			}
+
+			m_Wake.notify_all();
+			for (auto &rThread : m_Threads)
+				rThread.join();
+		}
+
+		std::size_t size() const noexcept { return m_Size; }
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Calls func(index, worker) for every index in [0, count), returns when all calls returned
+		//!
+		//! \param   count  Number of iterations
+		//! \param   func   Iteration, worker is in [0, size()) and no two iterations run on the same worker at once
+		//!
+		//! \throw   The first exception thrown by func, the remaining iterations are skipped then
+		//!
+		//====================================================================================================================================
+
+		template<typename Func>
+		void parallelFor(std::size_t count, Func func)
+		{
+			run(count, [](void *pContext, std::size_t index, std::size_t worker) { (*static_cast<Func*>(pContext))(index, worker); }, &func);
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Scratch of the worker, kept between the loops so that a warm pool does not allocate
+		//!
+		//! \param   worker  Worker of the calling iteration
+		//! \param   size    Number of values needed
+		//!
+		//! \throw   std::bad_alloc
+		//!
+		//====================================================================================================================================
+
+		double* scratch(std::size_t worker, std::size_t size)
+		{
+			auto &rScratch = m_pSlots[worker].scratch;
+			if (rScratch.size() < size)
+				rScratch.resize(size);
+
+			return rScratch.data();
+		}
+
+	private:
+		using Trampoline = void (*)(void*, std::size_t, std::size_t);
+
+		struct alignas(CACHE_LINE) Slot
+		{
+			std::mutex mutex;
+			std::size_t next = 0;
+			std::size_t end = 0;
+			std::vector<double> scratch;
+		};
+
+		void run(std::size_t count, Trampoline pTrampoline, void *pContext)
+		{
+			if (!count)
+				return;
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+
+				m_pTrampoline = pTrampoline;
+				m_pContext = pContext;
+				m_Error = nullptr;
+				m_Cancelled = false;
+
+				for (std::size_t worker = 0; worker < m_Size; ++worker)
+				{
+					std::lock_guard<std::mutex> slotLock(m_pSlots[worker].mutex);
+					m_pSlots[worker].next = count * worker / m_Size;
+					m_pSlots[worker].end = count * (worker + 1) / m_Size;
+				}
+
+				m_Busy = m_Size - 1;
+				++m_Generation;
+			}
+
+			m_Wake.notify_all();
+			work(0);
+
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Done.wait(lock, [this] { return !m_Busy; });
+
+			if (m_Error)
+				std::rethrow_exception(m_Error);
+		}
+
+		bool take(std::size_t worker, std::size_t &rIndex)
+		{
+			Slot &rSlot = m_pSlots[worker];
+			std::lock_guard<std::mutex> lock(rSlot.mutex);
+
+			if (rSlot.next == rSlot.end)
+				return false;
+
+			rIndex = rSlot.next++;
+			return true;
+		}
+
+		bool steal(std::size_t worker)
+		{
+			for (std::size_t i = 1; i < m_Size; ++i)
+			{
+				Slot &rVictim = m_pSlots[(worker + i) % m_Size];
+
+				std::size_t first = 0;
+				std::size_t last = 0;
+				{
+					std::lock_guard<std::mutex> lock(rVictim.mutex);
+					if (rVictim.next == rVictim.end)
+						continue;
+
+					first = rVictim.end - (rVictim.end - rVictim.next + 1) / 2;
+					last = rVictim.end;
+					rVictim.end = first;
+				}
+
+				Slot &rSlot = m_pSlots[worker];
+				std::lock_guard<std::mutex> lock(rSlot.mutex);
+				rSlot.next = first;
+				rSlot.end = last;
+
+				return true;
+			}
+
+			return false;
+		}
+
+		void work(std::size_t worker) noexcept
+		{
+			std::size_t index = 0;
+
+			while (take(worker, index) || (steal(worker) && take(worker, index)))
+			{
+				if (m_Cancelled.load(std::memory_order_relaxed))
+					continue;
+
+				try
+				{
+					m_pTrampoline(m_pContext, index, worker);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock(m_Mutex);
+					if (!m_Error)
+						m_Error = std::current_exception();
+
+					m_Cancelled = true;
+				}
+			}
+		}
+
+		void loop(std::size_t worker)
+		{
+			std::size_t generation = 0;
+
+			for (;;)
+			{
+				{
+					std::unique_lock<std::mutex> lock(m_Mutex);
+					m_Wake.wait(lock, [&] { return m_Stop || m_Generation != generation; });
+
+					if (m_Stop)
+						return;
+
+					generation = m_Generation;
+				}
+
+				work(worker);
+
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				if (!--m_Busy)
+					m_Done.notify_one();
+			}
+		}
+
+		const std::size_t m_Size;
+		std::unique_ptr<Slot[]> m_pSlots;
+		std::vector<std::thread> m_Threads;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_Wake;
+		std::condition_variable m_Done;
+		std::size_t m_Generation = 0;
+		std::size_t m_Busy = 0;
+		bool m_Stop = false;
+
+		Trampoline m_pTrampoline = nullptr;
+		void *m_pContext = nullptr;
+		std::exception_ptr m_Error;
+		std::atomic<bool> m_Cancelled{ false };
+	};
+
+#pragma endregion
+
+#pragma region Chunks
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Split of count points into chunks of about SIZE points for OUTPUTS columns, every boundary except 0 and count is at the
+	//!			start of a cache line of each output on its own, so two workers never write the same line whatever the alignment of the
+	//!			columns; the boundaries of one chunk differ by less than a cache line between the outputs
+	//!
+	//====================================================================================================================================
+
+	template<std::size_t OUTPUTS>
+	class Chunks
+	{
+	public:
+		Chunks(std::size_t count, std::size_t size, const double *const *ppOutputs) noexcept :
+			m_Count(count),
+			m_Size(size)
+		{
+			for (std::size_t k = 0; k < OUTPUTS; ++k)
+			{
+				m_Shifts[k] = reinterpret_cast<std::uintptr_t>(ppOutputs[k]) / sizeof(double) % (CACHE_LINE / sizeof(double));
+				m_MaxShift = std::max(m_MaxShift, m_Shifts[k]);
+				m_MinShift = std::min(m_MinShift, m_Shifts[k]);
+			}
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Points of CHUNK_BYTES for the given number of input and output columns, a multiple of the cache line
+		//!
+		//====================================================================================================================================
+
+		static constexpr std::size_t SizeFor(std::size_t columns) noexcept
+		{
+			const std::size_t size = CHUNK_BYTES / sizeof(double) / (columns ? columns : 1);
+
+			return (size < CACHE_LINE ? CACHE_LINE : size - size % (CACHE_LINE / sizeof(double)));
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Points of a chunk over all outputs at most, the size and the largest misalignment between the outputs
+		//!
+		//====================================================================================================================================
+
+		static constexpr std::size_t SpanFor(std::size_t size) noexcept { return size + CACHE_LINE / sizeof(double); }
+
+		std::size_t count() const noexcept { return (m_Count ? (m_Count + m_MaxShift + m_Size - 1) / m_Size : 0); }
+
+		std::size_t first(std::size_t chunk, std::size_t output) const noexcept { return (chunk ? std::min(chunk * m_Size - m_Shifts[output], m_Count) : 0); }
+
+		std::size_t size(std::size_t chunk, std::size_t output) const noexcept { return first(chunk + 1, output) - first(chunk, output); }
+
+		// points of the chunk for any output, at most SpanFor(size) of them
+		std::size_t begin(std::size_t chunk) const noexcept { return (chunk ? std::min(chunk * m_Size - m_MaxShift, m_Count) : 0); }
+
+		std::size_t end(std::size_t chunk) const noexcept { return std::min((chunk + 1) * m_Size - m_MinShift, m_Count); }
+
+	private:
+		std::size_t m_Count;
+		std::size_t m_Size;
+		std::array<std::size_t, OUTPUTS> m_Shifts{};
+		std::size_t m_MaxShift = 0;
+		std::size_t m_MinShift = CACHE_LINE / sizeof(double);
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Columns of the caller, moved to the first point of the chunk
+	//!
+	//====================================================================================================================================
+
+	template<typename Columns>
+	struct Shifted
+	{
+		const Columns &rColumns;
+		std::size_t first;
+
+		template<typename Var>
+		auto operator()(Var var) const noexcept { return rColumns(var) + first; }
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Columns in the scratch of the worker, one per variable of the list
+	//!
+	//====================================================================================================================================
+
+	template<typename Vars>
+	struct ScratchColumns;
+
+	template<typename... Vars>
+	struct ScratchColumns<TypeList<Vars...>>
+	{
+		std::array<double*, sizeof...(Vars)> columns;
+
+		template<typename Var>
+		const double* operator()(Var) const noexcept { return columns[IndexOfValue<TypeList<Vars...>, Var>]; }
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Evaluates every expression of the list for the points of one chunk, the chunk is still in cache for the next one
+	//!
+	//====================================================================================================================================
+
+	template<typename Exprs>
+	struct Outputs;
+
+	template<typename... Exprs>
+	struct Outputs<TypeList<Exprs...>>
+	{
+		template<typename Columns, typename Policy>
+		static void calc(const Columns &rColumns, double *const *ppResults, std::size_t first, std::size_t count, Policy &rPolicy)
+		{
+			std::size_t k = 0;
+			(Batching::CalcBatch<Exprs>(rColumns, ppResults[k++] + first, count, rPolicy), ...);
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 The same for one chunk, each output over its own points; columnsAt(first) gives the columns moved to point first
+		//!
+		//====================================================================================================================================
+
+		template<typename ColumnsAt, typename Policy>
+		static void calc(ColumnsAt columnsAt, double *const *ppResults, const Chunks<sizeof...(Exprs)> &rChunks, std::size_t chunk, Policy &rPolicy)
+		{
+			std::size_t k = 0;
+			((Batching::CalcBatch<Exprs>(columnsAt(rChunks.first(chunk, k)), ppResults[k] + rChunks.first(chunk, k), rChunks.size(chunk, k), rPolicy), ++k), ...);
+		}
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Evaluates the expressions for count points of the columns, one output column per expression
+	//!
+	//! \throw   What the policy throws, the policy of every worker is checked after the loop
+	//!
+	//====================================================================================================================================
+
+	template<typename Exprs, typename Policy, typename Columns>
+	void CalcOutputs(ThreadPool &rPool, const Columns &rColumns, double *const *ppResults, std::size_t count)
+	{
+		using Split = Chunks<Exprs::size>;
+
+		const Split chunks(count, Split::SizeFor(VariablesOfAllResult<Exprs>::size + Exprs::size), ppResults);
+
+		std::vector<Padded<Policy>> policies(rPool.size());
+
+		rPool.parallelFor(chunks.count(), [&](std::size_t chunk, std::size_t worker)
+		{
+			Outputs<Exprs>::calc([&](std::size_t first) { return Shifted<Columns>{ rColumns, first }; }, ppResults, chunks, chunk, policies[worker].value);
+		});
+
+		for (const auto &rPolicy : policies)
+			rPolicy.value.check();
+	}
+
+#pragma endregion
+
+#pragma region Point sets
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Evaluates the expression for count points in parallel
+	//!
+	//! \param   rPool     Workers
+	//! \param   rColumns  Functor which returns pointer to the column of the variable, the same as for Batching::CalcBatch
+	//! \param   pResult   Output, at least count values
+	//! \param   count     Number of points
+	//!
+	//! \throw   std::overflow_error if any division by zero occurred with ErrorPolicy::Sticky, the result is calculated anyway
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Policy = ErrorPolicy::Sticky, typename Columns>
+	void CalcBatch(ThreadPool &rPool, const Columns &rColumns, double *pResult, std::size_t count)
+	{
+		CalcOutputs<TypeList<Expr>, Policy>(rPool, rColumns, &pResult, count);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Evaluates the gradient of the expression for count points in parallel
+	//!
+	//! \param   ppResults  Output columns in the order of Vars, at least count values each
+	//!
+	//! \note	 Policy comes before the variables as in CalcGridGradient, so it has no default: CalcGradient<Expr, ErrorPolicy::Sticky, X0, X1>
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Policy, typename... Vars, typename Columns>
+	void CalcGradient(ThreadPool &rPool, const Columns &rColumns, double *const *ppResults, std::size_t count)
+	{
+		CalcOutputs<typename Symbolic::Gradient<Expr, Vars...>::entries, Policy>(rPool, rColumns, ppResults, count);
+	}
+
+#pragma endregion
+
+#pragma region Grids
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Equally spaced values from lower to upper inclusive
+	//!
+	//====================================================================================================================================
+
+	struct Axis
+	{
+		double lower;
+		double upper;
+		std::size_t steps;
+
+		double at(std::size_t i) const noexcept { return (steps > 1 ? lower + (upper - lower) * static_cast<double>(i) / static_cast<double>(steps - 1) : lower); }
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Cartesian product of the axes of Vars, points are numbered in row-major order: the last variable changes fastest
+	//!
+	//====================================================================================================================================
+
+	template<typename... Vars>
+	class Grid
+	{
+	public:
+		using variables = TypeList<Vars...>;
+
+		static constexpr std::size_t DIMENSIONS = sizeof...(Vars);
+
+		//====================================================================================================================================
+		//!
+		//! \throw   std::invalid_argument if an axis has no steps
+		//!
+		//====================================================================================================================================
+
+		explicit Grid(const std::array<Axis, DIMENSIONS> &rAxes) :
+			m_Axes(rAxes)
+		{
+			for (const auto &rAxis : m_Axes)
+				if (!rAxis.steps)
+					throw std::invalid_argument("Axis without steps");
+		}
+
+		std::size_t size() const noexcept
+		{
+			std::size_t size = 1;
+			for (const auto &rAxis : m_Axes)
+				size *= rAxis.steps;
+
+			return size;
+		}
+
+		const Axis& axis(std::size_t dimension) const noexcept { return m_Axes[dimension]; }
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Writes the coordinates of count points starting from first, one column per variable
+		//!
+		//====================================================================================================================================
+
+		void fill(std::size_t first, std::size_t count, double *const *ppColumns) const noexcept
+		{
+			std::array<std::size_t, DIMENSIONS> index;
+			for (std::size_t d = DIMENSIONS; d-- > 0; first /= m_Axes[d].steps)
+				index[d] = first % m_Axes[d].steps;
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				for (std::size_t d = 0; d < DIMENSIONS; ++d)
+					ppColumns[d][i] = m_Axes[d].at(index[d]);
+
+				for (std::size_t d = DIMENSIONS; d-- > 0 && ++index[d] == m_Axes[d].steps;)
+					index[d] = 0;
+			}
+		}
+
+	private:
+		std::array<Axis, DIMENSIONS> m_Axes;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Evaluates the expressions at every point of the grid, the coordinates of a chunk are built in the scratch of the worker
+	//!
+	//====================================================================================================================================
+
+	template<typename Exprs, typename Policy, typename... Vars>
+	void CalcGridOutputs(ThreadPool &rPool, const Grid<Vars...> &rGrid, double *const *ppResults)
+	{
+		constexpr std::size_t DIMENSIONS = sizeof...(Vars);
+
+		using Split = Chunks<Exprs::size>;
+		using Columns = ScratchColumns<TypeList<Vars...>>;
+
+		const std::size_t count = rGrid.size();
+		const std::size_t span = Split::SpanFor(Split::SizeFor(DIMENSIONS + Exprs::size));
+		const Split chunks(count, Split::SizeFor(DIMENSIONS + Exprs::size), ppResults);
+
+		std::vector<Padded<Policy>> policies(rPool.size());
+
+		rPool.parallelFor(chunks.count(), [&](std::size_t chunk, std::size_t worker)
+		{
+			double *pScratch = rPool.scratch(worker, DIMENSIONS * span);
+
+			Columns columns;
+			for (std::size_t d = 0; d < DIMENSIONS; ++d)
+				columns.columns[d] = pScratch + d * span;
+
+			// the coordinates of the points of every output once, each output starts at its own point
+			const std::size_t begin = chunks.begin(chunk);
+
+			rGrid.fill(begin, chunks.end(chunk) - begin, columns.columns.data());
+			Outputs<Exprs>::calc([&](std::size_t first) { return Shifted<Columns>{ columns, first - begin }; }, ppResults, chunks, chunk, policies[worker].value);
+		});
+
+		for (const auto &rPolicy : policies)
+			rPolicy.value.check();
+	}
+
+	template<typename Expr, typename Policy = ErrorPolicy::Sticky, typename... Vars>
+	void CalcGrid(ThreadPool &rPool, const Grid<Vars...> &rGrid, double *pResult)
+	{
+		CalcGridOutputs<TypeList<Expr>, Policy>(rPool, rGrid, &pResult);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Evaluates the gradient by the variables of the grid at every point of the grid
+	//!
+	//! \param   ppResults  Output columns in the order of the variables of the grid, at least rGrid.size() values each
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Policy = ErrorPolicy::Sticky, typename... Vars>
+	void CalcGridGradient(ThreadPool &rPool, const Grid<Vars...> &rGrid, double *const *ppResults)
+	{
+		CalcGridOutputs<typename Symbolic::Gradient<Expr, Vars...>::entries, Policy>(rPool, rGrid, ppResults);
+	}
+
+#pragma endregion
+
+} // namespace Parallel
@@ -0,0 +1,266 @@
+#pragma once
+
+//====================================================================================================================================
+//!
+//!	\file   Profiling.hpp
+//!
+//! \brief	Per-node profile of Node::calc: calls, cycles, NaN, infinities and exceptions of every subtree in thread-local counters
+//!
+//====================================================================================================================================
+
+#include "Differentiation.hpp"
+
+#include <algorithm>   // std::sort
+#include <cmath>       // std::isnan, std::isinf, std::isfinite
+#include <cstdint>     // std::uint64_t
+#include <cstdio>      // std::snprintf
+#include <deque>       // std::deque
+#include <string>      // std::string
+#include <type_traits> // std::is_floating_point_v
+#include <utility>     // std::pair
+#include <vector>      // std::vector
+
+#if defined(_MSC_VER)
+#include <intrin.h>    // __rdtsc
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc
+#else
+#include <chrono>      // std::chrono::steady_clock
+#endif
+
+namespace Profiling
+{
+
+#pragma region Counters
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Time stamp counter, nanoseconds of steady_clock where there is none
+	//!
+	//====================================================================================================================================
+
+	inline std::uint64_t Ticks() noexcept
+	{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Counters of one subtree type
+	//!
+	//! \note	Cycles include the reading of the counter of the node and of its children, so they are overestimated for small
+	//!			subtrees, most for the ones whose children are cheap
+	//!
+	//====================================================================================================================================
+
+	struct Counter
+	{
+		std::uint64_t calls = 0;
+		std::uint64_t cycles = 0;     //!< Including the children
+		std::uint64_t selfCycles = 0; //!< Without the children
+		std::uint64_t nans = 0;       //!< From finite children
+		std::uint64_t infinities = 0; //!< From finite children
+		std::uint64_t exceptions = 0; //!< Thrown by the node itself, not passed on from a child
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Counters of the calling thread
+	//!
+	//! \note	Entries are never removed, the counter of every type is looked up once per thread and stays where it is
+	//!
+	//====================================================================================================================================
+
+	struct ThreadCounters
+	{
+		struct Entry
+		{
+			std::string (*pDump)();
+			Counter counter;
+		};
+
+		std::deque<Entry> entries;
+
+		//! Cycles of the children of the node being profiled
+		std::uint64_t childCycles = 0;
+
+		//! A child of the node being profiled returned NaN or infinity
+		bool nonFinite = false;
+
+		//! An exception is passing up, so it is counted once, where it was thrown
+		bool unwinding = false;
+	};
+
+	inline ThreadCounters &Counters() noexcept
+	{
+		thread_local ThreadCounters counters;
+
+		return counters;
+	}
+
+	template<typename T>
+	Counter &CounterOf()
+	{
+		thread_local Counter &rCounter = Counters().entries.emplace_back(ThreadCounters::Entry{ &T::dump, { } }).counter;
+
+		return rCounter;
+	}
+
+#pragma endregion
+
+#pragma region Policy
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Error policy which counts every function node Node::calc evaluates, division by zero is handled by Inner
+	//!
+	//! \note	Numbers and variables are not counted, their cost is the one of reading the counter. With ENABLED false
+	//!			Node::calc compiles to the same code as with Inner, so the policy can stay in the code of release builds:
+	//!
+	//!			using EvaluationPolicy = Profiling::Policy<ErrorPolicy::Ieee, PROFILE_BUILD>;
+	//!
+	//====================================================================================================================================
+
+	template<typename Inner = ErrorPolicy::Throwing, bool ENABLED = true>
+	struct Policy : Inner
+	{
+		static constexpr bool PROFILED = ENABLED;
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Calculates the node T by calc and counts it
+		//!
+		//! \param   calc  Calculates the node and its children
+		//!
+		//! \return  Result of calc
+		//!
+		//! \throw   Whatever calc throws
+		//!
+		//====================================================================================================================================
+
+		template<typename T, typename Calc>
+		static auto profile(Calc &&calc) -> decltype(calc())
+		{
+			ThreadCounters &rCounters = Counters();
+			Counter &rCounter = CounterOf<T>();
+
+			const std::uint64_t siblingCycles = rCounters.childCycles;
+			const bool siblingNonFinite = rCounters.nonFinite;
+			rCounters.childCycles = 0;
+			rCounters.nonFinite = false;
+			rCounters.unwinding = false;
+
+			const std::uint64_t start = Ticks();
+			try
+			{
+				const auto result = calc();
+
+				Count(rCounters, rCounter, siblingCycles, Ticks() - start);
+				if constexpr (std::is_floating_point_v<std::decay_t<decltype(result)>>)
+				{
+					// counted where they appear, not in every node they pass through
+					if (!rCounters.nonFinite)
+					{
+						rCounter.nans += std::isnan(result);
+						rCounter.infinities += std::isinf(result);
+					}
+
+					rCounters.nonFinite = siblingNonFinite || !std::isfinite(result);
+				}
+
+				return result;
+			}
+			catch (...)
+			{
+				Count(rCounters, rCounter, siblingCycles, Ticks() - start);
+				rCounter.exceptions += !rCounters.unwinding;
+				rCounters.unwinding = true;
+				throw;
+			}
+		}
+
+	private:
+		static void Count(ThreadCounters &rCounters, Counter &rCounter, std::uint64_t siblingCycles, std::uint64_t cycles) noexcept
+		{
+			++rCounter.calls;
+			rCounter.cycles += cycles;
+			rCounter.selfCycles += cycles - rCounters.childCycles;
+			rCounters.childCycles = siblingCycles + cycles;
+		}
+	};
+
+#pragma endregion
+
+#pragma region Report
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Counters of the calling thread with the dump() of their subtrees, most cycles first
+	//!
+	//! \throw   std::bad_alloc
+	//!
+	//====================================================================================================================================
+
+	inline std::vector<std::pair<std::string, Counter>> Snapshot()
+	{
+		std::vector<std::pair<std::string, Counter>> result;
+		for (const auto &rEntry : Counters().entries)
+		{
+			if (rEntry.counter.calls)
+				result.emplace_back(rEntry.pDump(), rEntry.counter);
+		}
+
+		std::sort(result.begin(), result.end(), [](const auto &rLeft, const auto &rRight) { return rLeft.second.cycles > rRight.second.cycles; });
+
+		return result;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Zeroes the counters of the calling thread
+	//!
+	//====================================================================================================================================
+
+	inline void Clear() noexcept
+	{
+		for (auto &rEntry : Counters().entries)
+			rEntry.counter = Counter{ };
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Table of the counters of the calling thread, one line per subtree, at most maxLines subtrees with most cycles
+	//!
+	//! \throw   std::bad_alloc
+	//!
+	//====================================================================================================================================
+
+	inline std::string Dump(std::size_t maxLines = static_cast<std::size_t>(-1))
+	{
+		const auto snapshot = Snapshot();
+
+		std::string result = "       calls       cycles  self cycles   cycles/call   NaN   inf  exceptions  node\n";
+		for (std::size_t i = 0; i < snapshot.size() && i < maxLines; ++i)
+		{
+			const Counter &rCounter = snapshot[i].second;
+
+			char line[128];
+			std::snprintf(line, sizeof(line), "%12llu %12llu %12llu %13.1f %5llu %5llu %11llu  ",
+				static_cast<unsigned long long>(rCounter.calls), static_cast<unsigned long long>(rCounter.cycles),
+				static_cast<unsigned long long>(rCounter.selfCycles), static_cast<double>(rCounter.cycles) / static_cast<double>(rCounter.calls),
+				static_cast<unsigned long long>(rCounter.nans), static_cast<unsigned long long>(rCounter.infinities),
+				static_cast<unsigned long long>(rCounter.exceptions));
+
+			result.append(line).append(snapshot[i].first).append("\n");
+		}
+
+		return result;
+	}
+
+#pragma endregion
+
+} // namespace Profiling
@@ -0,0 +1,567 @@
+#pragma once
+
+//====================================================================================================================================
+//!
+//!	\file   Program.hpp
+//!
+//! \brief	Lowering of Node expressions into a flat constexpr program of register instructions and its interpreter
+//!
+//====================================================================================================================================
+
+#include "Batch.hpp"
+#include "Dag.hpp"
+#include "Variables.hpp"
+
+#include <algorithm> // std::copy
+#include <array>     // std::array
+#include <cstddef>   // std::size_t
+#include <cstdint>   // std::uint8_t, std::uint32_t
+#include <stdexcept> // std::overflow_error, std::invalid_argument
+#include <utility>   // std::index_sequence
+
+namespace Lowering
+{
+
+#pragma region Instructions
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Operation of the instruction, one code per function so the interpreter dispatches once
+	//!
+	//====================================================================================================================================
+
+	enum class OpCode : std::uint8_t
+	{
+		NUMBER,
+		VARIABLE,
+		SIN,
+		COS,
+		LG,
+		LN,
+		NEG,
+		ADD,
+		SUB,
+		MUL,
+		DIV,
+		POW
+	};
+
+	constexpr OpCode GetOpCode(UnaryFunction uf) noexcept
+	{
+		return static_cast<OpCode>(static_cast<int>(OpCode::SIN) + static_cast<int>(uf));
+	}
+
+	constexpr OpCode GetOpCode(BinaryFunction bf) noexcept
+	{
+		return static_cast<OpCode>(static_cast<int>(OpCode::ADD) + static_cast<int>(bf));
+	}
+
+	constexpr UnaryFunction GetUnaryFunction(OpCode code) noexcept
+	{
+		return static_cast<UnaryFunction>(static_cast<int>(code) - static_cast<int>(OpCode::SIN));
+	}
+
+	constexpr BinaryFunction GetBinaryFunction(OpCode code) noexcept
+	{
+		return static_cast<BinaryFunction>(static_cast<int>(code) - static_cast<int>(OpCode::ADD));
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	One instruction: target = code(left, right)
+	//!
+	//! \note	For VARIABLE left is the position of the variable in VariablesOfResult<Expr>, for NUMBER the value is constant
+	//!
+	//====================================================================================================================================
+
+	struct Instruction
+	{
+		OpCode code;
+		std::uint32_t target;
+		std::uint32_t left;
+		std::uint32_t right;
+		llong_t constant;
+	};
+
+	constexpr bool HasLeft(OpCode code) noexcept { return (code != OpCode::NUMBER && code != OpCode::VARIABLE); }
+	constexpr bool HasRight(OpCode code) noexcept { return (code >= OpCode::ADD); }
+
+#pragma endregion
+
+#pragma region Lowering of nodes
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Instruction of one unique node, slots are positions in Nodes (one slot per node, before allocation)
+	//!
+	//====================================================================================================================================
+
+	template<typename Nodes, typename Vars, typename T>
+	struct Lower;
+
+	template<typename Nodes, typename Vars, llong_t N>
+	struct Lower<Nodes, Vars, Node<Number<N>>>
+	{
+		static constexpr Instruction value = { OpCode::NUMBER, IndexOfValue<Nodes, Node<Number<N>>>, 0, 0, N };
+	};
+
+	template<typename Nodes, typename Vars, char NAME, int INDEX>
+	struct Lower<Nodes, Vars, Node<Variable<NAME, INDEX>>>
+	{
+		static constexpr Instruction value =
+			{ OpCode::VARIABLE, IndexOfValue<Nodes, Node<Variable<NAME, INDEX>>>, IndexOfValue<Vars, Node<Variable<NAME, INDEX>>>, 0, 0 };
+	};
+
+	template<typename Nodes, typename Vars, UnaryFunction UF, typename Child>
+	struct Lower<Nodes, Vars, Node<Wrap4UF<UF>, Child>>
+	{
+		static constexpr Instruction value =
+			{ GetOpCode(UF), IndexOfValue<Nodes, Node<Wrap4UF<UF>, Child>>, IndexOfValue<Nodes, Child>, 0, 0 };
+	};
+
+	template<typename Nodes, typename Vars, BinaryFunction BF, typename Left, typename Right>
+	struct Lower<Nodes, Vars, Node<Wrap4BF<BF>, Left, Right>>
+	{
+		static constexpr Instruction value =
+			{ GetOpCode(BF), IndexOfValue<Nodes, Node<Wrap4BF<BF>, Left, Right>>, IndexOfValue<Nodes, Left>, IndexOfValue<Nodes, Right>, 0 };
+	};
+
+#pragma endregion
+
+#pragma region Register allocation
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Maps the slots of the program to registers, a register is reused once its last reader has run
+	//!
+	//! \param   pCode       Program with one slot per instruction, slot i is the target of instruction i, renumbered in place
+	//! \param   size        Number of instructions
+	//! \param   pLastUse    Scratch, size elements
+	//! \param   pRegisters  Scratch, size elements
+	//! \param   pReleased   Scratch, size elements
+	//!
+	//====================================================================================================================================
+
+	constexpr void AllocateRegisters(Instruction *pCode, std::size_t size, std::size_t *pLastUse, std::uint32_t *pRegisters, std::uint32_t *pReleased)
+	{
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			pLastUse[i] = i;
+			if (HasLeft(pCode[i].code))
+				pLastUse[pCode[i].left] = i;
+			if (HasRight(pCode[i].code))
+				pLastUse[pCode[i].right] = i;
+		}
+
+		std::size_t releasedCount = 0;
+		std::uint32_t used = 0;
+
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			Instruction &rInstruction = pCode[i];
+
+			// operands are read before the target is written, so the target may take the register of a dying operand
+			const std::uint32_t leftSlot  = rInstruction.left;
+			const std::uint32_t rightSlot = rInstruction.right;
+
+			if (HasLeft(rInstruction.code))
+			{
+				rInstruction.left = pRegisters[leftSlot];
+				if (pLastUse[leftSlot] == i)
+					pReleased[releasedCount++] = pRegisters[leftSlot];
+			}
+
+			if (HasRight(rInstruction.code))
+			{
+				rInstruction.right = pRegisters[rightSlot];
+				if (pLastUse[rightSlot] == i && rightSlot != leftSlot)
+					pReleased[releasedCount++] = pRegisters[rightSlot];
+			}
+
+			pRegisters[i] = rInstruction.target = (releasedCount ? pReleased[--releasedCount] : used++);
+		}
+	}
+
+	template<std::size_t SIZE>
+	constexpr std::array<Instruction, SIZE> Allocate(std::array<Instruction, SIZE> code)
+	{
+		std::array<std::size_t, SIZE> lastUse{ };
+		std::array<std::uint32_t, SIZE> registers{ };
+		std::array<std::uint32_t, SIZE> released{ };
+
+		AllocateRegisters(code.data(), SIZE, lastUse.data(), registers.data(), released.data());
+
+		return code;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Number of registers used by the program
+	//!
+	//====================================================================================================================================
+
+	constexpr std::size_t CountRegisters(const Instruction *pCode, std::size_t size) noexcept
+	{
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < size; ++i)
+			count = (pCode[i].target + 1 > count ? pCode[i].target + 1 : count);
+
+		return count;
+	}
+
+#pragma endregion
+
+#pragma region Interpreter
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Runs the program for one point
+	//!
+	//! \param   pCode       Instructions
+	//! \param   size        Number of instructions, not 0
+	//! \param   pVariables  Values of the variables in the order of VariablesOfResult<Expr>
+	//! \param   pRegisters  Scratch, at least CountRegisters(code) values
+	//! \param   rPolicy     What to do on division by zero, see ErrorPolicy
+	//!
+	//! \return  Value of the last instruction
+	//!
+	//! \throw   std::invalid_argument, std::overflow_error by ErrorPolicy::Throwing
+	//!
+	//====================================================================================================================================
+
+	template<typename T, typename Policy>
+	T Run(const Instruction *pCode, std::size_t size, const T *pVariables, T *pRegisters, Policy &rPolicy)
+	{
+		for (const Instruction *pInstruction = pCode; pInstruction != pCode + size; ++pInstruction)
+		{
+			const T left  = (HasLeft(pInstruction->code) ? pRegisters[pInstruction->left] : T());
+			const T right = (HasRight(pInstruction->code) ? pRegisters[pInstruction->right] : T());
+			T &rTarget = pRegisters[pInstruction->target];
+
+			switch (pInstruction->code)
+			{
+			case OpCode::NUMBER:   rTarget = static_cast<T>(pInstruction->constant); break;
+			case OpCode::VARIABLE: rTarget = pVariables[pInstruction->left]; break;
+			case OpCode::SIN:      rTarget = UnaryOperation<UnaryFunction::SIN>::calc(left); break;
+			case OpCode::COS:      rTarget = UnaryOperation<UnaryFunction::COS>::calc(left); break;
+			case OpCode::LG:       rTarget = UnaryOperation<UnaryFunction::LG>::calc(left); break;
+			case OpCode::LN:       rTarget = UnaryOperation<UnaryFunction::LN>::calc(left); break;
+			case OpCode::NEG:      rTarget = UnaryOperation<UnaryFunction::NEG>::calc(left); break;
+			case OpCode::ADD:      rTarget = BinaryOperation<BinaryFunction::ADD>::calc(left, right, rPolicy); break;
+			case OpCode::SUB:      rTarget = BinaryOperation<BinaryFunction::SUB>::calc(left, right, rPolicy); break;
+			case OpCode::MUL:      rTarget = BinaryOperation<BinaryFunction::MUL>::calc(left, right, rPolicy); break;
+			case OpCode::DIV:      rTarget = BinaryOperation<BinaryFunction::DIV>::calc(left, right, rPolicy); break;
+			case OpCode::POW:      rTarget = BinaryOperation<BinaryFunction::POW>::calc(left, right, rPolicy); break;
+			default:
+				throw std::invalid_argument("Undefined instruction\n");
+			}
+		}
+
+		return pRegisters[pCode[size - 1].target];
+	}
+
+	template<typename T>
+	T Run(const Instruction *pCode, std::size_t size, const T *pVariables, T *pRegisters)
+	{
+		ErrorPolicy::Throwing policy;
+
+		return Run(pCode, size, pVariables, pRegisters, policy);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Applies the kernel of Batching to count values, count is a multiple of Pack::WIDTH
+	//!
+	//====================================================================================================================================
+
+	template<typename Pack, UnaryFunction UF, typename T>
+	void ApplyUnary(const T *pArg, T *pTarget, std::size_t count)
+	{
+		for (std::size_t i = 0; i < count; i += Pack::WIDTH)
+			Pack::store(pTarget + i, Batching::UnaryKernel<UF>::template apply<Pack>(Pack::load(pArg + i)));
+	}
+
+	template<typename Pack, BinaryFunction BF, typename T, typename Policy>
+	void ApplyBinary(const T *pLeft, const T *pRight, T *pTarget, std::size_t count, Policy &rPolicy)
+	{
+		for (std::size_t i = 0; i < count; i += Pack::WIDTH)
+			Pack::store(pTarget + i, Batching::BinaryKernel<BF>::template apply<Pack>(Pack::load(pLeft + i), Pack::load(pRight + i), rPolicy));
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Runs the program for a block of points, every instruction is applied to the whole block before the next one
+	//!
+	//! \param   pCode       Instructions
+	//! \param   size        Number of instructions, not 0
+	//! \param   ppColumns   Columns of the variables in the order of VariablesOfResult<Expr>, already offset to the first point
+	//! \param   count       Number of points in the block, a multiple of Pack::WIDTH and at most stride
+	//! \param   stride      Distance between registers in pRegisters
+	//! \param   pRegisters  Scratch, at least CountRegisters(code) * stride values
+	//! \param   rPolicy     What to do on division by zero, see ErrorPolicy
+	//!
+	//! \return  Pointer to the values of the last instruction in pRegisters
+	//!
+	//! \throw   std::invalid_argument, std::overflow_error by ErrorPolicy::Throwing
+	//!
+	//====================================================================================================================================
+
+	template<typename Pack, typename T, typename Policy>
+	const T* RunBlock(const Instruction *pCode, std::size_t size, const T *const *ppColumns, std::size_t count, std::size_t stride, T *pRegisters,
+		Policy &rPolicy)
+	{
+		for (const Instruction *pInstruction = pCode; pInstruction != pCode + size; ++pInstruction)
+		{
+			const T *pLeft  = (HasLeft(pInstruction->code) ? pRegisters + pInstruction->left * stride : nullptr);
+			const T *pRight = (HasRight(pInstruction->code) ? pRegisters + pInstruction->right * stride : nullptr);
+			T *pTarget = pRegisters + pInstruction->target * stride;
+
+			switch (pInstruction->code)
+			{
+			case OpCode::NUMBER:
+			{
+				const auto constant = Pack::broadcast(static_cast<T>(pInstruction->constant));
+				for (std::size_t i = 0; i < count; i += Pack::WIDTH)
+					Pack::store(pTarget + i, constant);
+				break;
+			}
+			case OpCode::VARIABLE:
+				for (std::size_t i = 0; i < count; i += Pack::WIDTH)
+					Pack::store(pTarget + i, Pack::load(ppColumns[pInstruction->left] + i));
+				break;
+			case OpCode::SIN: ApplyUnary<Pack, UnaryFunction::SIN>(pLeft, pTarget, count); break;
+			case OpCode::COS: ApplyUnary<Pack, UnaryFunction::COS>(pLeft, pTarget, count); break;
+			case OpCode::LG:  ApplyUnary<Pack, UnaryFunction::LG>(pLeft, pTarget, count); break;
+			case OpCode::LN:  ApplyUnary<Pack, UnaryFunction::LN>(pLeft, pTarget, count); break;
+			case OpCode::NEG: ApplyUnary<Pack, UnaryFunction::NEG>(pLeft, pTarget, count); break;
+			case OpCode::ADD: ApplyBinary<Pack, BinaryFunction::ADD>(pLeft, pRight, pTarget, count, rPolicy); break;
+			case OpCode::SUB: ApplyBinary<Pack, BinaryFunction::SUB>(pLeft, pRight, pTarget, count, rPolicy); break;
+			case OpCode::MUL: ApplyBinary<Pack, BinaryFunction::MUL>(pLeft, pRight, pTarget, count, rPolicy); break;
+			case OpCode::DIV: ApplyBinary<Pack, BinaryFunction::DIV>(pLeft, pRight, pTarget, count, rPolicy); break;
+			case OpCode::POW: ApplyBinary<Pack, BinaryFunction::POW>(pLeft, pRight, pTarget, count, rPolicy); break;
+			default:
+				throw std::invalid_argument("Undefined instruction\n");
+			}
+		}
+
+		return pRegisters + pCode[size - 1].target * stride;
+	}
+
+#pragma endregion
+
+#pragma region Program of expression
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Values or columns of the variables in the order of the list
+	//!
+	//====================================================================================================================================
+
+	template<typename Vars>
+	struct Gather;
+
+	template<typename... Vars>
+	struct Gather<TypeList<Vars...>>
+	{
+		template<typename Vector>
+		static std::array<typename Vector::value_type, sizeof...(Vars)> values(const Vector &rValues)
+		{
+			return { { rValues(Vars{ })... } };
+		}
+
+		template<typename T, typename Columns>
+		static std::array<const T*, sizeof...(Vars)> columns(const Columns &rColumns, std::size_t first)
+		{
+			return { { (rColumns(Vars{ }) + first)... } };
+		}
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Expression Expr lowered to instructions: unique subtrees in post-order, registers reused after the last reader
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Nodes = Sharing::UniqueNodesResult<Expr>, typename Vars = VariablesOfResult<Expr>>
+	struct Program;
+
+	template<typename Expr, typename... Nodes, typename Vars>
+	struct Program<Expr, TypeList<Nodes...>, Vars>
+	{
+		using nodes = TypeList<Nodes...>;
+		using variables = Vars;
+
+		//====================================================================================================================================
+		//!
+		//! \brief	Number of instructions, i.e. unique subtrees of Expr
+		//!
+		//====================================================================================================================================
+
+		static constexpr std::size_t SIZE = sizeof...(Nodes);
+
+		static constexpr std::array<Instruction, SIZE> CODE = Allocate(std::array<Instruction, SIZE>{ { Lower<nodes, Vars, Nodes>::value... } });
+
+		static constexpr std::size_t REGISTERS = CountRegisters(CODE.data(), SIZE);
+
+		//====================================================================================================================================
+		//!
+		//! \brief	Points of one block of CalcBatch, the registers of the block stay in L1
+		//!
+		//====================================================================================================================================
+
+		static constexpr std::size_t BLOCK = 64;
+
+		//====================================================================================================================================
+		//!
+		//! \brief	Executes instruction I, its code is a constant so the dispatch is resolved at compile time
+		//!
+		//====================================================================================================================================
+
+		template<std::size_t I, typename T, typename Policy>
+		static void Execute(const T *pVariables, T *pRegisters, Policy &rPolicy)
+		{
+			constexpr Instruction INSTRUCTION = CODE[I];
+
+			T &rTarget = pRegisters[INSTRUCTION.target];
+
+			if constexpr (INSTRUCTION.code == OpCode::NUMBER)
+				rTarget = static_cast<T>(INSTRUCTION.constant);
+			else if constexpr (INSTRUCTION.code == OpCode::VARIABLE)
+				rTarget = pVariables[INSTRUCTION.left];
+			else if constexpr (HasRight(INSTRUCTION.code))
+				rTarget = BinaryOperation<GetBinaryFunction(INSTRUCTION.code)>::calc(pRegisters[INSTRUCTION.left], pRegisters[INSTRUCTION.right], rPolicy);
+			else
+				rTarget = UnaryOperation<GetUnaryFunction(INSTRUCTION.code)>::calc(pRegisters[INSTRUCTION.left]);
+		}
+
+		template<typename T, typename Policy, std::size_t... Is>
+		static T Execute(const T *pVariables, T *pRegisters, Policy &rPolicy, std::index_sequence<Is...>)
+		{
+			(Execute<Is>(pVariables, pRegisters, rPolicy), ...);
+
+			return pRegisters[CODE.back().target];
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Calculates the expression by the program unrolled at compile time, Run interprets the same CODE
+		//!
+		//! \param   rValues  The same functor as for Node::calc
+		//! \param   rPolicy  What to do on division by zero, see ErrorPolicy
+		//!
+		//! \return  The same value as Expr::calc
+		//!
+		//! \throw   std::overflow_error by ErrorPolicy::Throwing, the default
+		//!
+		//====================================================================================================================================
+
+		template<typename Vector, typename Policy>
+		static typename Vector::value_type calc(const Vector &rValues, Policy &rPolicy)
+		{
+			using value_type = typename Vector::value_type;
+
+			const auto variables = Gather<Vars>::values(rValues);
+			std::array<value_type, REGISTERS> registers;
+
+			return Execute(variables.data(), registers.data(), rPolicy, std::make_index_sequence<SIZE>{ });
+		}
+
+		template<typename Vector>
+		static typename Vector::value_type calc(const Vector &rValues)
+		{
+			ErrorPolicy::Throwing policy;
+
+			return calc(rValues, policy);
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Calculates the expression by the interpreter
+		//!
+		//! \return  The same value as Expr::calc
+		//!
+		//! \throw   std::invalid_argument, std::overflow_error by ErrorPolicy::Throwing, the default
+		//!
+		//====================================================================================================================================
+
+		template<typename Vector, typename Policy>
+		static typename Vector::value_type interpret(const Vector &rValues, Policy &rPolicy)
+		{
+			using value_type = typename Vector::value_type;
+
+			const auto variables = Gather<Vars>::values(rValues);
+			std::array<value_type, REGISTERS> registers;
+
+			return Run(CODE.data(), SIZE, variables.data(), registers.data(), rPolicy);
+		}
+
+		template<typename Vector>
+		static typename Vector::value_type interpret(const Vector &rValues)
+		{
+			ErrorPolicy::Throwing policy;
+
+			return interpret(rValues, policy);
+		}
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Calculates the expression for count points by the interpreter, BLOCK points per instruction
+	//!
+	//! \param   rColumns  Functor which returns pointer to the column of the variable: rColumns(Node<Variable<..>>{ })
+	//! \param   pResult   Output, at least count values
+	//! \param   count     Number of points
+	//! \param   rPolicy   What to do on division by zero, see ErrorPolicy; its check() is left to the caller
+	//!
+	//! \throw   std::overflow_error by ErrorPolicy::Throwing
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Value, typename Columns, typename Policy>
+	void CalcBatch(const Columns &rColumns, Value *pResult, std::size_t count, Policy &rPolicy)
+	{
+		using Code = Program<Expr>;
+
+		std::array<Value, Code::REGISTERS * Code::BLOCK> registers;
+
+		std::size_t first = 0;
+
+		if constexpr (std::is_same_v<Value, double>)
+			for (; first + Code::BLOCK <= count; first += Code::BLOCK)
+			{
+				const auto columns = Gather<typename Code::variables>::template columns<Value>(rColumns, first);
+				const Value *pBlock = RunBlock<Batching::Simd>(Code::CODE.data(), Code::SIZE, columns.data(), Code::BLOCK, Code::BLOCK, registers.data(), rPolicy);
+
+				std::copy(pBlock, pBlock + Code::BLOCK, pResult + first);
+			}
+
+		for (; first < count; first += Code::BLOCK)
+		{
+			const std::size_t size = (count - first < Code::BLOCK ? count - first : Code::BLOCK);
+			const auto columns = Gather<typename Code::variables>::template columns<Value>(rColumns, first);
+			const Value *pBlock = RunBlock<Batching::ScalarPack<Value>>(Code::CODE.data(), Code::SIZE, columns.data(), size, Code::BLOCK, registers.data(), rPolicy);
+
+			std::copy(pBlock, pBlock + size, pResult + first);
+		}
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 The same with a fresh policy which is checked once after the whole batch
+	//!
+	//! \throw   std::overflow_error if any division by zero occurred with ErrorPolicy::Sticky, the result is calculated for every point anyway
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Policy = ErrorPolicy::Sticky, typename Value, typename Columns>
+	void CalcBatch(const Columns &rColumns, Value *pResult, std::size_t count)
+	{
+		Policy policy;
+
+		CalcBatch<Expr>(rColumns, pResult, count, policy);
+		policy.check();
+	}
+
+#pragma endregion
+
+} // namespace Lowering
@@ -0,0 +1,1275 @@
+#pragma once
+
+//====================================================================================================================================
+//!
+//!	\file   Runtime.hpp
+//!
+//! \brief	Expressions known only at runtime: arena-allocated, hash-consed nodes with the same derivatives and simplifications
+//!
+//====================================================================================================================================
+
+#include "Program.hpp"
+#include "Simplify.hpp"
+
+#include <algorithm>   // std::sort, std::lower_bound, std::copy
+#include <cctype>      // std::isalpha, std::isdigit, std::isspace
+#include <charconv>    // std::to_chars
+#include <cstddef>     // std::size_t, std::max_align_t
+#include <cstdint>     // std::uint8_t, std::uint32_t
+#include <limits>      // std::numeric_limits
+#include <memory>      // std::unique_ptr
+#include <new>         // placement new
+#include <stdexcept>   // std::invalid_argument
+#include <string>      // std::string, std::to_string
+#include <string_view> // std::string_view
+#include <type_traits> // std::is_trivially_destructible_v
+#include <utility>     // std::pair
+#include <vector>      // std::vector
+
+namespace Runtime
+{
+
+#pragma region Arena
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Bump allocator: memory is taken from large chunks and released all at once with the arena
+	//!
+	//====================================================================================================================================
+
+	class Arena
+	{
+	public:
+		explicit Arena(std::size_t chunkSize = 64 * 1024) :
+			m_NextChunkSize(chunkSize)
+		{
+		}
+
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Allocates uninitialized memory, a new chunk (twice as large as the previous one) is taken only when the current is full
+		//!
+		//! \throw   std::bad_alloc
+		//!
+		//====================================================================================================================================
+
+		void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t))
+		{
+			std::size_t offset = (m_Used + alignment - 1) & ~(alignment - 1);
+
+			if (m_Chunks.empty() || offset + size > m_ChunkSize)
+			{
+				m_ChunkSize = (size + alignment > m_NextChunkSize ? size + alignment : m_NextChunkSize);
+				m_NextChunkSize *= 2;
+
+				m_Chunks.emplace_back(new unsigned char[m_ChunkSize]);
+				m_Used = 0;
+
+				offset = (reinterpret_cast<std::size_t>(m_Chunks.back().get()) % alignment ? alignment - reinterpret_cast<std::size_t>(m_Chunks.back().get()) % alignment : 0);
+			}
+
+			m_Used = offset + size;
+			m_Bytes += size;
+
+			return (m_Chunks.back().get() + offset);
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	Constructs object of trivially destructible type T in the arena
+		//!
+		//====================================================================================================================================
+
+		template<typename T, typename... Args>
+		T* create(Args&&... args)
+		{
+			static_assert(std::is_trivially_destructible_v<T>, "Arena never calls destructors");
+
+			return new (allocate(sizeof(T), alignof(T))) T{ std::forward<Args>(args)... };
+		}
+
+		std::size_t chunks() const noexcept { return m_Chunks.size(); }
+		std::size_t bytes() const noexcept { return m_Bytes; }
+
+	private:
+		std::vector<std::unique_ptr<unsigned char[]>> m_Chunks;
+		std::size_t m_ChunkSize     = 0;
+		std::size_t m_NextChunkSize = 0;
+		std::size_t m_Used          = 0;
+		std::size_t m_Bytes         = 0;
+	};
+
+#pragma endregion
+
+#pragma region Expression
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Kind of the node, the runtime counterparts of Number, Variable, Wrap4UF and Wrap4BF
+	//!
+	//====================================================================================================================================
+
+	enum class Kind : std::uint8_t
+	{
+		NUMBER,
+		VARIABLE,
+		UNARY,
+		BINARY
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Node of the expression, nodes are unique within their Context, so equal subexpressions are equal pointers
+	//!
+	//====================================================================================================================================
+
+	struct Expression
+	{
+		Kind kind;
+		UnaryFunction uf;
+		BinaryFunction bf;
+		char name;
+		int index;
+		llong_t number;
+		const Expression *pLeft;  // child of unary function
+		const Expression *pRight;
+		std::uint32_t id;         // position of the node in creation order, children always have smaller ids
+		std::size_t hash;
+		std::size_t cycles;       // of Node::calc of the subtree by CostModel::Cycles, equal subtrees counted every time, saturating
+	};
+
+	inline bool IsNumber(const Expression *pExpression, llong_t number) noexcept
+	{
+		return (pExpression->kind == Kind::NUMBER && pExpression->number == number);
+	}
+
+#pragma endregion
+
+#pragma region Checked integer arithmetic
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Folds the binary function of two numbers the same way as the rules of Simplification
+	//!
+	//! \return  false if the rule does not apply: inexact division, negative exponent or overflow
+	//!
+	//====================================================================================================================================
+
+	inline bool Fold(BinaryFunction bf, llong_t left, llong_t right, llong_t &rResult) noexcept
+	{
+		const Simplification::Folding folding = Simplification::Fold(bf, left, right);
+		if (folding.folds)
+			rResult = folding.value;
+
+		return folding.folds;
+	}
+
+#pragma endregion
+
+#pragma region Program
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Expression lowered to the instructions of Lowering, variables are sorted by name, then by index
+	//!
+	//====================================================================================================================================
+
+	struct Program
+	{
+		std::vector<Lowering::Instruction> code;
+		std::vector<std::pair<char, int>> variables;
+		std::size_t registers = 0;
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Calculates the expression for one point
+		//!
+		//! \param   pVariables  Values in the order of variables
+		//! \param   pRegisters  Scratch, at least registers values
+		//! \param   rPolicy     What to do on division by zero, see ErrorPolicy
+		//!
+		//! \throw   std::invalid_argument, std::overflow_error by ErrorPolicy::Throwing, the default
+		//!
+		//====================================================================================================================================
+
+		template<typename T, typename Policy>
+		T calc(const T *pVariables, T *pRegisters, Policy &rPolicy) const
+		{
+			return Lowering::Run(code.data(), code.size(), pVariables, pRegisters, rPolicy);
+		}
+
+		template<typename T>
+		T calc(const T *pVariables, T *pRegisters) const
+		{
+			ErrorPolicy::Throwing policy;
+
+			return calc(pVariables, pRegisters, policy);
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Calculates the expression for count points
+		//!
+		//! \param   ppColumns  Columns in the order of variables
+		//! \param   pResult    Output, at least count values
+		//! \param   count      Number of points
+		//! \param   rPolicy    What to do on division by zero, see ErrorPolicy; its check() is left to the caller
+		//!
+		//! \throw   std::invalid_argument, std::bad_alloc, std::overflow_error by ErrorPolicy::Throwing
+		//!
+		//====================================================================================================================================
+
+		template<typename T, typename Policy>
+		void calcBatch(const T *const *ppColumns, T *pResult, std::size_t count, Policy &rPolicy) const
+		{
+			constexpr std::size_t BLOCK = 64;
+
+			std::vector<T> scratch(registers * BLOCK);
+			std::vector<const T*> columns(variables.size());
+
+			for (std::size_t first = 0; first < count; first += BLOCK)
+			{
+				const std::size_t size = (count - first < BLOCK ? count - first : BLOCK);
+				for (std::size_t i = 0; i < columns.size(); ++i)
+					columns[i] = ppColumns[i] + first;
+
+				const T *pBlock = nullptr;
+				if constexpr (std::is_same_v<T, double>)
+					if (size == BLOCK)
+						pBlock = Lowering::RunBlock<Batching::Simd>(code.data(), code.size(), columns.data(), size, BLOCK, scratch.data(), rPolicy);
+
+				if (!pBlock)
+					pBlock = Lowering::RunBlock<Batching::ScalarPack<T>>(code.data(), code.size(), columns.data(), size, BLOCK, scratch.data(), rPolicy);
+
+				std::copy(pBlock, pBlock + size, pResult + first);
+			}
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 The same with ErrorPolicy::Sticky which is checked once after the whole batch
+		//!
+		//! \throw   std::overflow_error if any division by zero occurred, the result is calculated for every point anyway
+		//!
+		//====================================================================================================================================
+
+		template<typename T>
+		void calcBatch(const T *const *ppColumns, T *pResult, std::size_t count) const
+		{
+			ErrorPolicy::Sticky policy;
+
+			calcBatch(ppColumns, pResult, count, policy);
+			policy.check();
+		}
+	};
+
+#pragma endregion
+
+#pragma region Context
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Owner of the nodes: creates them in the arena and returns the existing node for an equal one
+	//!
+	//! \note	Nodes live as long as the context, traversals use explicit stacks, so deep expressions do not overflow the call stack
+	//!
+	//====================================================================================================================================
+
+	class Context
+	{
+	public:
+		Context() :
+			m_Table(1024, nullptr)
+		{
+		}
+
+		Context(const Context&) = delete;
+		Context& operator=(const Context&) = delete;
+
+		std::size_t size() const noexcept { return m_Size; }
+		const Arena& arena() const noexcept { return m_Arena; }
+
+#pragma region Construction
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Unique nodes, the same arguments return the same pointer
+		//!
+		//! \throw   std::bad_alloc
+		//!
+		//====================================================================================================================================
+
+		const Expression* number(llong_t number)
+		{
+			return intern({ Kind::NUMBER, UnaryFunction::SIN, BinaryFunction::ADD, 0, 0, number, nullptr, nullptr, 0, 0, 0 });
+		}
+
+		const Expression* variable(char name, int index = 0)
+		{
+			return intern({ Kind::VARIABLE, UnaryFunction::SIN, BinaryFunction::ADD, name, index, 0, nullptr, nullptr, 0, 0, 0 });
+		}
+
+		const Expression* unary(UnaryFunction uf, const Expression *pChild)
+		{
+			return intern({ Kind::UNARY, uf, BinaryFunction::ADD, 0, 0, 0, pChild, nullptr, 0, 0, 0 });
+		}
+
+		const Expression* binary(BinaryFunction bf, const Expression *pLeft, const Expression *pRight)
+		{
+			return intern({ Kind::BINARY, UnaryFunction::SIN, bf, 0, 0, 0, pLeft, pRight, 0, 0, 0 });
+		}
+
+#pragma endregion
+
+#pragma region Parsing
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Parses the formula in the format of Node::dump
+		//!
+		//! \param   rText  Integers, variables 'x' or 'x_1', sin, cos, lg, ln, unary and binary '-', '+', '*', '/', '^' and parentheses
+		//!
+		//! \return  Root of the expression
+		//!
+		//! \throw   std::invalid_argument, std::bad_alloc
+		//!
+		//====================================================================================================================================
+
+		const Expression* parse(const std::string &rText)
+		{
+			std::size_t position = 0;
+
+			const Expression *pResult = parseSum(rText, position);
+
+			skipSpaces(rText, position);
+			if (position != rText.size())
+				throw std::invalid_argument("Unexpected '" + rText.substr(position, 1) + "' at " + std::to_string(position));
+
+			return pResult;
+		}
+
+#pragma endregion
+
+#pragma region Derivative
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Derivative by the variable, the same rules as Node::der
+		//!
+		//! \param   pExpression  Expression of this context
+		//! \param   name         Name of the variable
+		//! \param   index        Index of the variable
+		//!
+		//! \return  Derivative, every shared subexpression is differentiated once
+		//!
+		//! \throw   std::bad_alloc
+		//!
+		//====================================================================================================================================
+
+		const Expression* derivative(const Expression *pExpression, char name, int index = 0)
+		{
+			std::vector<const Expression*> memo;
+
+			return transform(pExpression, memo,
+				[this](const Expression *pNode, std::vector<const Expression*> &rStack, const std::vector<const Expression*> &rMemo) -> bool
+				{
+					if (pNode->kind == Kind::BINARY && pNode->bf == BinaryFunction::POW)
+					{
+						// (u ^ v)' = u ^ v * (v * ln(u))'
+						const Expression *pExponent = binary(BinaryFunction::MUL, pNode->pRight, unary(UnaryFunction::LN, pNode->pLeft));
+
+						return pushIfMissing(pExponent, rStack, rMemo);
+					}
+
+					return pushChildren(pNode, rStack, rMemo);
+				},
+				[this, name, index](const Expression *pNode, const std::vector<const Expression*> &rMemo) -> const Expression*
+				{
+					return derivativeOf(pNode, name, index, rMemo);
+				});
+		}
+
+#pragma endregion
+
+#pragma region Simplification
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Simplifies the expression by the rules of Simplification, children first, then the node until it stops changing
+		//!
+		//! \throw   std::bad_alloc
+		//!
+		//====================================================================================================================================
+
+		const Expression* simplify(const Expression *pExpression)
+		{
+			std::vector<const Expression*> memo;
+
+			return transform(pExpression, memo,
+				[this](const Expression *pNode, std::vector<const Expression*> &rStack, const std::vector<const Expression*> &rMemo)
+				{
+					return pushChildren(pNode, rStack, rMemo);
+				},
+				[this](const Expression *pNode, const std::vector<const Expression*> &rMemo) -> const Expression*
+				{
+					const Expression *pResult = pNode;
+					if (pNode->kind == Kind::UNARY)
+						pResult = unary(pNode->uf, rMemo[pNode->pLeft->id]);
+					else if (pNode->kind == Kind::BINARY)
+						pResult = binary(pNode->bf, rMemo[pNode->pLeft->id], rMemo[pNode->pRight->id]);
+
+					return settle(pResult);
+				});
+		}
+
+#pragma endregion
+
+#pragma region Lowering
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Lowers the expression to instructions: one per unique node in post-order, then registers are allocated
+		//!
+		//! \throw   std::bad_alloc
+		//!
+		//====================================================================================================================================
+
+		Program compile(const Expression *pExpression) const
+		{
+			const std::vector<const Expression*> nodes = postOrder(pExpression);
+
+			Program program;
+			for (const Expression *pNode : nodes)
+				if (pNode->kind == Kind::VARIABLE)
+					program.variables.emplace_back(pNode->name, pNode->index);
+
+			std::sort(program.variables.begin(), program.variables.end());
+
+			std::vector<std::uint32_t> slots(m_Size);
+			for (std::size_t i = 0; i < nodes.size(); ++i)
+				slots[nodes[i]->id] = static_cast<std::uint32_t>(i);
+
+			program.code.reserve(nodes.size());
+			for (std::size_t i = 0; i < nodes.size(); ++i)
+			{
+				const Expression *pNode = nodes[i];
+				const auto slot = static_cast<std::uint32_t>(i);
+
+				switch (pNode->kind)
+				{
+				case Kind::NUMBER:
+					program.code.push_back({ Lowering::OpCode::NUMBER, slot, 0, 0, pNode->number });
+					break;
+				case Kind::VARIABLE:
+				{
+					const auto position = std::lower_bound(program.variables.begin(), program.variables.end(), std::make_pair(pNode->name, pNode->index));
+					program.code.push_back({ Lowering::OpCode::VARIABLE, slot, static_cast<std::uint32_t>(position - program.variables.begin()), 0, 0 });
+					break;
+				}
+				case Kind::UNARY:
+					program.code.push_back({ Lowering::GetOpCode(pNode->uf), slot, slots[pNode->pLeft->id], 0, 0 });
+					break;
+				case Kind::BINARY:
+					program.code.push_back({ Lowering::GetOpCode(pNode->bf), slot, slots[pNode->pLeft->id], slots[pNode->pRight->id], 0 });
+					break;
+				}
+			}
+
+			std::vector<std::size_t> lastUse(nodes.size());
+			std::vector<std::uint32_t> registers(nodes.size()), released(nodes.size());
+			Lowering::AllocateRegisters(program.code.data(), program.code.size(), lastUse.data(), registers.data(), released.data());
+
+			program.registers = Lowering::CountRegisters(program.code.data(), program.code.size());
+
+			return program;
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Unique nodes of the expression, children always precede their parents
+		//!
+		//! \throw   std::bad_alloc
+		//!
+		//====================================================================================================================================
+
+		std::vector<const Expression*> postOrder(const Expression *pExpression) const
+		{
+			std::vector<const Expression*> result;
+			std::vector<bool> visited(m_Size);
+			std::vector<std::pair<const Expression*, bool>> stack{ { pExpression, false } };
+
+			while (!stack.empty())
+			{
+				const auto [pNode, expanded] = stack.back();
+				stack.pop_back();
+
+				if (expanded)
+				{
+					result.push_back(pNode);
+					continue;
+				}
+
+				if (visited[pNode->id])
+					continue;
+
+				visited[pNode->id] = true;
+				stack.emplace_back(pNode, true);
+				if (pNode->kind == Kind::BINARY)
+					stack.emplace_back(pNode->pRight, false);
+				if (pNode->kind != Kind::NUMBER && pNode->kind != Kind::VARIABLE)
+					stack.emplace_back(pNode->pLeft, false);
+			}
+
+			return result;
+		}
+
+#pragma endregion
+
+#pragma region Dump
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Appends the expression to the sink of Printing in the same format as Node::dump, the only heap allocation is the stack
+		//!
+		//! \throw   std::bad_alloc
+		//!
+		//====================================================================================================================================
+
+		template<typename Sink>
+		static void write(const Expression *pExpression, Sink &rSink)
+		{
+			// a node still to write or, without a node, text to append; pushed in reverse order
+			std::vector<std::pair<const Expression*, std::string_view>> stack{ { pExpression, {} } };
+
+			const auto pushOperand = [&stack](const Expression *pOperand)
+			{
+				if (pOperand->kind == Kind::BINARY)
+					stack.insert(stack.end(), { { nullptr, ")" }, { pOperand, {} }, { nullptr, "(" } });
+				else
+					stack.emplace_back(pOperand, std::string_view());
+			};
+
+			while (!stack.empty())
+			{
+				const auto [pNode, text] = stack.back();
+				stack.pop_back();
+
+				if (!pNode)
+				{
+					rSink.append(text);
+					continue;
+				}
+
+				switch (pNode->kind)
+				{
+				case Kind::NUMBER:
+					writeInteger(pNode->number, rSink);
+					break;
+				case Kind::VARIABLE:
+					rSink.append({ &pNode->name, 1 });
+					rSink.append("_");
+					writeInteger(pNode->index, rSink);
+					break;
+				case Kind::UNARY:
+					rSink.append(GetFunctionName(pNode->uf));
+					rSink.append("(");
+					stack.insert(stack.end(), { { nullptr, ")" }, { pNode->pLeft, {} } });
+					break;
+				case Kind::BINARY:
+					pushOperand(pNode->pRight);
+					stack.insert(stack.end(), { { nullptr, " " }, { nullptr, GetFunctionName(pNode->bf) }, { nullptr, " " } });
+					pushOperand(pNode->pLeft);
+					break;
+				}
+			}
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Dumps the expression in the same format as Node::dump
+		//!
+		//! \throw   std::bad_alloc
+		//!
+		//====================================================================================================================================
+
+		static std::string dump(const Expression *pExpression)
+		{
+			std::string result;
+			Printing::StringSink sink(result);
+			write(pExpression, sink);
+
+			return result;
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Number of nodes of the expression as a tree, the same as NodeCount, saturates at SIZE_MAX
+		//!
+		//====================================================================================================================================
+
+		std::size_t treeSize(const Expression *pExpression) const
+		{
+			std::vector<std::size_t> sizes(m_Size);
+			for (const Expression *pNode : postOrder(pExpression))
+			{
+				std::size_t size = 1;
+				if (pNode->kind != Kind::NUMBER && pNode->kind != Kind::VARIABLE)
+					size += sizes[pNode->pLeft->id];
+				if (pNode->kind == Kind::BINARY)
+					size = (sizes[pNode->pRight->id] > std::numeric_limits<std::size_t>::max() - size ? std::numeric_limits<std::size_t>::max() : size + sizes[pNode->pRight->id]);
+
+				sizes[pNode->id] = size;
+			}
+
+			return sizes[pExpression->id];
+		}
+
+#pragma endregion
+
+	private:
+
+#pragma region Text
+
+		template<typename Sink>
+		static void writeInteger(llong_t value, Sink &rSink)
+		{
+			char digits[24];
+			const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+
+			rSink.append({ digits, static_cast<std::size_t>(result.ptr - digits) });
+		}
+
+#pragma endregion
+
+#pragma region Hash-consing
+
+		static std::size_t hashOf(const Expression &rExpression) noexcept
+		{
+			std::size_t hash = static_cast<std::size_t>(rExpression.kind);
+			const auto mix = [&hash](std::size_t value) { hash = (hash ^ value) * 0x100000001B3ull + (hash >> 29); };
+
+			switch (rExpression.kind)
+			{
+			case Kind::NUMBER:
+				mix(static_cast<std::size_t>(rExpression.number));
+				break;
+			case Kind::VARIABLE:
+				mix(static_cast<std::size_t>(rExpression.name));
+				mix(static_cast<std::size_t>(rExpression.index));
+				break;
+			case Kind::UNARY:
+				mix(static_cast<std::size_t>(rExpression.uf));
+				mix(rExpression.pLeft->id);
+				break;
+			case Kind::BINARY:
+				mix(static_cast<std::size_t>(rExpression.bf));
+				mix(rExpression.pLeft->id);
+				mix(rExpression.pRight->id);
+				break;
+			}
+
+			return hash;
+		}
+
+		static bool equal(const Expression &rLeft, const Expression &rRight) noexcept
+		{
+			return (rLeft.kind == rRight.kind && rLeft.uf == rRight.uf && rLeft.bf == rRight.bf && rLeft.name == rRight.name && rLeft.index == rRight.index &&
+				rLeft.number == rRight.number && rLeft.pLeft == rRight.pLeft && rLeft.pRight == rRight.pRight);
+		}
+
+		static std::size_t addCycles(std::size_t left, std::size_t right) noexcept
+		{
+			return (left > std::numeric_limits<std::size_t>::max() - right ? std::numeric_limits<std::size_t>::max() : left + right);
+		}
+
+		static std::size_t multiplyCycles(std::size_t cycles, std::size_t count) noexcept
+		{
+			return (count && cycles > std::numeric_limits<std::size_t>::max() / count ? std::numeric_limits<std::size_t>::max() : cycles * count);
+		}
+
+		// the same sum as CostModel::Cost, from the cycles of the children
+		static std::size_t cyclesOf(const Expression &rExpression) noexcept
+		{
+			switch (rExpression.kind)
+			{
+			case Kind::NUMBER:
+				return CostModel::Cycles::NUMBER;
+			case Kind::VARIABLE:
+				return CostModel::Cycles::VARIABLE;
+			case Kind::UNARY:
+				return addCycles(rExpression.pLeft->cycles, CostModel::Cycles::of(rExpression.uf));
+			default:
+				return addCycles(addCycles(rExpression.pLeft->cycles, rExpression.pRight->cycles), CostModel::Cycles::of(rExpression.bf));
+			}
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Returns the existing equal node or creates it, open addressing with linear probing, load factor at most 1/2
+		//!
+		//====================================================================================================================================
+
+		const Expression* intern(Expression expression)
+		{
+			expression.hash = hashOf(expression);
+
+			const std::size_t mask = m_Table.size() - 1;
+			std::size_t slot = expression.hash & mask;
+			for (; m_Table[slot]; slot = (slot + 1) & mask)
+				if (m_Table[slot]->hash == expression.hash && equal(*m_Table[slot], expression))
+					return m_Table[slot];
+
+			expression.id = static_cast<std::uint32_t>(m_Size++);
+			expression.cycles = cyclesOf(expression);
+			const Expression *pResult = m_Arena.create<Expression>(expression);
+			m_Table[slot] = pResult;
+
+			if (2 * m_Size > m_Table.size())
+				grow();
+
+			return pResult;
+		}
+
+		void grow()
+		{
+			std::vector<const Expression*> table(2 * m_Table.size(), nullptr);
+
+			const std::size_t mask = table.size() - 1;
+			for (const Expression *pExpression : m_Table)
+				if (pExpression)
+				{
+					std::size_t slot = pExpression->hash & mask;
+					while (table[slot])
+						slot = (slot + 1) & mask;
+
+					table[slot] = pExpression;
+				}
+
+			m_Table.swap(table);
+		}
+
+#pragma endregion
+
+#pragma region Traversal
+
+		static bool pushIfMissing(const Expression *pNode, std::vector<const Expression*> &rStack, const std::vector<const Expression*> &rMemo)
+		{
+			if (pNode->id < rMemo.size() && rMemo[pNode->id])
+				return false;
+
+			rStack.push_back(pNode);
+			return true;
+		}
+
+		static bool pushChildren(const Expression *pNode, std::vector<const Expression*> &rStack, const std::vector<const Expression*> &rMemo)
+		{
+			bool pushed = false;
+			if (pNode->kind == Kind::BINARY)
+				pushed |= pushIfMissing(pNode->pRight, rStack, rMemo);
+			if (pNode->kind == Kind::UNARY || pNode->kind == Kind::BINARY)
+				pushed |= pushIfMissing(pNode->pLeft, rStack, rMemo);
+
+			return pushed;
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Memoized post-order transformation with an explicit stack
+		//!
+		//! \param   pRoot       Expression to transform
+		//! \param   rMemo       Results by node id, grows together with the context
+		//! \param   prepare     Pushes the nodes whose results are needed first, returns true if it pushed any
+		//! \param   apply       Result for the node when everything it needs is in rMemo
+		//!
+		//====================================================================================================================================
+
+		template<typename Prepare, typename Apply>
+		const Expression* transform(const Expression *pRoot, std::vector<const Expression*> &rMemo, Prepare prepare, Apply apply)
+		{
+			std::vector<const Expression*> stack{ pRoot };
+
+			while (!stack.empty())
+			{
+				const Expression *pNode = stack.back();
+
+				if (rMemo.size() < m_Size)
+					rMemo.resize(m_Size, nullptr);
+
+				if (rMemo[pNode->id] || prepare(pNode, stack, rMemo))
+				{
+					if (rMemo[pNode->id])
+						stack.pop_back();
+
+					continue;
+				}
+
+				const Expression *pResult = apply(pNode, rMemo);
+
+				if (rMemo.size() < m_Size)
+					rMemo.resize(m_Size, nullptr);
+
+				rMemo[pNode->id] = pResult;
+				stack.pop_back();
+			}
+
+			return rMemo[pRoot->id];
+		}
+
+#pragma endregion
+
+#pragma region Rules
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Derivative of the node when the derivatives of its children are in rMemo, the rules of Wrap4UF and Wrap4BF
+		//!
+		//====================================================================================================================================
+
+		const Expression* derivativeOf(const Expression *pNode, char name, int index, const std::vector<const Expression*> &rMemo)
+		{
+			switch (pNode->kind)
+			{
+			case Kind::NUMBER:
+				return number(0);
+			case Kind::VARIABLE:
+				return number(pNode->name == name && pNode->index == index ? 1 : 0);
+			case Kind::UNARY:
+			{
+				const Expression *pChild = pNode->pLeft;
+				const Expression *pOuter = nullptr;
+
+				switch (pNode->uf)
+				{
+				case UnaryFunction::SIN:
+					pOuter = unary(UnaryFunction::COS, pChild);
+					break;
+				case UnaryFunction::COS:
+					pOuter = unary(UnaryFunction::NEG, unary(UnaryFunction::SIN, pChild));
+					break;
+				case UnaryFunction::LG:
+					pOuter = binary(BinaryFunction::DIV, number(1), binary(BinaryFunction::MUL, pChild, unary(UnaryFunction::LN, number(10))));
+					break;
+				case UnaryFunction::LN:
+					pOuter = binary(BinaryFunction::DIV, number(1), pChild);
+					break;
+				case UnaryFunction::NEG:
+					pOuter = number(-1);
+					break;
+				}
+
+				return binary(BinaryFunction::MUL, pOuter, rMemo[pChild->id]);
+			}
+			default:
+				break;
+			}
+
+			const Expression *pU = pNode->pLeft;
+			const Expression *pV = pNode->pRight;
+
+			switch (pNode->bf)
+			{
+			case BinaryFunction::ADD:
+				return binary(BinaryFunction::ADD, rMemo[pU->id], rMemo[pV->id]);
+			case BinaryFunction::SUB:
+				return binary(BinaryFunction::SUB, rMemo[pU->id], rMemo[pV->id]);
+			case BinaryFunction::MUL:
+				return binary(BinaryFunction::ADD, binary(BinaryFunction::MUL, rMemo[pU->id], pV), binary(BinaryFunction::MUL, pU, rMemo[pV->id]));
+			case BinaryFunction::DIV:
+				return binary(BinaryFunction::DIV,
+					binary(BinaryFunction::ADD, binary(BinaryFunction::MUL, rMemo[pU->id], pV), unary(UnaryFunction::NEG, binary(BinaryFunction::MUL, pU, rMemo[pV->id]))),
+					binary(BinaryFunction::MUL, pV, pV));
+			default:
+				return binary(BinaryFunction::MUL, pNode,
+					rMemo[binary(BinaryFunction::MUL, pV, unary(UnaryFunction::LN, pU))->id]);
+			}
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Rewrites the node until no rule applies, its children are simplified already
+		//!
+		//====================================================================================================================================
+
+		const Expression* settle(const Expression *pNode)
+		{
+			for (const Expression *pNext = rewrite(pNode); pNext != pNode; pNext = rewrite(pNode))
+				pNode = pNext;
+
+			return pNode;
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 'x ^ N' as multiplications by squaring, the same tree as Simplification::PowerProduct
+		//!
+		//====================================================================================================================================
+
+		const Expression* powerProduct(const Expression *pBase, llong_t exponent)
+		{
+			if (exponent == 1)
+				return pBase;
+
+			if (exponent % 2)
+				return binary(BinaryFunction::MUL, powerProduct(pBase, exponent - 1), pBase);
+
+			const Expression *pHalf = powerProduct(pBase, exponent / 2);
+
+			return binary(BinaryFunction::MUL, pHalf, pHalf);
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 'a * b op a * c' to 'a * (b op c)' or 'a * c op b * c' to '(a op b) * c' if the cost model finds it cheaper, the
+		//!			 same choice as Simplification::Factor with CostModel::CheaperResult; the new sum is settled as well
+		//!
+		//====================================================================================================================================
+
+		const Expression* factor(const Expression *pNode)
+		{
+			const Expression *pLeft  = pNode->pLeft;
+			const Expression *pRight = pNode->pRight;
+
+			if (pLeft->kind != Kind::BINARY || pLeft->bf != BinaryFunction::MUL || pRight->kind != Kind::BINARY || pRight->bf != BinaryFunction::MUL)
+				return pNode;
+
+			const bool leftCommon = (pLeft->pLeft == pRight->pLeft);
+			if (!leftCommon && pLeft->pRight != pRight->pRight)
+				return pNode;
+
+			const Expression *pCommon = (leftCommon ? pLeft->pLeft : pLeft->pRight);
+			const Expression *pFirst  = (leftCommon ? pLeft->pRight : pLeft->pLeft);
+			const Expression *pSecond = (leftCommon ? pRight->pRight : pRight->pLeft);
+
+			const std::size_t cycles = addCycles(addCycles(pCommon->cycles, addCycles(pFirst->cycles, pSecond->cycles)),
+				CostModel::Cycles::of(BinaryFunction::MUL) + CostModel::Cycles::of(pNode->bf));
+			if (cycles >= pNode->cycles)
+				return pNode;
+
+			const Expression *pSum = settle(binary(pNode->bf, pFirst, pSecond));
+
+			return (leftCommon ? binary(BinaryFunction::MUL, pCommon, pSum) : binary(BinaryFunction::MUL, pSum, pCommon));
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 One local rewrite, the rules of Simplification::Rewrite, the cost-driven ones by CostModel::Cycles; returns the node
+		//!			 itself if no rule applies
+		//!
+		//====================================================================================================================================
+
+		const Expression* rewrite(const Expression *pNode)
+		{
+			if (pNode->kind == Kind::UNARY)
+			{
+				if (pNode->uf != UnaryFunction::NEG)
+					return pNode;
+
+				if (pNode->pLeft->kind == Kind::NUMBER && pNode->pLeft->number != std::numeric_limits<llong_t>::min())
+					return number(-pNode->pLeft->number);                                                  // -(N)    = -N
+
+				if (pNode->pLeft->kind == Kind::UNARY && pNode->pLeft->uf == UnaryFunction::NEG)
+					return pNode->pLeft->pLeft;                                                            // -(-x)   = x
+
+				return pNode;
+			}
+
+			if (pNode->kind != Kind::BINARY)
+				return pNode;
+
+			const Expression *pLeft  = pNode->pLeft;
+			const Expression *pRight = pNode->pRight;
+
+			if (pLeft->kind == Kind::NUMBER && pRight->kind == Kind::NUMBER)
+			{
+				llong_t result = 0;
+				return (Fold(pNode->bf, pLeft->number, pRight->number, result) ? number(result) : pNode); // N op M
+			}
+
+			const bool leftOther  = (pLeft->kind != Kind::NUMBER);
+			const bool rightOther = (pRight->kind != Kind::NUMBER);
+
+			switch (pNode->bf)
+			{
+			case BinaryFunction::MUL:
+				if (leftOther && IsNumber(pRight, 1))  return pLeft;                                        // x * 1   = x
+				if (rightOther && IsNumber(pLeft, 1))  return pRight;                                       // 1 * x   = x
+				if (leftOther && IsNumber(pRight, 0))  return pRight;                                       // x * 0   = 0
+				if (rightOther && IsNumber(pLeft, 0))  return pLeft;                                        // 0 * x   = 0
+				if (leftOther && IsNumber(pRight, -1)) return unary(UnaryFunction::NEG, pLeft);             // x * -1  = -x
+				if (rightOther && IsNumber(pLeft, -1)) return unary(UnaryFunction::NEG, pRight);            // -1 * x  = -x
+				break;
+			case BinaryFunction::DIV:
+				if (rightOther && IsNumber(pLeft, 0))  return pLeft;                                        // 0 / x   = 0
+				if (leftOther && IsNumber(pRight, 1))  return pLeft;                                        // x / 1   = x
+				break;
+			case BinaryFunction::ADD:
+				if (leftOther && IsNumber(pRight, 0))  return pLeft;                                        // x + 0   = x
+				if (rightOther && IsNumber(pLeft, 0))  return pRight;                                       // 0 + x   = x
+				if (!IsNumber(pLeft, 0) && pRight->kind == Kind::UNARY && pRight->uf == UnaryFunction::NEG)
+					return binary(BinaryFunction::SUB, pLeft, pRight->pLeft);                              // x + -y  = x - y
+				return factor(pNode);                                                                      // a * b + a * c = a * (b + c)
+			case BinaryFunction::SUB:
+				if (leftOther && IsNumber(pRight, 0))  return pLeft;                                        // x - 0   = x
+				if (rightOther && IsNumber(pLeft, 0))  return unary(UnaryFunction::NEG, pRight);            // 0 - x   = -x
+				return factor(pNode);                                                                      // a * c - b * c = (a - b) * c
+			case BinaryFunction::POW:
+				if (leftOther && IsNumber(pRight, 1))  return pLeft;                                        // x ^ 1   = x
+				if (leftOther && IsNumber(pRight, 0))  return number(1);                                    // x ^ 0   = 1
+				if (leftOther && !rightOther && pRight->number >= 2)                                       // x ^ N   = x * ... * x
+				{
+					// N times x and N - 1 multiplications as a tree, without creating the nodes
+					const std::size_t count = static_cast<std::size_t>(pRight->number);
+					const std::size_t cycles = addCycles(multiplyCycles(pLeft->cycles, count), multiplyCycles(CostModel::Cycles::of(BinaryFunction::MUL), count - 1));
+					if (cycles < pNode->cycles)
+						return powerProduct(pLeft, pRight->number);
+				}
+				break;
+			}
+
+			return pNode;
+		}
+
+#pragma endregion
+
+#pragma region Parser
+
+		static void skipSpaces(const std::string &rText, std::size_t &rPosition) noexcept
+		{
+			while (rPosition < rText.size() && std::isspace(static_cast<unsigned char>(rText[rPosition])))
+				++rPosition;
+		}
+
+		static bool accept(const std::string &rText, std::size_t &rPosition, char symbol) noexcept
+		{
+			skipSpaces(rText, rPosition);
+			if (rPosition < rText.size() && rText[rPosition] == symbol)
+			{
+				++rPosition;
+				return true;
+			}
+
+			return false;
+		}
+
+		static void expect(const std::string &rText, std::size_t &rPosition, char symbol)
+		{
+			if (!accept(rText, rPosition, symbol))
+				throw std::invalid_argument(std::string("Expected '") + symbol + "' at " + std::to_string(rPosition));
+		}
+
+		// sum     := product (('+' | '-') product)*
+		// product := unary (('*' | '/') unary)*
+		// unary   := '-' integer power? | '-(' sum ')' power? | '-' unary | primary power?, so that "-1" is Number<-1>, "-(1)" is
+		//            its negation and both bind like the functions of Node::dump: "-2 ^ 2" is Number<-2> squared, "-(x) ^ 2" is (-x) squared
+		// power   := ('^' unary)?
+		// primary := integer | name ('_' integer)? | function '(' sum ')' | '(' sum ')'
+		//
+		// by precedence with explicit stacks instead of a function per rule, dumps of long sums nest as deep as they are long
+		struct Pending
+		{
+			enum class Kind : std::uint8_t
+			{
+				BINARY,      // left operand on the stack, '^' is right-associative
+				NEGATION,    // '-' unary, binds tighter than '*' and looser than '^'
+				PARENTHESIS, // '(' sum ')'
+				FUNCTION,    // function '(' sum ')' and '-(' sum ')' with UnaryFunction::NEG
+			};
+
+			Kind kind;
+			BinaryFunction bf;
+			UnaryFunction uf;
+
+			int precedence() const noexcept
+			{
+				if (kind == Kind::NEGATION)
+					return 3;
+
+				switch (bf)
+				{
+				case BinaryFunction::ADD:
+				case BinaryFunction::SUB:
+					return 1;
+				case BinaryFunction::MUL:
+				case BinaryFunction::DIV:
+					return 2;
+				default:
+					return 4;
+				}
+			}
+		};
+
+		const Expression* parseSum(const std::string &rText, std::size_t &rPosition)
+		{
+			std::vector<const Expression*> operands;
+			std::vector<Pending> pending;
+
+			const auto reduce = [&]()
+			{
+				const Pending top = pending.back();
+				pending.pop_back();
+
+				const Expression *pRight = operands.back();
+				operands.pop_back();
+
+				if (top.kind == Pending::Kind::BINARY)
+					operands.back() = binary(top.bf, operands.back(), pRight);
+				else if (top.kind == Pending::Kind::NEGATION)
+					operands.push_back(unary(UnaryFunction::NEG, pRight));
+				else if (top.kind == Pending::Kind::FUNCTION)
+					operands.push_back(unary(top.uf, pRight));
+				else
+					operands.push_back(pRight);
+			};
+
+			const auto isOperator = [&pending]()
+			{
+				return (!pending.empty() && (pending.back().kind == Pending::Kind::BINARY || pending.back().kind == Pending::Kind::NEGATION));
+			};
+
+			for (;;)
+			{
+				// operand, after any number of prefixes
+				if (accept(rText, rPosition, '-'))
+				{
+					if (rPosition < rText.size() && std::isdigit(static_cast<unsigned char>(rText[rPosition])))
+						operands.push_back(number(parseInteger(rText, rPosition, true)));
+					else if (accept(rText, rPosition, '('))
+					{
+						pending.push_back({ Pending::Kind::FUNCTION, BinaryFunction::ADD, UnaryFunction::NEG });
+						continue;
+					}
+					else
+					{
+						pending.push_back({ Pending::Kind::NEGATION, BinaryFunction::ADD, UnaryFunction::NEG });
+						continue;
+					}
+				}
+				else if (accept(rText, rPosition, '('))
+				{
+					pending.push_back({ Pending::Kind::PARENTHESIS, BinaryFunction::ADD, UnaryFunction::SIN });
+					continue;
+				}
+				else
+				{
+					UnaryFunction uf = UnaryFunction::SIN;
+					const Expression *pPrimary = parsePrimary(rText, rPosition, uf);
+					if (!pPrimary)
+					{
+						pending.push_back({ Pending::Kind::FUNCTION, BinaryFunction::ADD, uf });
+						continue;
+					}
+
+					operands.push_back(pPrimary);
+				}
+
+				// closing parentheses and the operator after the operand
+				for (;;)
+				{
+					BinaryFunction bf;
+					if (accept(rText, rPosition, '+'))
+						bf = BinaryFunction::ADD;
+					else if (accept(rText, rPosition, '-'))
+						bf = BinaryFunction::SUB;
+					else if (accept(rText, rPosition, '*'))
+						bf = BinaryFunction::MUL;
+					else if (accept(rText, rPosition, '/'))
+						bf = BinaryFunction::DIV;
+					else if (accept(rText, rPosition, '^'))
+						bf = BinaryFunction::POW;
+					else
+					{
+						while (isOperator())
+							reduce();
+
+						if (pending.empty())
+							return operands.back();
+
+						expect(rText, rPosition, ')');
+						reduce();
+						continue;
+					}
+
+					const Pending next{ Pending::Kind::BINARY, bf, UnaryFunction::SIN };
+					while (isOperator() && (pending.back().precedence() > next.precedence() || (pending.back().precedence() == next.precedence() && bf != BinaryFunction::POW)))
+						reduce();
+
+					pending.push_back(next);
+					break;
+				}
+			}
+		}
+
+		// integer or variable, nullptr for a function name with its '(' read and the function in rFunction
+		const Expression* parsePrimary(const std::string &rText, std::size_t &rPosition, UnaryFunction &rFunction)
+		{
+			const std::size_t start = rPosition;
+
+			if (rPosition < rText.size() && std::isdigit(static_cast<unsigned char>(rText[rPosition])))
+				return number(parseInteger(rText, rPosition));
+
+			while (rPosition < rText.size() && std::isalpha(static_cast<unsigned char>(rText[rPosition])))
+				++rPosition;
+
+			const std::string word = rText.substr(start, rPosition - start);
+
+			static const std::pair<const char*, UnaryFunction> s_Functions[] =
+			{
+				{ "sin", UnaryFunction::SIN },
+				{ "cos", UnaryFunction::COS },
+				{ "lg",  UnaryFunction::LG  },
+				{ "ln",  UnaryFunction::LN  },
+			};
+
+			for (const auto &rEntry : s_Functions)
+				if (word == rEntry.first)
+				{
+					expect(rText, rPosition, '(');
+					rFunction = rEntry.second;
+
+					return nullptr;
+				}
+
+			if (word.size() != 1)
+				throw std::invalid_argument("Unknown name '" + word + "' at " + std::to_string(start));
+
+			llong_t index = 0;
+			if (rPosition < rText.size() && rText[rPosition] == '_')
+			{
+				++rPosition;
+				index = parseInteger(rText, rPosition);
+				if (index > std::numeric_limits<int>::max())
+					throw std::invalid_argument("Variable index is too large at " + std::to_string(rPosition));
+			}
+
+			return variable(word[0], static_cast<int>(index));
+		}
+
+		// negative integers are accumulated as such, so the minimum of llong_t, which Node::dump writes too, can be read back
+		static llong_t parseInteger(const std::string &rText, std::size_t &rPosition, bool negative = false)
+		{
+			if (rPosition >= rText.size() || !std::isdigit(static_cast<unsigned char>(rText[rPosition])))
+				throw std::invalid_argument("Expected integer at " + std::to_string(rPosition));
+
+			const BinaryFunction digit = (negative ? BinaryFunction::SUB : BinaryFunction::ADD);
+
+			llong_t result = 0;
+			for (; rPosition < rText.size() && std::isdigit(static_cast<unsigned char>(rText[rPosition])); ++rPosition)
+				if (!Fold(BinaryFunction::MUL, result, 10, result) || !Fold(digit, result, rText[rPosition] - '0', result))
+					throw std::invalid_argument("Integer is too large at " + std::to_string(rPosition));
+
+			return result;
+		}
+
+#pragma endregion
+
+		Arena m_Arena;
+		std::vector<const Expression*> m_Table;
+		std::size_t m_Size = 0;
+	};
+
+#pragma endregion
+
+} // namespace Runtime
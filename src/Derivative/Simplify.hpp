@@ -1,33 +1,120 @@
 #pragma once
 
+#include "Cost.hpp"
 #include "Differentiation.hpp"
 
+#include <limits> // std::numeric_limits
+
 namespace Simplification
 {
 
-#pragma region Simplification
+#pragma region Rewrite rules
+
+	//====================================================================================================================================
+	//!
+	//! \brief	One local rewrite of the node, children are already simplified
+	//!
+	//====================================================================================================================================
 
 	template<typename T, typename Enable = void>
-	struct Simplify
+	struct Rewrite
 	{
 		using res = T;
 	};
 
-	template<typename T>
-	using SimplifyPrime = Simplify<T>;
-
 	//====================================================================================================================================
 	//!
-	//! \brief	Simplification not to write ::res
+	//! \brief	Rewrite not to write ::res
 	//!
 	//====================================================================================================================================
 
 	template<typename T>
-	using SimplifyResult = typename Simplify<T>::res;
+	using RewriteResult = typename Rewrite<T>::res;
 
 	template<typename Other>
 	using NotANum = std::enable_if_t<!IsNodeNumber<Other>::value>;
 
+	//====================================================================================================================================
+	//!
+	//! \brief	Result of folding 'const op const', folds is false if the rule does not apply: inexact division, negative exponent
+	//!			or overflow, the node then stays as it is and is calculated in double like any other
+	//!
+	//====================================================================================================================================
+
+	struct Folding
+	{
+		bool folds;
+		llong_t value;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Folds the binary function of two numbers with overflow checks, the power by squaring
+	//!
+	//====================================================================================================================================
+
+	constexpr Folding Fold(BinaryFunction bf, llong_t left, llong_t right) noexcept
+	{
+		constexpr llong_t MAX = std::numeric_limits<llong_t>::max();
+		constexpr llong_t MIN = std::numeric_limits<llong_t>::min();
+
+		switch (bf)
+		{
+		case BinaryFunction::ADD:
+			if ((right > 0 && left > MAX - right) || (right < 0 && left < MIN - right))
+				return { false, 0 };
+			return { true, left + right };
+		case BinaryFunction::SUB:
+			if ((right < 0 && left > MAX + right) || (right > 0 && left < MIN + right))
+				return { false, 0 };
+			return { true, left - right };
+		case BinaryFunction::MUL:
+			if (left > 0 ? (right > 0 ? left > MAX / right : right < MIN / left) : (right > 0 ? left < MIN / right : left && right < MAX / left))
+				return { false, 0 };
+			return { true, left * right };
+		case BinaryFunction::DIV:
+			if (!right || (left == MIN && right == -1) || left % right)
+				return { false, 0 };
+			return { true, left / right };
+		case BinaryFunction::POW:
+		{
+			if (right < 0)
+				return { false, 0 };
+
+			// the base is squared only if a higher bit of the exponent is left, so it overflows only if the result does
+			Folding result{ true, 1 };
+			for (Folding base{ true, left }; right; right >>= 1)
+			{
+				if (right & 1)
+					result = Fold(BinaryFunction::MUL, result.value, base.value);
+
+				if (!result.folds)
+					return result;
+
+				if (right > 1)
+				{
+					base = Fold(BinaryFunction::MUL, base.value, base.value);
+					if (!base.folds)
+						return base;
+				}
+			}
+
+			return result;
+		}
+		default:
+			return { false, 0 };
+		}
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Whether 'N op M' folds to a number, see Fold
+	//!
+	//====================================================================================================================================
+
+	template<BinaryFunction BF, llong_t N, llong_t M>
+	using Folds = std::enable_if_t<Fold(BF, N, M).folds>;
+
 	//====================================================================================================================================
 	//!
 	//! \brief	Simplification 'x * 1' to 'x'
@@ -35,9 +122,9 @@ namespace Simplification
 	//====================================================================================================================================
 
 	template<typename Other>
-	struct Simplify<Node<Wrap4BF<BinaryFunction::MUL>, Other, Node<Number<1>>>, NotANum<Other>>
+	struct Rewrite<Node<WrapMul, Other, Node<Number<1>>>, NotANum<Other>>
 	{
-		using res = SimplifyResult<Other>;
+		using res = Other;
 	};
 
 	//====================================================================================================================================
@@ -47,9 +134,9 @@ namespace Simplification
 	//====================================================================================================================================
 
 	template<typename Other>
-	struct Simplify<Node<Wrap4BF<BinaryFunction::MUL>, Node<Number<1>>, Other>, NotANum<Other>>
+	struct Rewrite<Node<WrapMul, Node<Number<1>>, Other>, NotANum<Other>>
 	{
-		using res = SimplifyResult<Other>;
+		using res = Other;
 	};
 
 	//====================================================================================================================================
@@ -59,9 +146,9 @@ namespace Simplification
 	//====================================================================================================================================
 
 	template<typename Other>
-	struct Simplify<Node<Wrap4BF<BinaryFunction::MUL>, Other, Node<Number<0>>>, NotANum<Other>>
+	struct Rewrite<Node<WrapMul, Other, Node<Number<0>>>, NotANum<Other>>
 	{
-		using Result_t = Node<Number<0>>;
+		using res = Node<Number<0>>;
 	};
 
 	//====================================================================================================================================
@@ -71,45 +158,45 @@ namespace Simplification
 	//====================================================================================================================================
 
 	template<typename Other>
-	struct Simplify<Node<Wrap4BF<BinaryFunction::MUL>, Node<Number<0>>, Other>, NotANum<Other>>
+	struct Rewrite<Node<WrapMul, Node<Number<0>>, Other>, NotANum<Other>>
 	{
 		using res = Node<Number<0>>;
 	};
 
 	//====================================================================================================================================
 	//!
-	//! \brief	Simplification 'const * const' to 'const'
+	//! \brief	Simplification 'x * (-1)' to '(-x)'
 	//!
 	//====================================================================================================================================
 
-	template<llong_t N, llong_t M>
-	struct Simplify<Node<Wrap4BF<BinaryFunction::MUL>, Node<Number<N>>, Node<Number<M>>>>
+	template<typename Other>
+	struct Rewrite<Node<WrapMul, Other, Node<Number<-1>>>, NotANum<Other>>
 	{
-		using res = Node<Number<N * M>>;
+		using res = Node<WrapNeg, Other>;
 	};
 
 	//====================================================================================================================================
 	//!
-	//! \brief	Simplification 'x * (-1)' to '(-x)'
+	//! \brief	Simplification '(-1) * x' to '(-x)'
 	//!
 	//====================================================================================================================================
 
 	template<typename Other>
-	struct Simplify<Node<Wrap4BF<BinaryFunction::MUL>, Other, Node<Number<-1>>>, NotANum<Other>>
+	struct Rewrite<Node<WrapMul, Node<Number<-1>>, Other>, NotANum<Other>>
 	{
 		using res = Node<WrapNeg, Other>;
 	};
 
 	//====================================================================================================================================
 	//!
-	//! \brief	Simplification '(-1) * x' to '(-x)'
+	//! \brief	Simplification 'const * const' to 'const' if the product fits, see Fold
 	//!
 	//====================================================================================================================================
 
-	template<typename Other>
-	struct Simplify<Node<Wrap4BF<BinaryFunction::MUL>, Node<Number<-1>>, Other>, NotANum<Other>>
+	template<llong_t N, llong_t M>
+	struct Rewrite<Node<WrapMul, Node<Number<N>>, Node<Number<M>>>, Folds<BinaryFunction::MUL, N, M>>
 	{
-		using res = Node<WrapNeg, Other>;
+		using res = Node<Number<Fold(BinaryFunction::MUL, N, M).value>>;
 	};
 
 	//====================================================================================================================================
@@ -119,101 +206,331 @@ namespace Simplification
 	//====================================================================================================================================
 
 	template<typename Other>
-	struct Simplify<Node<WrapDiv, Node<Number<0>>, Other>>
+	struct Rewrite<Node<WrapDiv, Node<Number<0>>, Other>, NotANum<Other>>
 	{
 		using res = Node<Number<0>>;
 	};
 
-	/*
 	//====================================================================================================================================
 	//!
-	//! \brief	Simplification 'const + const' to 'const'
+	//! \brief	Simplification 'x / 1' to 'x'
 	//!
 	//====================================================================================================================================
 
-	template<llong_t N, llong_t M>
-	struct Simplify<Node<Add, Node<Number<N>>, Node<Number<M>>>>
+	template<typename Other>
+	struct Rewrite<Node<WrapDiv, Other, Node<Number<1>>>, NotANum<Other>>
 	{
-		using res = Node<Number<N + M>>;
+		using res = Other;
 	};
 
 	//====================================================================================================================================
 	//!
-	//! \brief	Simplification 'const / const' to 'const'
+	//! \brief	Simplification 'const / const' to 'const', only when the division is exact so that '1 / 2' stays a fraction
 	//!
 	//====================================================================================================================================
 
 	template<llong_t N, llong_t M>
-	struct Simplify<Node<Div, Node<Number<N>>, Node<Number<M>>>>
+	struct Rewrite<Node<WrapDiv, Node<Number<N>>, Node<Number<M>>>, Folds<BinaryFunction::DIV, N, M>>
 	{
-		static_assert(!M, "M must not be zero");
+		using res = Node<Number<Fold(BinaryFunction::DIV, N, M).value>>;
+	};
 
-		using res = Node<Number<N / M>>;
+	//====================================================================================================================================
+	//!
+	//! \brief	Simplification 'x + 0' to 'x'
+	//!
+	//====================================================================================================================================
+
+	template<typename Other>
+	struct Rewrite<Node<WrapAdd, Other, Node<Number<0>>>, NotANum<Other>>
+	{
+		using res = Other;
 	};
 
 	//====================================================================================================================================
 	//!
-	//! \brief	Simplification 'const - const' to 'const'
+	//! \brief	Simplification '0 + x' to 'x'
+	//!
+	//====================================================================================================================================
+
+	template<typename Other>
+	struct Rewrite<Node<WrapAdd, Node<Number<0>>, Other>, NotANum<Other>>
+	{
+		using res = Other;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Simplification 'x + (-y)' to 'x - y'
+	//!
+	//====================================================================================================================================
+
+	template<typename Other, typename Child>
+	struct Rewrite<Node<WrapAdd, Other, Node<WrapNeg, Child>>, std::enable_if_t<!std::is_same_v<Other, Node<Number<0>>>>>
+	{
+		using res = Node<WrapSub, Other, Child>;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Simplification 'const + const' to 'const' if the sum fits
 	//!
 	//====================================================================================================================================
 
 	template<llong_t N, llong_t M>
-	struct Simplify<Node<Sub, Node<Number<N>>, Node<Number<M>>>>
+	struct Rewrite<Node<WrapAdd, Node<Number<N>>, Node<Number<M>>>, Folds<BinaryFunction::ADD, N, M>>
 	{
-		using res = Node<Number<N - M>>;
+		using res = Node<Number<Fold(BinaryFunction::ADD, N, M).value>>;
 	};
-	*/
 
 	//====================================================================================================================================
 	//!
-	//! \brief	Simplification 'x + 0' to 'x'
+	//! \brief	Simplification 'x - 0' to 'x'
 	//!
 	//====================================================================================================================================
 
 	template<typename Other>
-	struct Simplify<Node<WrapAdd, Other, Node<Number<0>>>>
+	struct Rewrite<Node<WrapSub, Other, Node<Number<0>>>, NotANum<Other>>
 	{
 		using res = Other;
 	};
 
 	//====================================================================================================================================
 	//!
-	//! \brief	Simplification '0 + x' to 'x'
+	//! \brief	Simplification '0 - x' to '(-x)'
+	//!
+	//====================================================================================================================================
+
+	template<typename Other>
+	struct Rewrite<Node<WrapSub, Node<Number<0>>, Other>, NotANum<Other>>
+	{
+		using res = Node<WrapNeg, Other>;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Simplification 'const - const' to 'const' if the difference fits
+	//!
+	//====================================================================================================================================
+
+	template<llong_t N, llong_t M>
+	struct Rewrite<Node<WrapSub, Node<Number<N>>, Node<Number<M>>>, Folds<BinaryFunction::SUB, N, M>>
+	{
+		using res = Node<Number<Fold(BinaryFunction::SUB, N, M).value>>;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Simplification 'x ^ 1' to 'x'
 	//!
 	//====================================================================================================================================
 
 	template<typename Other>
-	struct Simplify<Node<WrapAdd, Node<Number<0>>, Other>>
+	struct Rewrite<Node<WrapPow, Other, Node<Number<1>>>, NotANum<Other>>
 	{
 		using res = Other;
 	};
 
 	//====================================================================================================================================
 	//!
-	//! \brief	Simplification '(-const)' to '-const'
+	//! \brief	Simplification 'x ^ 0' to '1'
+	//!
+	//====================================================================================================================================
+
+	template<typename Other>
+	struct Rewrite<Node<WrapPow, Other, Node<Number<0>>>, NotANum<Other>>
+	{
+		using res = Node<Number<1>>;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Simplification 'const ^ const' to 'const' for non-negative exponents if the power fits
+	//!
+	//====================================================================================================================================
+
+	template<llong_t N, llong_t M>
+	struct Rewrite<Node<WrapPow, Node<Number<N>>, Node<Number<M>>>, Folds<BinaryFunction::POW, N, M>>
+	{
+		using res = Node<Number<Fold(BinaryFunction::POW, N, M).value>>;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Simplification '(-const)' to '-const' except for the minimum, whose negation does not fit
 	//!
 	//====================================================================================================================================
 
 	template<llong_t N>
-	struct Simplify<Node<WrapNeg, Node<Number<N>>>>
+	struct Rewrite<Node<WrapNeg, Node<Number<N>>>, Folds<BinaryFunction::SUB, 0, N>>
 	{
 		using res = Node<Number<-N>>;
 	};
 
 	//====================================================================================================================================
 	//!
-	//! \brief	Simplification of unary function argument
+	//! \brief	Simplification '(-(-x))' to 'x'
+	//!
+	//====================================================================================================================================
+
+	template<typename Other>
+	struct Rewrite<Node<WrapNeg, Node<WrapNeg, Other>>>
+	{
+		using res = Other;
+	};
+
+#pragma endregion
+
+#pragma region Cost-driven rewrite rules
+
+	//====================================================================================================================================
+	//!
+	//! \brief	'x ^ N' as multiplications by squaring, x ^ 4 is (x * x) * (x * x)
+	//!
+	//====================================================================================================================================
+
+	template<typename Base, llong_t N, typename Enable = void>
+	struct PowerProduct
+	{
+		using res = Node<WrapMul, typename PowerProduct<Base, N / 2>::res, typename PowerProduct<Base, N / 2>::res>;
+	};
+
+	template<typename Base, llong_t N>
+	struct PowerProduct<Base, N, std::enable_if_t<(N > 1 && N % 2 == 1)>>
+	{
+		using res = Node<WrapMul, typename PowerProduct<Base, N - 1>::res, Base>;
+	};
+
+	template<typename Base>
+	struct PowerProduct<Base, 1>
+	{
+		using res = Base;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Simplification 'x ^ N' to multiplications if the cost model finds them cheaper than pow, N >= 2
+	//!
+	//! \note	Node::calc evaluates x once per factor, so it is x ^ 2 for sin(x) but stays pow for sin(x) ^ 3
+	//!
+	//====================================================================================================================================
+
+	template<typename Other, llong_t N>
+	struct Rewrite<Node<WrapPow, Other, Node<Number<N>>>, std::enable_if_t<!IsNodeNumber<Other>::value && (N >= 2)>>
+	{
+		using res = CostModel::CheaperResult<Node<WrapPow, Other, Node<Number<N>>>, typename PowerProduct<Other, N>::res>;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Common factor of the terms of 'a * b + a * c' or 'a * c - b * c', T itself if there is none
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	struct Factor
+	{
+		using res = T;
+	};
+
+	template<BinaryFunction BF, typename A, typename B, typename C>
+	struct Factor<Node<Wrap4BF<BF>, Node<WrapMul, A, B>, Node<WrapMul, A, C>>>
+	{
+		using res = Node<WrapMul, A, Node<Wrap4BF<BF>, B, C>>;
+	};
+
+	template<BinaryFunction BF, typename A, typename B, typename C>
+	struct Factor<Node<Wrap4BF<BF>, Node<WrapMul, A, C>, Node<WrapMul, B, C>>>
+	{
+		using res = Node<WrapMul, Node<Wrap4BF<BF>, A, B>, C>;
+	};
+
+	template<BinaryFunction BF, typename A, typename B>
+	struct Factor<Node<Wrap4BF<BF>, Node<WrapMul, A, B>, Node<WrapMul, A, B>>>
+	{
+		using res = Node<WrapMul, A, Node<Wrap4BF<BF>, B, B>>;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Simplification 'a * b + a * c' to 'a * (b + c)' and the same for '-' if the cost model finds it cheaper
 	//!
 	//====================================================================================================================================
 
+	template<typename A, typename B, typename C, typename D>
+	struct Rewrite<Node<WrapAdd, Node<WrapMul, A, B>, Node<WrapMul, C, D>>>
+	{
+		using res = CostModel::CheaperResult<Node<WrapAdd, Node<WrapMul, A, B>, Node<WrapMul, C, D>>,
+			typename Factor<Node<WrapAdd, Node<WrapMul, A, B>, Node<WrapMul, C, D>>>::res>;
+	};
+
+	template<typename A, typename B, typename C, typename D>
+	struct Rewrite<Node<WrapSub, Node<WrapMul, A, B>, Node<WrapMul, C, D>>>
+	{
+		using res = CostModel::CheaperResult<Node<WrapSub, Node<WrapMul, A, B>, Node<WrapMul, C, D>>,
+			typename Factor<Node<WrapSub, Node<WrapMul, A, B>, Node<WrapMul, C, D>>>::res>;
+	};
+
+#pragma endregion
+
+#pragma region Simplification
+
+	//====================================================================================================================================
+	//!
+	//! \brief	One bottom-up pass: children are simplified first, then the node itself is rewritten
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	struct Pass
+	{
+		using res = T;
+	};
+
 	template<UnaryFunction UF, typename Child>
-	struct Simplify<Node<Wrap4UF<UF>, Child>>
+	struct Pass<Node<Wrap4UF<UF>, Child>>
+	{
+		using res = RewriteResult<Node<Wrap4UF<UF>, typename Pass<Child>::res>>;
+	};
+
+	template<BinaryFunction BF, typename Left, typename Right>
+	struct Pass<Node<Wrap4BF<BF>, Left, Right>>
 	{
-		using res = Node<Wrap4UF<UF>, SimplifyResult<Child>>;
+		using res = RewriteResult<Node<Wrap4BF<BF>, typename Pass<Left>::res, typename Pass<Right>::res>>;
 	};
 
+	//====================================================================================================================================
+	//!
+	//! \brief	Repeats passes until the tree stops changing
+	//!
+	//====================================================================================================================================
+
+	template<typename T, typename Next = typename Pass<T>::res>
+	struct Simplify
+	{
+		using res = typename Simplify<Next>::res;
+	};
+
+	template<typename T>
+	struct Simplify<T, T>
+	{
+		using res = T;
+	};
+
+	template<typename T>
+	using SimplifyPrime = Simplify<T>;
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Simplification not to write ::res
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	using SimplifyResult = typename Simplify<T>::res;
+
 #pragma endregion
-	
+
 #pragma region Operators
 
 	template<llong_t N>
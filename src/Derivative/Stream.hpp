@@ -0,0 +1,976 @@
+#pragma once
+
+//====================================================================================================================================
+//!
+//!	\file   Stream.hpp
+//!
+//! \brief	Evaluation of expressions over files larger than memory: memory-mapped columnar binary files and chunked CSV
+//!
+//====================================================================================================================================
+
+#include "Parallel.hpp"
+#include "Text.hpp"
+#include "Variables.hpp"
+
+#include <algorithm>          // std::min
+#include <chrono>             // std::chrono::steady_clock
+#include <charconv>           // std::from_chars, std::to_chars
+#include <cmath>              // std::copysign
+#include <condition_variable> // std::condition_variable
+#include <cstdint>            // std::uint64_t
+#include <cstdio>             // std::FILE, std::fopen, std::fread, std::fwrite
+#include <cstdlib>            // std::strtod
+#include <cstring>            // std::memcmp, std::memchr, std::memmove
+#include <exception>          // std::exception_ptr
+#include <limits>             // std::numeric_limits
+#include <mutex>              // std::mutex, std::unique_lock
+#include <stdexcept>          // std::runtime_error, std::invalid_argument
+#include <string>             // std::string
+#include <system_error>       // std::system_error
+#include <thread>             // std::thread
+#include <vector>             // std::vector
+
+#if defined(_WIN32)
+#if !defined(NOMINMAX)
+#define NOMINMAX
+#endif /* !defined(NOMINMAX) */
+#include <windows.h> // CreateFileMapping, MapViewOfFile
+#else
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap, madvise
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close
+#endif /* defined(_WIN32) */
+
+namespace Streaming
+{
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Rows of one chunk by default, a few MiB of columns
+	//!
+	//====================================================================================================================================
+
+	constexpr std::size_t CHUNK_ROWS = 64 * 1024;
+
+	//====================================================================================================================================
+	//!
+	//! \brief	The expression followed by its derivatives by Vars, the usual list of outputs
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename... Vars>
+	using WithGradient = JoinResult<TypeList<Expr>, typename Symbolic::Gradient<Expr, Vars...>::entries>;
+
+	//====================================================================================================================================
+	//!
+	//! \brief	What one pass read and wrote
+	//!
+	//====================================================================================================================================
+
+	struct Statistics
+	{
+		std::uint64_t rows = 0;
+		std::uint64_t bytesRead = 0;
+		std::uint64_t bytesWritten = 0;
+		double seconds = 0.0;
+
+		double gigabytesPerSecond() const noexcept { return (seconds > 0.0 ? static_cast<double>(bytesRead) / seconds * 1e-9 : 0.0); }
+	};
+
+#pragma region Files
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Read-only mapping of the whole file
+	//!
+	//====================================================================================================================================
+
+	class MappedFile
+	{
+	public:
+		//====================================================================================================================================
+		//!
+		//! \brief	 Maps the file
+		//!
+		//! \throw   std::system_error if the file cannot be opened or mapped
+		//!
+		//====================================================================================================================================
+
+		explicit MappedFile(const char *pPath)
+		{
+#if defined(_WIN32)
+			const HANDLE file = CreateFileA(pPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), pPath);
+
+			LARGE_INTEGER size;
+			GetFileSizeEx(file, &size);
+			m_Size = static_cast<std::size_t>(size.QuadPart);
+
+			const HANDLE mapping = (m_Size ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr);
+			CloseHandle(file);
+
+			if (m_Size)
+			{
+				if (!mapping)
+					throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), pPath);
+
+				m_pData = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+				CloseHandle(mapping);
+
+				if (!m_pData)
+					throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), pPath);
+			}
+#else
+			const int file = ::open(pPath, O_RDONLY);
+			if (file < 0)
+				throw std::system_error(errno, std::generic_category(), pPath);
+
+			struct stat status;
+			if (::fstat(file, &status))
+			{
+				const int error = errno;
+				::close(file);
+				throw std::system_error(error, std::generic_category(), pPath);
+			}
+
+			m_Size = static_cast<std::size_t>(status.st_size);
+
+			void *pData = (m_Size ? ::mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0) : nullptr);
+			const int error = errno;
+			::close(file);
+
+			if (pData == MAP_FAILED)
+				throw std::system_error(error, std::generic_category(), pPath);
+
+			m_pData = static_cast<const char*>(pData);
+#endif /* defined(_WIN32) */
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		~MappedFile()
+		{
+			if (!m_pData)
+				return;
+
+#if defined(_WIN32)
+			UnmapViewOfFile(m_pData);
+#else
+			::munmap(const_cast<char*>(m_pData), m_Size);
+#endif /* defined(_WIN32) */
+		}
+
+		const char* data() const noexcept { return m_pData; }
+		std::size_t size() const noexcept { return m_Size; }
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Asks the system to start reading the range in the background, so reading overlaps with the calculation
+		//!
+		//====================================================================================================================================
+
+		void prefetch(std::size_t offset, std::size_t size) const noexcept
+		{
+#if !defined(_WIN32)
+			advise(offset, size, MADV_WILLNEED, false);
+#else
+			(void)offset;
+			(void)size;
+#endif /* !defined(_WIN32) */
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Drops the pages of the range which was already processed, so the resident memory stays bounded; a page which the
+		//!			 range ends in is kept, it holds the start of the next range
+		//!
+		//====================================================================================================================================
+
+		void release(std::size_t offset, std::size_t size) const noexcept
+		{
+#if !defined(_WIN32)
+			advise(offset, size, MADV_DONTNEED, true);
+#else
+			(void)offset;
+			(void)size;
+#endif /* !defined(_WIN32) */
+		}
+
+	private:
+#if !defined(_WIN32)
+		void advise(std::size_t offset, std::size_t size, int advice, bool wholePages) const noexcept
+		{
+			const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+			const std::size_t first = offset - offset % page;
+
+			if (offset + size > m_Size)
+				size = (offset < m_Size ? m_Size - offset : 0);
+
+			// the last page is partial unless the range ends at a page or at the end of the file
+			std::size_t last = offset + size;
+			if (wholePages && last != m_Size)
+				last -= last % page;
+
+			if (size && last > first)
+				::madvise(const_cast<char*>(m_pData) + first, last - first, advice);
+		}
+#endif /* !defined(_WIN32) */
+
+		const char *m_pData = nullptr;
+		std::size_t m_Size = 0;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Owner of a C stream
+	//!
+	//====================================================================================================================================
+
+	class File
+	{
+	public:
+		//====================================================================================================================================
+		//!
+		//! \brief	 Opens the file
+		//!
+		//! \throw   std::system_error
+		//!
+		//====================================================================================================================================
+
+		File(const char *pPath, const char *pMode) :
+			m_pFile(std::fopen(pPath, pMode))
+		{
+			if (!m_pFile)
+				throw std::system_error(errno, std::generic_category(), pPath);
+		}
+
+		File(const File&) = delete;
+		File& operator=(const File&) = delete;
+
+		~File()
+		{
+			std::fclose(m_pFile);
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Writes at the 64-bit offset
+		//!
+		//! \throw   std::runtime_error
+		//!
+		//====================================================================================================================================
+
+		void writeAt(std::uint64_t offset, const void *pData, std::size_t size)
+		{
+#if defined(_WIN32)
+			const bool seeked = !_fseeki64(m_pFile, static_cast<long long>(offset), SEEK_SET);
+#else
+			const bool seeked = !::fseeko(m_pFile, static_cast<off_t>(offset), SEEK_SET);
+#endif /* defined(_WIN32) */
+
+			if (!seeked)
+				throw std::runtime_error("Cannot seek the output file");
+
+			write(pData, size);
+		}
+
+		void write(const void *pData, std::size_t size)
+		{
+			if (std::fwrite(pData, 1, size, m_pFile) != size)
+				throw std::runtime_error("Cannot write the output file");
+		}
+
+		std::size_t read(void *pData, std::size_t size) noexcept
+		{
+			return std::fread(pData, 1, size, m_pFile);
+		}
+
+		void flush()
+		{
+			if (std::fflush(m_pFile))
+				throw std::runtime_error("Cannot write the output file");
+		}
+
+	private:
+		std::FILE *m_pFile;
+	};
+
+#pragma endregion
+
+#pragma region Columnar format
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Header of a columnar file: rows doubles of column 0, then of column 1 and so on, from offset HEADER_SIZE
+	//!
+	//! \note	Column k of an input file is the variable in slot k of Slots<Layout>
+	//!
+	//====================================================================================================================================
+
+	struct ColumnarHeader
+	{
+		char magic[8];
+		std::uint64_t columns;
+		std::uint64_t rows;
+	};
+
+	constexpr char COLUMNAR_MAGIC[8] = { 'D', 'E', 'R', 'C', 'O', 'L', '1', '\0' };
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Offset of the first column, a cache line so the columns of a mapped file are aligned
+	//!
+	//====================================================================================================================================
+
+	constexpr std::size_t HEADER_SIZE = 64;
+
+	inline std::uint64_t ColumnOffset(std::uint64_t rows, std::size_t column, std::uint64_t row) noexcept
+	{
+		return HEADER_SIZE + (column * rows + row) * sizeof(double);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Writes a columnar file chunk by chunk, rows are known in advance so every chunk goes straight to its place
+	//!
+	//====================================================================================================================================
+
+	class ColumnarWriter
+	{
+	public:
+		//====================================================================================================================================
+		//!
+		//! \brief	 Creates the file and writes the header
+		//!
+		//! \throw   std::system_error, std::runtime_error
+		//!
+		//====================================================================================================================================
+
+		ColumnarWriter(const char *pPath, std::size_t columns, std::uint64_t rows) :
+			m_File(pPath, "wb"),
+			m_Rows(rows)
+		{
+			char header[HEADER_SIZE] = { };
+			ColumnarHeader fields{ { }, columns, rows };
+			std::memcpy(fields.magic, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC));
+			std::memcpy(header, &fields, sizeof(fields));
+
+			m_File.write(header, sizeof(header));
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Writes count values of the column starting from the row
+		//!
+		//! \throw   std::runtime_error
+		//!
+		//====================================================================================================================================
+
+		void write(std::size_t column, std::uint64_t row, const double *pValues, std::size_t count)
+		{
+			m_File.writeAt(ColumnOffset(m_Rows, column, row), pValues, count * sizeof(double));
+		}
+
+		void flush() { m_File.flush(); }
+
+	private:
+		File m_File;
+		std::uint64_t m_Rows;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Columns of the current chunk in the order of the slots of Layout
+	//!
+	//====================================================================================================================================
+
+	template<typename Layout>
+	struct ChunkColumns
+	{
+		std::array<const double*, Slots<Layout>::SIZE> columns;
+
+		template<typename Var>
+		const double* operator()(Var) const noexcept { return columns[Slots<Layout>::template slot<Var>]; }
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Evaluates the expressions for every row of a mapped columnar file and writes a columnar file with one column per
+	//!			 expression. The inputs are read in place, the system reads ahead the next chunk while this one is calculated and
+	//!			 the pages of finished chunks are dropped
+	//!
+	//! \param   pInput     Columnar file, column k is the variable in slot k of Slots<Layout>
+	//! \param   pOutput    Columnar file to create
+	//! \param   chunkRows  Rows per chunk, the memory of the results is Exprs::size * chunkRows doubles
+	//!
+	//! \return  Rows, bytes and time
+	//!
+	//! \throw   std::system_error, std::runtime_error, std::invalid_argument if the input does not match the layout or is shorter
+	//!			 than its header says or chunkRows is 0,
+	//!			 std::overflow_error if any division by zero occurred, the output is complete anyway
+	//!
+	//====================================================================================================================================
+
+	template<typename Exprs, typename Layout = VariablesOfAllResult<Exprs>>
+	Statistics EvaluateColumnar(const char *pInput, const char *pOutput, std::size_t chunkRows = CHUNK_ROWS)
+	{
+		constexpr std::size_t COLUMNS = Slots<Layout>::SIZE;
+
+		if (!chunkRows)
+			throw std::invalid_argument("Chunk without rows");
+
+		const auto start = std::chrono::steady_clock::now();
+
+		const MappedFile input(pInput);
+
+		ColumnarHeader header;
+		if (input.size() < HEADER_SIZE || (std::memcpy(&header, input.data(), sizeof(header)), std::memcmp(header.magic, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC))))
+			throw std::invalid_argument("Not a columnar file");
+
+		if (header.columns != COLUMNS)
+			throw std::invalid_argument("Columns of the file do not match the layout");
+
+		// rows come from the file, compared by division so that a crafted count cannot wrap the offsets around
+		if (COLUMNS && header.rows > (input.size() - HEADER_SIZE) / (COLUMNS * sizeof(double)))
+			throw std::invalid_argument("Columnar file is shorter than its header says");
+
+		const std::uint64_t rows = header.rows;
+		const auto column = [&](std::size_t k, std::uint64_t row) { return reinterpret_cast<const double*>(input.data() + ColumnOffset(rows, k, row)); };
+
+		ColumnarWriter output(pOutput, Exprs::size, rows);
+
+		std::vector<double> results(Exprs::size * chunkRows);
+		std::array<double*, Exprs::size> resultColumns;
+		for (std::size_t k = 0; k < Exprs::size; ++k)
+			resultColumns[k] = results.data() + k * chunkRows;
+
+		ErrorPolicy::Sticky policy;
+
+		for (std::size_t k = 0; k < COLUMNS; ++k)
+			input.prefetch(ColumnOffset(rows, k, 0), chunkRows * sizeof(double));
+
+		for (std::uint64_t first = 0; first < rows; first += chunkRows)
+		{
+			const std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(chunkRows, rows - first));
+
+			ChunkColumns<Layout> columns;
+			for (std::size_t k = 0; k < COLUMNS; ++k)
+			{
+				columns.columns[k] = column(k, first);
+				input.prefetch(ColumnOffset(rows, k, first + count), chunkRows * sizeof(double));
+			}
+
+			Parallel::Outputs<Exprs>::calc(columns, resultColumns.data(), 0, count, policy);
+
+			for (std::size_t k = 0; k < Exprs::size; ++k)
+				output.write(k, first, resultColumns[k], count);
+
+			for (std::size_t k = 0; k < COLUMNS; ++k)
+				input.release(ColumnOffset(rows, k, first), count * sizeof(double));
+		}
+
+		output.flush();
+		policy.check();
+
+		Statistics statistics;
+		statistics.rows = rows;
+		statistics.bytesRead = rows * COLUMNS * sizeof(double);
+		statistics.bytesWritten = rows * Exprs::size * sizeof(double);
+		statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		return statistics;
+	}
+
+#pragma endregion
+
+#pragma region CSV
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 What std::strtod gives for a number beyond the range of double: infinity with its sign if it overflows, zero with its
+	//!			 sign if it underflows
+	//!
+	//! \param   pFirst  Start of the number as std::from_chars matched it, not empty
+	//! \param   pLast   End of the match
+	//!
+	//====================================================================================================================================
+
+	inline double OutOfRange(const char *pFirst, const char *pLast) noexcept
+	{
+		const auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+
+		const bool negative = (*pFirst == '-');
+		if (negative)
+			++pFirst;
+
+		// decimal order of the first significant digit: the value is 0.d... * 10 ^ order, at least 1 exactly for a positive order
+		long long order = 0;
+		bool leading = true;
+
+		for (; pFirst != pLast && isDigit(*pFirst); ++pFirst)
+			if (!(leading = (leading && *pFirst == '0')))
+				++order;
+
+		if (pFirst != pLast && *pFirst == '.')
+			for (++pFirst; pFirst != pLast && isDigit(*pFirst) && leading; ++pFirst)
+				if ((leading = (*pFirst == '0')))
+					--order;
+
+		while (pFirst != pLast && isDigit(*pFirst))
+			++pFirst;
+
+		if (pFirst != pLast && (*pFirst == 'e' || *pFirst == 'E'))
+		{
+			const bool negativeExponent = (++pFirst != pLast && *pFirst == '-');
+			if (pFirst != pLast && (*pFirst == '-' || *pFirst == '+'))
+				++pFirst;
+
+			// saturates far beyond the range of double, but far from overflow of long long
+			long long exponent = 0;
+			for (; pFirst != pLast && isDigit(*pFirst); ++pFirst)
+				exponent = std::min(exponent * 10 + (*pFirst - '0'), 1000000000000LL);
+
+			order += (negativeExponent ? -exponent : exponent);
+		}
+
+		return std::copysign(order > 0 ? std::numeric_limits<double>::infinity() : 0.0, negative ? -1.0 : 1.0);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Parses the double at the start of the field, std::from_chars when the library has it
+	//!
+	//! \param   rValue  The number, NaN if the field does not start with one, infinity or zero with the sign beyond the range of
+	//!					 double as std::strtod gives in both branches
+	//!
+	//! \return  End of the number
+	//!
+	//====================================================================================================================================
+
+	inline const char* ParseDouble(const char *pFirst, const char *pLast, double &rValue) noexcept
+	{
+		while (pFirst != pLast && (*pFirst == ' ' || *pFirst == '+'))
+			++pFirst;
+
+#if defined(__cpp_lib_to_chars)
+		const auto result = std::from_chars(pFirst, pLast, rValue);
+		if (result.ec == std::errc::result_out_of_range)
+			rValue = OutOfRange(pFirst, result.ptr);
+		else if (result.ec != std::errc())
+			rValue = std::numeric_limits<double>::quiet_NaN();
+
+		return result.ptr;
+#else
+		char *pEnd = nullptr;
+		rValue = std::strtod(pFirst, &pEnd);
+
+		return (pEnd == pFirst ? (rValue = std::numeric_limits<double>::quiet_NaN(), pFirst) : pEnd);
+#endif /* defined(__cpp_lib_to_chars) */
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Formats the double in the shortest text which parses back to the same value
+	//!
+	//! \return  End of the text, pFirst has at least 32 characters
+	//!
+	//====================================================================================================================================
+
+	inline char* FormatDouble(char *pFirst, double value) noexcept
+	{
+#if defined(__cpp_lib_to_chars)
+		return std::to_chars(pFirst, pFirst + 32, value).ptr;
+#else
+		return pFirst + std::snprintf(pFirst, 32, "%.17g", value);
+#endif /* defined(__cpp_lib_to_chars) */
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Reads the rows of a CSV file into the columns of the slots of Layout, a block at a time
+	//!
+	//! \note	The first line names the columns like the variables of the expressions, "x0" is Variable<'x', 0>; columns which
+	//!			are no variable of Layout are skipped
+	//!
+	//====================================================================================================================================
+
+	template<typename Layout>
+	class CsvReader
+	{
+	public:
+		static constexpr std::size_t BLOCK = 1 << 20;
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Opens the file and matches the header with the slots
+		//!
+		//! \throw   std::system_error, std::invalid_argument if a variable of Layout has no column
+		//!
+		//====================================================================================================================================
+
+		explicit CsvReader(const char *pPath) :
+			m_File(pPath, "rb"),
+			m_Buffer(BLOCK)
+		{
+			const char *pLine = nextLine();
+			if (!pLine)
+				throw std::invalid_argument("CSV file has no header");
+
+			std::array<bool, Slots<Layout>::SIZE> found{ };
+			for (const char *pField = pLine; pField <= m_pLineEnd; ++pField)
+			{
+				const char *pEnd = pField;
+				while (pEnd != m_pLineEnd && *pEnd != ',')
+					++pEnd;
+
+				m_Fields.push_back(Find(pField, pEnd));
+				if (m_Fields.back() >= 0)
+					found[m_Fields.back()] = true;
+
+				pField = pEnd;
+			}
+
+			for (const bool isFound : found)
+				if (!isFound)
+					throw std::invalid_argument("CSV file has no column for a variable of the expression");
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Parses up to capacity rows, missing or malformed values are NaN
+		//!
+		//! \param   ppColumns  Column of every slot, capacity values each
+		//!
+		//! \return  Number of rows, less than capacity only at the end of the file
+		//!
+		//====================================================================================================================================
+
+		std::size_t read(double *const *ppColumns, std::size_t capacity)
+		{
+			std::size_t row = 0;
+
+			for (const char *pLine; row < capacity && (pLine = nextLine()) != nullptr;)
+			{
+				if (pLine == m_pLineEnd)
+					continue;
+
+				for (std::size_t slot = 0; slot < Slots<Layout>::SIZE; ++slot)
+					ppColumns[slot][row] = std::numeric_limits<double>::quiet_NaN();
+
+				std::size_t field = 0;
+				for (const char *p = pLine; p <= m_pLineEnd && field < m_Fields.size(); ++p, ++field)
+				{
+					if (m_Fields[field] >= 0)
+						p = ParseDouble(p, m_pLineEnd, ppColumns[m_Fields[field]][row]);
+
+					while (p != m_pLineEnd && *p != ',')
+						++p;
+				}
+
+				++row;
+			}
+
+			return row;
+		}
+
+		std::uint64_t bytesRead() const noexcept { return m_BytesRead; }
+
+	private:
+		static int Find(const char *pFirst, const char *pLast) noexcept
+		{
+			while (pFirst != pLast && (*pFirst == ' ' || *pFirst == '"'))
+				++pFirst;
+
+			while (pLast != pFirst && (pLast[-1] == ' ' || pLast[-1] == '"'))
+				--pLast;
+
+			if (pFirst == pLast)
+				return -1;
+
+			const char name = *pFirst++;
+			bool negative = (pFirst != pLast && *pFirst == '-');
+			pFirst += negative;
+
+			if (pFirst == pLast)
+				return -1;
+
+			int index = 0;
+			for (; pFirst != pLast; ++pFirst)
+			{
+				if (*pFirst < '0' || *pFirst > '9')
+					return -1;
+
+				index = index * 10 + (*pFirst - '0');
+			}
+
+			index = (negative ? -index : index);
+
+			for (std::size_t slot = 0; slot < Slots<Layout>::SIZE; ++slot)
+				if (Slots<Layout>::table[slot].name == name && Slots<Layout>::table[slot].index == index)
+					return static_cast<int>(slot);
+
+			return -1;
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Next line without its end of line, refills the block when the line is not complete
+		//!
+		//! \return  Start of the line, the end is m_pLineEnd; nullptr at the end of the file
+		//!
+		//====================================================================================================================================
+
+		const char* nextLine()
+		{
+			for (;;)
+			{
+				const char *pStart = m_Buffer.data() + m_Position;
+				const char *pEnd = m_Buffer.data() + m_Size;
+				const char *pNewLine = static_cast<const char*>(std::memchr(pStart, '\n', pEnd - pStart));
+
+				if (pNewLine || (m_EndOfFile && pStart != pEnd))
+				{
+					m_pLineEnd = (pNewLine ? pNewLine : pEnd);
+					m_Position = static_cast<std::size_t>(m_pLineEnd - m_Buffer.data()) + (pNewLine != nullptr);
+
+					if (m_pLineEnd != pStart && m_pLineEnd[-1] == '\r')
+						--m_pLineEnd;
+
+					return pStart;
+				}
+
+				if (m_EndOfFile)
+					return nullptr;
+
+				refill();
+			}
+		}
+
+		void refill()
+		{
+			std::memmove(m_Buffer.data(), m_Buffer.data() + m_Position, m_Size - m_Position);
+			m_Size -= m_Position;
+			m_Position = 0;
+
+			if (m_Size == m_Buffer.size())
+				m_Buffer.resize(2 * m_Buffer.size());
+
+			const std::size_t read = m_File.read(m_Buffer.data() + m_Size, m_Buffer.size() - m_Size);
+			m_Size += read;
+			m_BytesRead += read;
+			m_EndOfFile = (read == 0);
+		}
+
+		File m_File;
+		std::vector<char> m_Buffer;
+		std::size_t m_Position = 0;
+		std::size_t m_Size = 0;
+		bool m_EndOfFile = false;
+		const char *m_pLineEnd = nullptr;
+		std::vector<int> m_Fields;
+		std::uint64_t m_BytesRead = 0;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Header line of the output, the quoted text of every expression
+	//!
+	//====================================================================================================================================
+
+	template<typename Exprs>
+	struct CsvHeader;
+
+	template<typename... Exprs>
+	struct CsvHeader<TypeList<Exprs...>>
+	{
+		static std::string text()
+		{
+			std::string line;
+			Printing::StringSink sink(line);
+
+			((sink.append(line.empty() ? "\"" : ",\""), Printing::Append<Exprs>(sink), sink.append("\"")), ...);
+
+			line += '\n';
+			return line;
+		}
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Evaluates the expressions for every row of a CSV file and writes a CSV file with one column per expression, headed
+	//!			 by the text of the expression. A reader thread parses the next chunk while this one is calculated, so the memory
+	//!			 is two chunks of input, one of results and the blocks of the files
+	//!
+	//! \param   pInput     CSV file, the header names the variables of Layout, see CsvReader
+	//! \param   pOutput    CSV file to create
+	//! \param   chunkRows  Rows per chunk
+	//!
+	//! \return  Rows, bytes and time
+	//!
+	//! \throw   std::system_error, std::runtime_error, std::invalid_argument if the header does not match the layout or chunkRows is 0,
+	//!			 std::overflow_error if any division by zero occurred, the output is complete anyway
+	//!
+	//====================================================================================================================================
+
+	template<typename Exprs, typename Layout = VariablesOfAllResult<Exprs>>
+	Statistics EvaluateCsv(const char *pInput, const char *pOutput, std::size_t chunkRows = CHUNK_ROWS)
+	{
+		constexpr std::size_t COLUMNS = Slots<Layout>::SIZE;
+
+		if (!chunkRows)
+			throw std::invalid_argument("Chunk without rows");
+
+		const auto start = std::chrono::steady_clock::now();
+
+		CsvReader<Layout> reader(pInput);
+		File output(pOutput, "wb");
+
+		struct Chunk
+		{
+			std::vector<double> values;
+			std::array<double*, COLUMNS> columns;
+			std::size_t rows = 0;
+		};
+
+		Chunk chunks[2];
+		for (auto &rChunk : chunks)
+		{
+			rChunk.values.resize(COLUMNS * chunkRows);
+			for (std::size_t k = 0; k < COLUMNS; ++k)
+				rChunk.columns[k] = rChunk.values.data() + k * chunkRows;
+		}
+
+		// chunks[i % 2] is parsed when i < parsed and calculated when i < calculated
+		std::mutex mutex;
+		std::condition_variable changed;
+		std::size_t parsed = 0;
+		std::size_t calculated = 0;
+		bool finished = false;
+		bool cancelled = false;
+		std::exception_ptr error;
+
+		std::thread parser([&]
+		{
+			try
+			{
+				for (std::size_t i = 0;; ++i)
+				{
+					{
+						std::unique_lock<std::mutex> lock(mutex);
+						changed.wait(lock, [&] { return cancelled || i < calculated + 2; });
+						if (cancelled)
+							return;
+					}
+
+					Chunk &rChunk = chunks[i % 2];
+					rChunk.rows = reader.read(rChunk.columns.data(), chunkRows);
+
+					std::lock_guard<std::mutex> lock(mutex);
+					++parsed;
+					finished = (rChunk.rows < chunkRows);
+					changed.notify_all();
+
+					if (finished)
+						return;
+				}
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				error = std::current_exception();
+				finished = true;
+				changed.notify_all();
+			}
+		});
+
+		Statistics statistics;
+
+		try
+		{
+			const std::string header = CsvHeader<Exprs>::text();
+			output.write(header.data(), header.size());
+
+			std::vector<double> results(Exprs::size * chunkRows);
+			std::array<double*, Exprs::size> resultColumns;
+			for (std::size_t k = 0; k < Exprs::size; ++k)
+				resultColumns[k] = results.data() + k * chunkRows;
+
+			std::vector<char> text;
+			ErrorPolicy::Sticky policy;
+
+			for (std::size_t i = 0;; ++i)
+			{
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					changed.wait(lock, [&] { return i < parsed || error || (finished && i == parsed); });
+
+					if (error)
+						std::rethrow_exception(error);
+
+					if (i == parsed)
+						break;
+				}
+
+				const Chunk &rChunk = chunks[i % 2];
+
+				ChunkColumns<Layout> columns;
+				for (std::size_t k = 0; k < COLUMNS; ++k)
+					columns.columns[k] = rChunk.columns[k];
+
+				Parallel::Outputs<Exprs>::calc(columns, resultColumns.data(), 0, rChunk.rows, policy);
+				const std::size_t rows = rChunk.rows;
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					++calculated;
+					changed.notify_all();
+				}
+
+				text.resize(rows * Exprs::size * 32);
+				char *pText = text.data();
+				for (std::size_t row = 0; row < rows; ++row)
+				{
+					for (std::size_t k = 0; k < Exprs::size; ++k)
+					{
+						pText = FormatDouble(pText, resultColumns[k][row]);
+						*pText++ = (k + 1 < Exprs::size ? ',' : '\n');
+					}
+				}
+
+				output.write(text.data(), static_cast<std::size_t>(pText - text.data()));
+				statistics.rows += rows;
+				statistics.bytesWritten += static_cast<std::uint64_t>(pText - text.data());
+			}
+
+			output.flush();
+			parser.join();
+			policy.check();
+		}
+		catch (...)
+		{
+			if (parser.joinable())
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					cancelled = true;
+					changed.notify_all();
+				}
+
+				parser.join();
+			}
+
+			throw;
+		}
+
+		statistics.bytesRead = reader.bytesRead();
+		statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		return statistics;
+	}
+
+#pragma endregion
+
+} // namespace Streaming
@@ -0,0 +1,426 @@
+#pragma once
+
+//====================================================================================================================================
+//!
+//!	\file   Symbolic.hpp
+//!
+//! \brief	Gradient, Hessian and Jacobian as matrices of simplified derivative trees, evaluated as one DAG per point
+//!
+//====================================================================================================================================
+
+#include "Dag.hpp"
+#include "Simplify.hpp"
+
+#include <array>   // std::array
+#include <tuple>   // std::tuple
+#include <utility> // std::index_sequence
+
+namespace Symbolic
+{
+
+#pragma region Derivative
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Simplified derivative of Expr by the variable node Var
+	//!
+	//! \note	The simplification keeps the trees of the second derivatives small and makes equal subtrees equal types,
+	//!			so Sharing::Forest calculates them once
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Var>
+	struct Derivative;
+
+	template<typename Expr, char NAME, int INDEX>
+	struct Derivative<Expr, Node<Variable<NAME, INDEX>>>
+	{
+		using res = Simplification::SimplifyResult<typename Expr::template der<NAME, INDEX>>;
+	};
+
+	template<typename Expr, typename Var>
+	using DerivativeResult = typename Derivative<Expr, Var>::res;
+
+#pragma endregion
+
+#pragma region Nth derivative
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Simplified derivative of the simplified tree Expr by the variable node Var, built from the derivatives of the children
+	//!
+	//! \note	Unlike Node::der every rule refers to the derivatives of the children by type, so the compiler instantiates one
+	//!			Differentiate per distinct subtree and variable however often the subtree occurs, also across orders. Every new
+	//!			node is simplified as soon as it is built, so a zero derivative never grows a product around it
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Var>
+	struct Differentiate;
+
+	template<typename Expr, typename Var>
+	using DifferentiateResult = typename Differentiate<Expr, Var>::res;
+
+	template<llong_t N, typename Var>
+	struct Differentiate<Node<Number<N>>, Var>
+	{
+		using res = Node<Number<0>>;
+	};
+
+	template<char NAME, int INDEX, typename Var>
+	struct Differentiate<Node<Variable<NAME, INDEX>>, Var>
+	{
+		using res = std::conditional_t<std::is_same_v<Node<Variable<NAME, INDEX>>, Var>, Node<Number<1>>, Node<Number<0>>>;
+	};
+
+	template<UnaryFunction UF, typename Child, typename Var>
+	struct Differentiate<Node<Wrap4UF<UF>, Child>, Var>
+	{
+		using res = Simplification::SimplifyResult<
+			Node<WrapMul, typename Wrap4UF<UF>::template der<Child>, DifferentiateResult<Child, Var>>>;
+	};
+
+	template<typename Left, typename Right, typename Var>
+	struct Differentiate<Node<WrapAdd, Left, Right>, Var>
+	{
+		using res = Simplification::SimplifyResult<Node<WrapAdd, DifferentiateResult<Left, Var>, DifferentiateResult<Right, Var>>>;
+	};
+
+	template<typename Left, typename Right, typename Var>
+	struct Differentiate<Node<WrapSub, Left, Right>, Var>
+	{
+		using res = Simplification::SimplifyResult<Node<WrapSub, DifferentiateResult<Left, Var>, DifferentiateResult<Right, Var>>>;
+	};
+
+	template<typename Left, typename Right, typename Var>
+	struct Differentiate<Node<WrapMul, Left, Right>, Var>
+	{
+		using res = Simplification::SimplifyResult<
+			Node<WrapAdd,
+			Node<WrapMul, DifferentiateResult<Left, Var>, Right>,
+			Node<WrapMul, Left, DifferentiateResult<Right, Var>>>>;
+	};
+
+	template<typename U, typename V, typename Var>
+	struct Differentiate<Node<WrapDiv, U, V>, Var>
+	{
+		using res = Simplification::SimplifyResult<
+			Node<WrapDiv,
+			Node<WrapAdd,
+			Node<WrapMul, DifferentiateResult<U, Var>, V>,
+			Node<WrapNeg,
+			Node<WrapMul, U, DifferentiateResult<V, Var>>>>,
+			Node<WrapMul, V, V>>>;
+	};
+
+	template<typename U, typename V, typename Var>
+	struct Differentiate<Node<WrapPow, U, V>, Var>
+	{
+		using res = Simplification::SimplifyResult<
+			Node<WrapMul,
+			Node<WrapPow, U, V>,
+			DifferentiateResult<Simplification::SimplifyResult<Node<WrapMul, V, Node<WrapLn, U>>>, Var>>>;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	K-th derivative of Expr by the variable node Var, every order is the Differentiate of the order below
+	//!
+	//! \note	The orders are instantiated once each, so NthDerivative<Expr, Var, K> after NthDerivative<Expr, Var, K - 1> costs one
+	//!			more order, and the subtrees the order below shares with its own derivative are not differentiated again
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Var, std::size_t K>
+	struct NthDerivative
+	{
+		using res = DifferentiateResult<typename NthDerivative<Expr, Var, K - 1>::res, Var>;
+	};
+
+	template<typename Expr, typename Var>
+	struct NthDerivative<Expr, Var, 0>
+	{
+		using res = Simplification::SimplifyResult<Expr>;
+	};
+
+	template<typename Expr, typename Var, std::size_t K>
+	using NthDerivativeResult = typename NthDerivative<Expr, Var, K>::res;
+
+#pragma endregion
+
+#pragma region Gradient
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Derivatives of Expr by every variable of Vars
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename... Vars>
+	struct Gradient
+	{
+		static constexpr std::size_t SIZE = sizeof...(Vars);
+
+		using entries = TypeList<DerivativeResult<Expr, Vars>...>;
+
+		template<std::size_t I>
+		using entry = TypeAtResult<entries, I>;
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Calculates the gradient
+		//!
+		//! \param   rValues  The same functor as for Node::calc
+		//! \param   rPolicy  What to do on division by zero, see ErrorPolicy
+		//!
+		//! \return  Derivatives in the order of Vars
+		//!
+		//! \throw   std::overflow_error by ErrorPolicy::Throwing, the default
+		//!
+		//====================================================================================================================================
+
+		template<typename Vector, typename Policy>
+		static std::array<typename Vector::value_type, SIZE> calc(const Vector &rValues, Policy &rPolicy)
+		{
+			return Sharing::Forest<entries>::calc(rValues, rPolicy);
+		}
+
+		template<typename Vector>
+		static std::array<typename Vector::value_type, SIZE> calc(const Vector &rValues)
+		{
+			ErrorPolicy::Throwing policy;
+
+			return calc(rValues, policy);
+		}
+	};
+
+#pragma endregion
+
+#pragma region Hessian
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Upper triangle of a size x size matrix stored by rows: (0, 0), (0, 1), ..., (0, size - 1), (1, 1), ...
+	//!
+	//====================================================================================================================================
+
+	constexpr std::size_t PackedIndex(std::size_t size, std::size_t row, std::size_t column) noexcept
+	{
+		return (row <= column ? row * size - row * (row - 1) / 2 + column - row : PackedIndex(size, column, row));
+	}
+
+	constexpr std::size_t PackedRow(std::size_t size, std::size_t packed) noexcept
+	{
+		std::size_t row = 0;
+		while (packed >= size - row)
+			packed -= size - row++;
+
+		return row;
+	}
+
+	constexpr std::size_t PackedColumn(std::size_t size, std::size_t packed) noexcept
+	{
+		return packed - PackedIndex(size, PackedRow(size, packed), PackedRow(size, packed)) + PackedRow(size, packed);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Value, gradient and Hessian of the expression at one point
+	//!
+	//====================================================================================================================================
+
+	template<typename T, std::size_t N>
+	struct SecondOrder
+	{
+		T value;
+		std::array<T, N> gradient;
+		std::array<std::array<T, N>, N> hessian;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Second derivatives of Expr by every pair of Vars
+	//!
+	//! \note	Only the upper triangle is generated: entry<I, J> and entry<J, I> are the same type, the derivative of the already
+	//!			simplified gradient entry min(I, J) by the variable max(I, J), so no first derivative is generated twice
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename... Vars>
+	struct Hessian
+	{
+		static constexpr std::size_t SIZE = sizeof...(Vars);
+
+		using gradient = Gradient<Expr, Vars...>;
+
+		//====================================================================================================================================
+		//!
+		//! \brief	Number of entries of the upper triangle
+		//!
+		//====================================================================================================================================
+
+		static constexpr std::size_t PACKED = SIZE * (SIZE + 1) / 2;
+
+		template<std::size_t I, std::size_t J>
+		using entry = DerivativeResult<typename gradient::template entry<(I < J ? I : J)>, TypeAtResult<TypeList<Vars...>, (I < J ? J : I)>>;
+
+	private:
+		template<typename Sequence>
+		struct Entries;
+
+		template<std::size_t... Ks>
+		struct Entries<std::index_sequence<Ks...>>
+		{
+			using res = TypeList<entry<PackedRow(SIZE, Ks), PackedColumn(SIZE, Ks)>...>;
+		};
+
+		template<typename T, std::size_t OFFSET, std::size_t... Ks>
+		static void Scatter(const T *pPacked, std::array<std::array<T, SIZE>, SIZE> &rMatrix, std::index_sequence<Ks...>) noexcept
+		{
+			((rMatrix[PackedRow(SIZE, Ks)][PackedColumn(SIZE, Ks)] = rMatrix[PackedColumn(SIZE, Ks)][PackedRow(SIZE, Ks)] = pPacked[OFFSET + Ks]), ...);
+		}
+
+	public:
+		using entries = typename Entries<std::make_index_sequence<PACKED>>::res;
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Calculates the Hessian, the upper triangle is calculated as one DAG and mirrored
+		//!
+		//! \param   rValues  The same functor as for Node::calc
+		//! \param   rPolicy  What to do on division by zero, see ErrorPolicy
+		//!
+		//! \return  Symmetric matrix, [i][j] is the derivative by the i-th and the j-th variable of Vars
+		//!
+		//! \throw   std::overflow_error by ErrorPolicy::Throwing, the default
+		//!
+		//====================================================================================================================================
+
+		template<typename Vector, typename Policy>
+		static std::array<std::array<typename Vector::value_type, SIZE>, SIZE> calc(const Vector &rValues, Policy &rPolicy)
+		{
+			const auto packed = Sharing::Forest<entries>::calc(rValues, rPolicy);
+
+			std::array<std::array<typename Vector::value_type, SIZE>, SIZE> result;
+			Scatter<typename Vector::value_type, 0>(packed.data(), result, std::make_index_sequence<PACKED>{ });
+
+			return result;
+		}
+
+		template<typename Vector>
+		static std::array<std::array<typename Vector::value_type, SIZE>, SIZE> calc(const Vector &rValues)
+		{
+			ErrorPolicy::Throwing policy;
+
+			return calc(rValues, policy);
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Calculates value, gradient and Hessian in one pass: the expression, the gradient and the upper triangle are
+		//!			 one DAG, so every subtree shared between them is calculated once
+		//!
+		//! \param   rValues  The same functor as for Node::calc
+		//! \param   rPolicy  What to do on division by zero, see ErrorPolicy
+		//!
+		//! \throw   std::overflow_error by ErrorPolicy::Throwing, the default
+		//!
+		//====================================================================================================================================
+
+		template<typename Vector, typename Policy>
+		static SecondOrder<typename Vector::value_type, SIZE> calcAll(const Vector &rValues, Policy &rPolicy)
+		{
+			using value_type = typename Vector::value_type;
+
+			const auto all = Sharing::Forest<JoinResult<TypeList<Expr>, typename gradient::entries, entries>>::calc(rValues, rPolicy);
+
+			SecondOrder<value_type, SIZE> result;
+			result.value = all[0];
+			for (std::size_t i = 0; i < SIZE; ++i)
+				result.gradient[i] = all[1 + i];
+
+			Scatter<value_type, 1 + SIZE>(all.data(), result.hessian, std::make_index_sequence<PACKED>{ });
+
+			return result;
+		}
+
+		template<typename Vector>
+		static SecondOrder<typename Vector::value_type, SIZE> calcAll(const Vector &rValues)
+		{
+			ErrorPolicy::Throwing policy;
+
+			return calcAll(rValues, policy);
+		}
+	};
+
+#pragma endregion
+
+#pragma region Jacobian
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Derivatives of every expression of the tuple by every variable of Vars
+	//!
+	//====================================================================================================================================
+
+	template<typename Exprs, typename... Vars>
+	struct Jacobian;
+
+	template<typename... Exprs, typename... Vars>
+	struct Jacobian<std::tuple<Exprs...>, Vars...>
+	{
+		static constexpr std::size_t ROWS = sizeof...(Exprs);
+		static constexpr std::size_t COLUMNS = sizeof...(Vars);
+
+		template<std::size_t K>
+		using row = Gradient<std::tuple_element_t<K, std::tuple<Exprs...>>, Vars...>;
+
+		template<std::size_t K, std::size_t I>
+		using entry = typename row<K>::template entry<I>;
+
+		//====================================================================================================================================
+		//!
+		//! \brief	Entries by rows
+		//!
+		//====================================================================================================================================
+
+		using entries = JoinResult<typename Gradient<Exprs, Vars...>::entries...>;
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Calculates the Jacobian, every row is calculated in the same DAG
+		//!
+		//! \param   rValues  The same functor as for Node::calc
+		//! \param   rPolicy  What to do on division by zero, see ErrorPolicy
+		//!
+		//! \return  Matrix, [k][i] is the derivative of the k-th expression by the i-th variable of Vars
+		//!
+		//! \throw   std::overflow_error by ErrorPolicy::Throwing, the default
+		//!
+		//====================================================================================================================================
+
+		template<typename Vector, typename Policy>
+		static std::array<std::array<typename Vector::value_type, COLUMNS>, ROWS> calc(const Vector &rValues, Policy &rPolicy)
+		{
+			const auto all = Sharing::Forest<entries>::calc(rValues, rPolicy);
+
+			std::array<std::array<typename Vector::value_type, COLUMNS>, ROWS> result;
+			for (std::size_t k = 0; k < ROWS; ++k)
+				for (std::size_t i = 0; i < COLUMNS; ++i)
+					result[k][i] = all[k * COLUMNS + i];
+
+			return result;
+		}
+
+		template<typename Vector>
+		static std::array<std::array<typename Vector::value_type, COLUMNS>, ROWS> calc(const Vector &rValues)
+		{
+			ErrorPolicy::Throwing policy;
+
+			return calc(rValues, policy);
+		}
+	};
+
+#pragma endregion
+
+} // namespace Symbolic
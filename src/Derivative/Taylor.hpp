@@ -0,0 +1,416 @@
+#pragma once
+
+//====================================================================================================================================
+//!
+//!	\file   Taylor.hpp
+//!
+//! \brief	Truncated Taylor polynomial of an expression by one variable, evaluated by Horner's scheme with a bound of the error
+//!
+//====================================================================================================================================
+
+#include "Batch.hpp"
+#include "Symbolic.hpp"
+
+#include <algorithm> // std::min, std::max
+#include <array>     // std::array
+#include <cmath>     // std::sin, std::log, std::exp, std::floor, std::ceil, std::isnan
+#include <limits>    // std::numeric_limits
+
+namespace Approximation
+{
+
+#pragma region Interval arithmetic
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Closed interval of doubles, the whole line if nothing better is known
+	//!
+	//! \note	Endpoints are rounded to nearest, not outward, so the enclosure is exact up to a few ulps
+	//!
+	//====================================================================================================================================
+
+	struct Interval
+	{
+		double lower;
+		double upper;
+
+		static constexpr Interval whole() noexcept { return { -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity() }; }
+
+		constexpr double magnitude() const noexcept { return std::max(-lower, upper); }
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Smallest interval with the four values, the whole line if any of them is NaN (0 * inf and the like)
+	//!
+	//====================================================================================================================================
+
+	inline Interval Hull(double a, double b, double c, double d) noexcept
+	{
+		if (std::isnan(a) || std::isnan(b) || std::isnan(c) || std::isnan(d))
+			return Interval::whole();
+
+		return { std::min(std::min(a, b), std::min(c, d)), std::max(std::max(a, b), std::max(c, d)) };
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Range of the unary function over the interval
+	//!
+	//====================================================================================================================================
+
+	template<UnaryFunction UF>
+	struct UnaryRange;
+
+	template<>
+	struct UnaryRange<UnaryFunction::SIN>
+	{
+		static Interval calc(Interval arg) noexcept
+		{
+			constexpr double PI = 3.14159265358979323846;
+
+			if (!(arg.upper - arg.lower < 2 * PI))
+				return { -1, 1 };
+
+			Interval result = Hull(std::sin(arg.lower), std::sin(arg.upper), std::sin(arg.lower), std::sin(arg.upper));
+
+			// the extrema are at PI / 2 + 2 PI k and -PI / 2 + 2 PI k
+			if (std::ceil((arg.lower - PI / 2) / (2 * PI)) * 2 * PI + PI / 2 <= arg.upper)
+				result.upper = 1;
+
+			if (std::ceil((arg.lower + PI / 2) / (2 * PI)) * 2 * PI - PI / 2 <= arg.upper)
+				result.lower = -1;
+
+			return result;
+		}
+	};
+
+	template<>
+	struct UnaryRange<UnaryFunction::COS>
+	{
+		static Interval calc(Interval arg) noexcept
+		{
+			constexpr double PI = 3.14159265358979323846;
+
+			return UnaryRange<UnaryFunction::SIN>::calc({ arg.lower + PI / 2, arg.upper + PI / 2 });
+		}
+	};
+
+	template<>
+	struct UnaryRange<UnaryFunction::LG>
+	{
+		static Interval calc(Interval arg) noexcept
+		{
+			return (arg.lower > 0 ? Interval{ std::log10(arg.lower), std::log10(arg.upper) } : Interval::whole());
+		}
+	};
+
+	template<>
+	struct UnaryRange<UnaryFunction::LN>
+	{
+		static Interval calc(Interval arg) noexcept
+		{
+			return (arg.lower > 0 ? Interval{ std::log(arg.lower), std::log(arg.upper) } : Interval::whole());
+		}
+	};
+
+	template<>
+	struct UnaryRange<UnaryFunction::NEG>
+	{
+		static Interval calc(Interval arg) noexcept { return { -arg.upper, -arg.lower }; }
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Range of the binary function over the intervals
+	//!
+	//====================================================================================================================================
+
+	template<BinaryFunction BF>
+	struct BinaryRange;
+
+	template<>
+	struct BinaryRange<BinaryFunction::ADD>
+	{
+		static Interval calc(Interval left, Interval right) noexcept { return Hull(left.lower + right.lower, left.upper + right.upper, left.lower + right.lower, left.upper + right.upper); }
+	};
+
+	template<>
+	struct BinaryRange<BinaryFunction::SUB>
+	{
+		static Interval calc(Interval left, Interval right) noexcept { return Hull(left.lower - right.upper, left.upper - right.lower, left.lower - right.upper, left.upper - right.lower); }
+	};
+
+	template<>
+	struct BinaryRange<BinaryFunction::MUL>
+	{
+		static Interval calc(Interval left, Interval right) noexcept
+		{
+			return Hull(left.lower * right.lower, left.lower * right.upper, left.upper * right.lower, left.upper * right.upper);
+		}
+	};
+
+	template<>
+	struct BinaryRange<BinaryFunction::DIV>
+	{
+		static Interval calc(Interval left, Interval right) noexcept
+		{
+			if (right.lower <= 0 && right.upper >= 0)
+				return Interval::whole();
+
+			return BinaryRange<BinaryFunction::MUL>::calc(left, { 1 / right.upper, 1 / right.lower });
+		}
+	};
+
+	template<>
+	struct BinaryRange<BinaryFunction::POW>
+	{
+		static Interval calc(Interval left, Interval right) noexcept
+		{
+			// integer exponent, the usual case after differentiation of x ^ n
+			if (right.lower == right.upper && right.lower == std::floor(right.lower) && std::abs(right.lower) < 64)
+			{
+				const double exponent = right.lower;
+				if (exponent < 0)
+					return BinaryRange<BinaryFunction::DIV>::calc({ 1, 1 }, calc(left, { -exponent, -exponent }));
+
+				const double lower = std::pow(left.lower, exponent);
+				const double upper = std::pow(left.upper, exponent);
+
+				if (static_cast<long long>(exponent) % 2 == 1 || left.lower >= 0)
+					return Hull(lower, upper, lower, upper);
+
+				// even power of an interval with 0 inside or below 0
+				return (left.upper <= 0 ? Hull(lower, upper, lower, upper) : Interval{ 0, std::max(lower, upper) });
+			}
+
+			if (left.lower <= 0)
+				return Interval::whole();
+
+			// x ^ y = exp(y * ln(x)) and exp is monotonic
+			const Interval exponent = BinaryRange<BinaryFunction::MUL>::calc(UnaryRange<UnaryFunction::LN>::calc(left), right);
+
+			return { std::exp(exponent.lower), std::exp(exponent.upper) };
+		}
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Enclosure of the values of the node when every variable is in its interval
+	//!
+	//! \note	rIntervals(Node<Variable<NAME, INDEX>>{ }) must return the interval of the variable
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	struct Range;
+
+	template<llong_t N>
+	struct Range<Node<Number<N>>>
+	{
+		template<typename Intervals>
+		static Interval calc(const Intervals&) noexcept { return { static_cast<double>(N), static_cast<double>(N) }; }
+	};
+
+	template<char NAME, int INDEX>
+	struct Range<Node<Variable<NAME, INDEX>>>
+	{
+		template<typename Intervals>
+		static Interval calc(const Intervals &rIntervals) noexcept { return rIntervals(Node<Variable<NAME, INDEX>>{ }); }
+	};
+
+	template<UnaryFunction UF, typename Child>
+	struct Range<Node<Wrap4UF<UF>, Child>>
+	{
+		template<typename Intervals>
+		static Interval calc(const Intervals &rIntervals) noexcept { return UnaryRange<UF>::calc(Range<Child>::calc(rIntervals)); }
+	};
+
+	template<BinaryFunction BF, typename Left, typename Right>
+	struct Range<Node<Wrap4BF<BF>, Left, Right>>
+	{
+		template<typename Intervals>
+		static Interval calc(const Intervals &rIntervals) noexcept
+		{
+			return BinaryRange<BF>::calc(Range<Left>::calc(rIntervals), Range<Right>::calc(rIntervals));
+		}
+	};
+
+#pragma endregion
+
+#pragma region Derivatives
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Expr and its derivatives by Var up to order K, every order is simplified before the next one is taken
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Var, std::size_t K, typename Found = TypeList<Expr>>
+	struct Derivatives
+	{
+		using res = typename Derivatives<Symbolic::DerivativeResult<Expr, Var>, Var, K - 1, JoinResult<Found, TypeList<Symbolic::DerivativeResult<Expr, Var>>>>::res;
+	};
+
+	template<typename Expr, typename Var, typename Found>
+	struct Derivatives<Expr, Var, 0, Found>
+	{
+		using res = Found;
+	};
+
+	template<typename Expr, typename Var, std::size_t K>
+	using DerivativesResult = typename Derivatives<Expr, Var, K>::res;
+
+#pragma endregion
+
+#pragma region Taylor polynomial
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Taylor polynomial of order ORDER of Expr by the variable Var around a point
+	//!
+	//! \note	The derivatives are generated at compile time. Their values and the bound of the remainder need std::sin and
+	//!			friends, which are not constexpr, so they are calculated by the constructor, once at startup
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Var, std::size_t ORDER>
+	class Taylor
+	{
+	public:
+		//====================================================================================================================================
+		//!
+		//! \brief	Expr, its derivatives up to ORDER and the derivative of order ORDER + 1 for the remainder
+		//!
+		//====================================================================================================================================
+
+		using derivatives = DerivativesResult<Expr, Var, ORDER + 1>;
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Expands the expression around the point
+		//!
+		//! \param   rPoint  The same functor as for Node::calc: the center of Var and the fixed values of the other variables
+		//! \param   radius  Half-width of the interval of Var where the error is bounded
+		//!
+		//! \throw   std::overflow_error on division by zero in a derivative at the center
+		//!
+		//====================================================================================================================================
+
+		template<typename Vector>
+		Taylor(const Vector &rPoint, double radius) :
+			m_Center(rPoint(Var{ })),
+			m_Radius(radius)
+		{
+			const auto values = Sharing::Forest<derivatives>::calc(rPoint);
+
+			double factorial = 1;
+			for (std::size_t k = 0; k <= ORDER; ++k)
+			{
+				factorial *= (k ? static_cast<double>(k) : 1.0);
+				m_Coefficients[k] = values[k] / factorial;
+			}
+
+			// Lagrange remainder: |f(x) - P(x)| <= max |f^(ORDER + 1)| * radius ^ (ORDER + 1) / (ORDER + 1)!
+			const auto box = [&rPoint, radius](auto var)
+			{
+				const double value = rPoint(var);
+				const double width = (std::is_same_v<decltype(var), Var> ? radius : 0.0);
+
+				return Interval{ value - width, value + width };
+			};
+
+			m_ErrorBound = Range<TypeAtResult<derivatives, ORDER + 1>>::calc(box).magnitude() * std::pow(radius, ORDER + 1) / (factorial * (ORDER + 1));
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Calculates the polynomial by Horner's scheme
+		//!
+		//! \param   x  Value of Var, the error bound holds for |x - center()| <= radius()
+		//!
+		//====================================================================================================================================
+
+		double calc(double x) const noexcept
+		{
+			const double h = x - m_Center;
+
+			double result = m_Coefficients[ORDER];
+			for (std::size_t k = 1; k <= ORDER; ++k)
+				result = result * h + m_Coefficients[ORDER - k];
+
+			return result;
+		}
+
+		template<typename Vector>
+		double calc(const Vector &rValues) const noexcept
+		{
+			return calc(rValues(Var{ }));
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Calculates the polynomial for count values of Var
+		//!
+		//! \param   pX       Values of Var
+		//! \param   pResult  Output, at least count values
+		//! \param   count    Number of values
+		//!
+		//====================================================================================================================================
+
+		void calcBatch(const double *pX, double *pResult, std::size_t count) const noexcept
+		{
+			const std::size_t full = count - count % Batching::Simd::WIDTH;
+
+			for (std::size_t i = 0; i < full; i += Batching::Simd::WIDTH)
+				Batching::Simd::store(pResult + i, horner<Batching::Simd>(Batching::Simd::load(pX + i)));
+
+			for (std::size_t i = full; i < count; ++i)
+				pResult[i] = calc(pX[i]);
+		}
+
+		double center() const noexcept { return m_Center; }
+		double radius() const noexcept { return m_Radius; }
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Bound of |Expr - polynomial| on [center() - radius(), center() + radius()], infinity if the derivative of order
+		//!			 ORDER + 1 is unbounded there, e.g. because of a logarithm or a division which may reach 0
+		//!
+		//! \note	 An estimate, not a guarantee: the interval endpoints are rounded to nearest and the rounding of calc itself is not
+		//!			 counted, so an error within a few ulps of the bound may exceed it
+		//!
+		//====================================================================================================================================
+
+		double errorBound() const noexcept { return m_ErrorBound; }
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Coefficients of (x - center()) ^ k, k = 0 .. ORDER
+		//!
+		//====================================================================================================================================
+
+		const std::array<double, ORDER + 1>& coefficients() const noexcept { return m_Coefficients; }
+
+	private:
+		template<typename Pack>
+		typename Pack::reg horner(typename Pack::reg x) const noexcept
+		{
+			const auto h = Pack::sub(x, Pack::broadcast(m_Center));
+
+			auto result = Pack::broadcast(m_Coefficients[ORDER]);
+			for (std::size_t k = 1; k <= ORDER; ++k)
+				result = Pack::add(Pack::mul(result, h), Pack::broadcast(m_Coefficients[ORDER - k]));
+
+			return result;
+		}
+
+		double m_Center;
+		double m_Radius;
+		double m_ErrorBound;
+		std::array<double, ORDER + 1> m_Coefficients;
+	};
+
+#pragma endregion
+
+} // namespace Approximation
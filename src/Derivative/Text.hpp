@@ -0,0 +1,339 @@
+#pragma once
+
+//====================================================================================================================================
+//!
+//!	\file   Text.hpp
+//!
+//! \brief	Compile-time strings and writers which append text without heap allocations
+//!
+//====================================================================================================================================
+
+#include "Functions.hpp"
+
+#include <cstddef>     // std::size_t
+#include <ostream>     // std::ostream
+#include <string>      // std::string
+#include <string_view> // std::string_view
+
+namespace Printing
+{
+
+#pragma region Compile-time strings
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Fixed-size character array with terminating zero, built and concatenated in constant expressions
+	//!
+	//====================================================================================================================================
+
+	template<std::size_t N>
+	struct ConstString
+	{
+		char data[N + 1];
+
+		static constexpr std::size_t size = N;
+
+		constexpr std::string_view view() const noexcept { return { data, N }; }
+		constexpr const char* c_str() const noexcept { return data; }
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Copies N characters of the view into the compile-time string
+	//!
+	//====================================================================================================================================
+
+	template<std::size_t N>
+	constexpr ConstString<N> FromView(std::string_view text) noexcept
+	{
+		ConstString<N> result{ };
+		for (std::size_t i = 0; i < N; ++i)
+			result.data[i] = text[i];
+
+		return result;
+	}
+
+	template<std::size_t N>
+	constexpr ConstString<N - 1> Literal(const char (&rText)[N]) noexcept
+	{
+		return FromView<N - 1>({ rText, N - 1 });
+	}
+
+	template<std::size_t N>
+	constexpr void CopyInto(char *pTarget, std::size_t &rPosition, const ConstString<N> &rPart) noexcept
+	{
+		for (std::size_t i = 0; i < N; ++i)
+			pTarget[rPosition++] = rPart.data[i];
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Concatenates compile-time strings
+	//!
+	//====================================================================================================================================
+
+	template<std::size_t... Ns>
+	constexpr ConstString<(Ns + ... + 0)> Concat(const ConstString<Ns>&... rParts) noexcept
+	{
+		ConstString<(Ns + ... + 0)> result{ };
+		std::size_t position = 0;
+
+		(CopyInto(result.data, position, rParts), ...);
+
+		return result;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Number of characters of the decimal integer, including the sign
+	//!
+	//====================================================================================================================================
+
+	constexpr std::size_t DigitCount(long long value) noexcept
+	{
+		unsigned long long magnitude = (value < 0 ? 0ull - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value));
+
+		std::size_t count = (value < 0 ? 1 : 0);
+		do
+		{
+			++count;
+			magnitude /= 10;
+		} while (magnitude);
+
+		return count;
+	}
+
+	template<long long VALUE>
+	constexpr ConstString<DigitCount(VALUE)> IntegerText() noexcept
+	{
+		ConstString<DigitCount(VALUE)> result{ };
+
+		unsigned long long magnitude = (VALUE < 0 ? 0ull - static_cast<unsigned long long>(VALUE) : static_cast<unsigned long long>(VALUE));
+		for (std::size_t i = DigitCount(VALUE); i-- > (VALUE < 0 ? 1u : 0u); magnitude /= 10)
+			result.data[i] = static_cast<char>('0' + magnitude % 10);
+
+		if (VALUE < 0)
+			result.data[0] = '-';
+
+		return result;
+	}
+
+	template<UnaryFunction UF>
+	constexpr auto FunctionText() noexcept { return FromView<GetFunctionName(UF).size()>(GetFunctionName(UF)); }
+
+	template<BinaryFunction BF>
+	constexpr auto FunctionText() noexcept { return FromView<GetFunctionName(BF).size()>(GetFunctionName(BF)); }
+
+	template<UnaryFunction UF>
+	constexpr auto FunctionTeX() noexcept { return FromView<GetFunctionTeX(UF).size()>(GetFunctionTeX(UF)); }
+
+	template<BinaryFunction BF>
+	constexpr auto FunctionTeX() noexcept { return FromView<GetFunctionTeX(BF).size()>(GetFunctionTeX(BF)); }
+
+#pragma endregion
+
+#pragma region Text of expressions
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Text of the expression in the format of Node::dump as ConstString value, specialized for Node in Differentiation.hpp
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	struct Text;
+
+	//====================================================================================================================================
+	//!
+	//! \brief	TeX of the expression without enclosing '$' as ConstString value, specialized for Node in Differentiation.hpp
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	struct TeX;
+
+#pragma endregion
+
+#pragma region Sinks
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Writes into the buffer of the caller like snprintf: the text is cut to the capacity, length() is the full length
+	//!
+	//====================================================================================================================================
+
+	class BufferSink
+	{
+	public:
+		BufferSink(char *pBuffer, std::size_t capacity) noexcept :
+			m_pBuffer(pBuffer),
+			m_Capacity(capacity)
+		{
+			if (m_Capacity)
+				*m_pBuffer = '\0';
+		}
+
+		void append(std::string_view text) noexcept
+		{
+			if (m_Length + 1 < m_Capacity)
+			{
+				const std::size_t count = (text.size() < m_Capacity - 1 - m_Length ? text.size() : m_Capacity - 1 - m_Length);
+				text.copy(m_pBuffer + m_Length, count);
+				m_pBuffer[m_Length + count] = '\0';
+			}
+
+			m_Length += text.size();
+		}
+
+		std::size_t length() const noexcept { return m_Length; }
+		bool truncated() const noexcept { return (m_Length >= m_Capacity); }
+
+	private:
+		char *m_pBuffer;
+		std::size_t m_Capacity;
+		std::size_t m_Length = 0;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Writes into the stream
+	//!
+	//====================================================================================================================================
+
+	class StreamSink
+	{
+	public:
+		explicit StreamSink(std::ostream &rStream) noexcept :
+			m_rStream(rStream)
+		{
+		}
+
+		void append(std::string_view text) { m_rStream.write(text.data(), static_cast<std::streamsize>(text.size())); }
+
+	private:
+		std::ostream &m_rStream;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Appends to the string, allocates only when the string grows
+	//!
+	//====================================================================================================================================
+
+	class StringSink
+	{
+	public:
+		explicit StringSink(std::string &rString) noexcept :
+			m_rString(rString)
+		{
+		}
+
+		void append(std::string_view text) { m_rString.append(text.data(), text.size()); }
+
+	private:
+		std::string &m_rString;
+	};
+
+#pragma endregion
+
+#pragma region Writers
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Appends the text of the expression to the sink, the text is a constant of the program
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Sink>
+	void Append(Sink &rSink)
+	{
+		rSink.append(Text<Expr>::value.view());
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Writes the text of the expression into the buffer, the result is always zero-terminated if capacity is not 0
+	//!
+	//! \return  Length of the whole text, the buffer was too small if it is not less than capacity
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr>
+	std::size_t Write(char *pBuffer, std::size_t capacity) noexcept
+	{
+		BufferSink sink(pBuffer, capacity);
+		Append<Expr>(sink);
+
+		return sink.length();
+	}
+
+	template<typename Expr>
+	std::ostream& Write(std::ostream &rStream)
+	{
+		StreamSink sink(rStream);
+		Append<Expr>(sink);
+
+		return rStream;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Text of the expression as std::string, the only allocation is the result
+	//!
+	//! \throw   std::bad_alloc
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr>
+	std::string ToString()
+	{
+		return std::string(Text<Expr>::value.view());
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 The same for TeX, enclosed in '$'
+	//!
+	//====================================================================================================================================
+
+	template<typename Expr, typename Sink>
+	void AppendTeX(Sink &rSink)
+	{
+		rSink.append("$");
+		rSink.append(TeX<Expr>::value.view());
+		rSink.append("$");
+	}
+
+	template<typename Expr>
+	std::size_t WriteTeX(char *pBuffer, std::size_t capacity) noexcept
+	{
+		BufferSink sink(pBuffer, capacity);
+		AppendTeX<Expr>(sink);
+
+		return sink.length();
+	}
+
+	template<typename Expr>
+	std::ostream& WriteTeX(std::ostream &rStream)
+	{
+		StreamSink sink(rStream);
+		AppendTeX<Expr>(sink);
+
+		return rStream;
+	}
+
+	template<typename Expr>
+	std::string ToTeX()
+	{
+		std::string result;
+		result.reserve(TeX<Expr>::value.size + 2);
+
+		StringSink sink(result);
+		AppendTeX<Expr>(sink);
+
+		return result;
+	}
+
+#pragma endregion
+
+} // namespace Printing
@@ -0,0 +1,151 @@
+#pragma once
+
+//====================================================================================================================================
+//!
+//!	\file   TypeList.hpp
+//!
+//! \brief	Minimal compile-time list of types
+//!
+//====================================================================================================================================
+
+#include <cstddef>     // std::size_t
+#include <type_traits> // std::true_type, std::false_type, std::conditional_t
+
+template<typename... Types>
+struct TypeList
+{
+	static constexpr std::size_t size = sizeof...(Types);
+};
+
+#pragma region Contains
+
+//====================================================================================================================================
+//!
+//! \brief	Checks is type T in the list
+//!
+//====================================================================================================================================
+
+template<typename List, typename T>
+struct Contains;
+
+template<typename... Types, typename T>
+struct Contains<TypeList<Types...>, T> : std::bool_constant<(std::is_same_v<Types, T> || ...)> { };
+
+#pragma endregion
+
+#pragma region IndexOf
+
+//====================================================================================================================================
+//!
+//! \brief	Position of the first occurrence of type T in the list
+//!
+//====================================================================================================================================
+
+template<typename List, typename T>
+struct IndexOf;
+
+template<typename... Types, typename T>
+struct IndexOf<TypeList<Types...>, T>
+{
+	// one instantiation per lookup instead of one per skipped element, the lists of the DAG have hundreds of nodes
+	static constexpr std::size_t find() noexcept
+	{
+		constexpr bool MATCHES[] = { std::is_same_v<Types, T>..., true };
+
+		std::size_t i = 0;
+		while (!MATCHES[i])
+			++i;
+
+		return i;
+	}
+
+	static constexpr std::size_t value = find();
+
+	static_assert(value < sizeof...(Types), "Type is not in the list");
+};
+
+template<typename List, typename T>
+constexpr std::size_t IndexOfValue = IndexOf<List, T>::value;
+
+#pragma endregion
+
+#pragma region PushBackUnique
+
+//====================================================================================================================================
+//!
+//! \brief	Appends type T to the list if it is not in the list yet
+//!
+//====================================================================================================================================
+
+template<typename List, typename T>
+struct PushBackUnique;
+
+template<typename... Types, typename T>
+struct PushBackUnique<TypeList<Types...>, T>
+{
+	using res = std::conditional_t<Contains<TypeList<Types...>, T>::value, TypeList<Types...>, TypeList<Types..., T>>;
+};
+
+template<typename List, typename T>
+using PushBackUniqueResult = typename PushBackUnique<List, T>::res;
+
+#pragma endregion
+
+#pragma region TypeAt
+
+//====================================================================================================================================
+//!
+//! \brief	Type at position I of the list
+//!
+//====================================================================================================================================
+
+template<typename List, std::size_t I>
+struct TypeAt;
+
+template<typename Head, typename... Tail>
+struct TypeAt<TypeList<Head, Tail...>, 0>
+{
+	using res = Head;
+};
+
+template<typename Head, typename... Tail, std::size_t I>
+struct TypeAt<TypeList<Head, Tail...>, I>
+{
+	using res = typename TypeAt<TypeList<Tail...>, I - 1>::res;
+};
+
+template<typename List, std::size_t I>
+using TypeAtResult = typename TypeAt<List, I>::res;
+
+#pragma endregion
+
+#pragma region Join
+
+//====================================================================================================================================
+//!
+//! \brief	Concatenation of lists
+//!
+//====================================================================================================================================
+
+template<typename... Lists>
+struct Join
+{
+	using res = TypeList<>;
+};
+
+template<typename... Types>
+struct Join<TypeList<Types...>>
+{
+	using res = TypeList<Types...>;
+};
+
+template<typename... Left, typename... Right, typename... Lists>
+struct Join<TypeList<Left...>, TypeList<Right...>, Lists...>
+{
+	using res = typename Join<TypeList<Left..., Right...>, Lists...>::res;
+};
+
+template<typename... Lists>
+using JoinResult = typename Join<Lists...>::res;
+
+#pragma endregion
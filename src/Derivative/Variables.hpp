@@ -0,0 +1,261 @@
+#pragma once
+
+//====================================================================================================================================
+//!
+//!	\file   Variables.hpp
+//!
+//! \brief	Compile-time set of variables of the expression
+//!
+//====================================================================================================================================
+
+#include "Differentiation.hpp"
+#include "TypeList.hpp"
+
+#include <array>     // std::array
+#include <cstddef>   // std::size_t
+#include <stdexcept> // std::invalid_argument
+
+#pragma region Order of variables
+
+//====================================================================================================================================
+//!
+//! \brief	Orders variables by name, then by index
+//!
+//====================================================================================================================================
+
+template<typename Left, typename Right>
+struct VariableLess;
+
+template<char LEFT_NAME, int LEFT_INDEX, char RIGHT_NAME, int RIGHT_INDEX>
+struct VariableLess<Node<Variable<LEFT_NAME, LEFT_INDEX>>, Node<Variable<RIGHT_NAME, RIGHT_INDEX>>> :
+	std::bool_constant<(LEFT_NAME < RIGHT_NAME) || (LEFT_NAME == RIGHT_NAME && LEFT_INDEX < RIGHT_INDEX)> { };
+
+//====================================================================================================================================
+//!
+//! \brief	Inserts variable into the sorted list, duplicates are dropped
+//!
+//====================================================================================================================================
+
+template<typename List, typename Var, typename Enable = void>
+struct InsertVariable;
+
+template<typename Var>
+struct InsertVariable<TypeList<>, Var>
+{
+	using res = TypeList<Var>;
+};
+
+template<typename Head, typename... Tail, typename Var>
+struct InsertVariable<TypeList<Head, Tail...>, Var, std::enable_if_t<std::is_same_v<Head, Var>>>
+{
+	using res = TypeList<Head, Tail...>;
+};
+
+template<typename Head, typename... Tail, typename Var>
+struct InsertVariable<TypeList<Head, Tail...>, Var, std::enable_if_t<VariableLess<Var, Head>::value>>
+{
+	using res = TypeList<Var, Head, Tail...>;
+};
+
+template<typename Head, typename... Tail, typename Var>
+struct InsertVariable<TypeList<Head, Tail...>, Var, std::enable_if_t<VariableLess<Head, Var>::value>>
+{
+	template<typename List>
+	struct Prepend;
+
+	template<typename... Types>
+	struct Prepend<TypeList<Types...>>
+	{
+		using res = TypeList<Head, Types...>;
+	};
+
+	using res = typename Prepend<typename InsertVariable<TypeList<Tail...>, Var>::res>::res;
+};
+
+#pragma endregion
+
+#pragma region Variables of expression
+
+//====================================================================================================================================
+//!
+//! \brief	Sorted list of the distinct variables found in the expression
+//!
+//====================================================================================================================================
+
+template<typename T, typename Found = TypeList<>>
+struct VariablesOf
+{
+	using res = Found;
+};
+
+template<char NAME, int INDEX, typename Found>
+struct VariablesOf<Node<Variable<NAME, INDEX>>, Found>
+{
+	using res = typename InsertVariable<Found, Node<Variable<NAME, INDEX>>>::res;
+};
+
+template<UnaryFunction UF, typename Child, typename Found>
+struct VariablesOf<Node<Wrap4UF<UF>, Child>, Found>
+{
+	using res = typename VariablesOf<Child, Found>::res;
+};
+
+template<BinaryFunction BF, typename Left, typename Right, typename Found>
+struct VariablesOf<Node<Wrap4BF<BF>, Left, Right>, Found>
+{
+	using res = typename VariablesOf<Right, typename VariablesOf<Left, Found>::res>::res;
+};
+
+template<typename T>
+using VariablesOfResult = typename VariablesOf<T>::res;
+
+//====================================================================================================================================
+//!
+//! \brief	Sorted list of the distinct variables found in any expression of the list
+//!
+//====================================================================================================================================
+
+template<typename List, typename Found = TypeList<>>
+struct VariablesOfAll;
+
+template<typename Found>
+struct VariablesOfAll<TypeList<>, Found>
+{
+	using res = Found;
+};
+
+template<typename Head, typename... Tail, typename Found>
+struct VariablesOfAll<TypeList<Head, Tail...>, Found>
+{
+	using res = typename VariablesOfAll<TypeList<Tail...>, typename VariablesOf<Head, Found>::res>::res;
+};
+
+template<typename List>
+using VariablesOfAllResult = typename VariablesOfAll<List>::res;
+
+#pragma endregion
+
+#pragma region Dense slots
+
+//====================================================================================================================================
+//!
+//! \brief	Name and index of the variable which owns a slot
+//!
+//====================================================================================================================================
+
+struct SlotInfo
+{
+	char name;
+	int index;
+};
+
+template<typename Var>
+struct SlotInfoOf;
+
+template<char NAME, int INDEX>
+struct SlotInfoOf<Node<Variable<NAME, INDEX>>>
+{
+	static constexpr SlotInfo value = { NAME, INDEX };
+};
+
+//====================================================================================================================================
+//!
+//! \brief	Dense numbering of the sorted variables of Layout, usually VariablesOfResult<Expr>: the value of the variable slot<Var>
+//!			is at that position of a plain array, so the lookup is a load at a constant offset
+//!
+//====================================================================================================================================
+
+template<typename Layout>
+struct Slots;
+
+template<typename... Vars>
+struct Slots<TypeList<Vars...>>
+{
+	using variables = TypeList<Vars...>;
+
+	static constexpr std::size_t SIZE = sizeof...(Vars);
+
+	template<typename Var>
+	static constexpr std::size_t slot = IndexOfValue<variables, Var>;
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Variable of every slot, for callers which lay out their data to match
+	//!
+	//====================================================================================================================================
+
+	static constexpr std::array<SlotInfo, SIZE> table = { SlotInfoOf<Vars>::value... };
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Functor for Node::calc over the values of the slots
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	struct Values
+	{
+		using value_type = T;
+
+		const T *pValues;
+
+		template<typename Var>
+		T operator()(Var) const noexcept { return pValues[slot<Var>]; }
+	};
+};
+
+//====================================================================================================================================
+//!
+//! \brief	 Calculates the expression with the variables in dense slots
+//!
+//! \param   rValues  Value of every slot of Slots<Layout>
+//! \param   rPolicy  What to do on division by zero, see ErrorPolicy
+//!
+//! \throw   std::overflow_error by ErrorPolicy::Throwing, the default
+//!
+//====================================================================================================================================
+
+template<typename Expr, typename Layout = VariablesOfResult<Expr>, typename T, typename Policy>
+T CalcDense(const std::array<T, Slots<Layout>::SIZE> &rValues, Policy &rPolicy)
+{
+	return Expr::calc(typename Slots<Layout>::template Values<T>{ rValues.data() }, rPolicy);
+}
+
+template<typename Expr, typename Layout = VariablesOfResult<Expr>, typename T>
+T CalcDense(const std::array<T, Slots<Layout>::SIZE> &rValues)
+{
+	ErrorPolicy::Throwing policy;
+
+	return CalcDense<Expr, Layout>(rValues, policy);
+}
+
+//====================================================================================================================================
+//!
+//! \brief	 Calculates the expression with the variables in dense slots of a buffer of the caller
+//!
+//! \param   pValues  Value of every slot of Slots<Layout>
+//! \param   size     Number of values, at least Slots<Layout>::SIZE
+//! \param   rPolicy  What to do on division by zero, see ErrorPolicy
+//!
+//! \throw   std::invalid_argument if the buffer is too small, std::overflow_error by ErrorPolicy::Throwing, the default
+//!
+//====================================================================================================================================
+
+template<typename Expr, typename Layout = VariablesOfResult<Expr>, typename T, typename Policy>
+T CalcDense(const T *pValues, std::size_t size, Policy &rPolicy)
+{
+	if (size < Slots<Layout>::SIZE)
+		throw std::invalid_argument("Fewer values than slots");
+
+	return Expr::calc(typename Slots<Layout>::template Values<T>{ pValues }, rPolicy);
+}
+
+template<typename Expr, typename Layout = VariablesOfResult<Expr>, typename T>
+T CalcDense(const T *pValues, std::size_t size)
+{
+	ErrorPolicy::Throwing policy;
+
+	return CalcDense<Expr, Layout>(pValues, size, policy);
+}
+
+#pragma endregion
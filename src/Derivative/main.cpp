@@ -14,11 +14,16 @@ int main()
 
 	using formula = decltype((x0 + Sin(x0)));
 
-	using der = Simplify<formula>;
+	using der = formula::der<'x', 0>;
+	using simplified = SimplifyResult<der>;
+
+	static_assert(CostModel::Cost<simplified>::value.cycles <= CostModel::Cost<der>::value.cycles, "Simplification must not slow down");
 
 	std::cout << formula::dump() << std::endl 
-		<< der::res::template der<'x', 0>::dump() << std::endl;
+		<< der::dump() << " (" << NodeCount<der>::value << " nodes)" << std::endl
+		<< simplified::dump() << " (" << NodeCount<simplified>::value << " nodes, about "
+		<< CostModel::Cost<simplified>::value.cycles << " cycles)" << std::endl;
 	
 	system("pause");
 	return 0;
-}
\ No newline at end of file
+}
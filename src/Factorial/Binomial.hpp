@@ -0,0 +1,351 @@
+#pragma once
+
+#ifndef __BINOMIAL_HPP_INCLUDED__
+#define __BINOMIAL_HPP_INCLUDED__
+
+#include "../Power/Power.hpp"
+
+#include <array>     // std::array
+#include <cstddef>   // size_t
+#include <stdexcept> // std::invalid_argument, std::out_of_range
+#include <vector>    // std::vector
+
+//====================================================================================================================================
+//!
+//! \brief	Factorials, inverse factorials and binomial coefficients modulo a prime: every table is filled in one pass, so a
+//!			lookup is O(1) and building N entries costs O(N) multiplications and one modular exponentiation
+//!
+//! \note	Valid for n < MOD only, n! is divisible by MOD otherwise and has no inverse
+//!
+//====================================================================================================================================
+
+namespace Combinatorics
+{
+
+#pragma region Modular arithmetic
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 left * right modulo mod by PowerEngine::Modular, PowMod is PowerEngine::PowMod
+	//!
+	//! \throw   std::invalid_argument if mod is 0, compile error in constant expressions
+	//!
+	//====================================================================================================================================
+
+	constexpr size_t MulMod(size_t left, size_t right, size_t mod)
+	{
+		return PowerEngine::Modular(mod).multiply(left, right);
+	}
+
+	using PowerEngine::PowMod;
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Modular inverse by Fermat's little theorem, value ^ (mod - 2)
+	//!
+	//! \param   value  Not divisible by mod
+	//! \param   mod    Prime
+	//!
+	//! \throw   std::invalid_argument if mod is 0, compile error in constant expressions
+	//!
+	//====================================================================================================================================
+
+	constexpr size_t InverseMod(size_t value, size_t mod)
+	{
+		return PowMod(value, mod - 2, mod);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Deterministic Miller-Rabin test, the bases are enough for every 64-bit number
+	//!
+	//====================================================================================================================================
+
+	constexpr bool IsPrime(size_t n) noexcept
+	{
+		constexpr size_t BASES[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+
+		if (n < 2)
+			return false;
+
+		for (size_t base : BASES)
+			if (n % base == 0)
+				return (n == base);
+
+		size_t odd = n - 1;
+		size_t shift = 0;
+		for (; !(odd & 1); odd >>= 1)
+			++shift;
+
+		for (size_t base : BASES)
+		{
+			size_t x = PowMod(base, odd, n);
+			if (x == 1 || x == n - 1)
+				continue;
+
+			bool composite = true;
+			for (size_t i = 1; i < shift && composite; ++i)
+			{
+				x = MulMod(x, x, n);
+				composite = (x != n - 1);
+			}
+
+			if (composite)
+				return false;
+		}
+
+		return true;
+	}
+
+#pragma endregion
+
+#pragma region Compile-time tables
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 0!, 1!, ..., N! modulo MOD
+	//!
+	//====================================================================================================================================
+
+	template<size_t N, size_t MOD>
+	constexpr std::array<size_t, N + 1> MakeFactorials()
+	{
+		std::array<size_t, N + 1> table{ };
+
+		table[0] = 1 % MOD;
+		for (size_t i = 1; i <= N; ++i)
+			table[i] = MulMod(table[i - 1], i, MOD);
+
+		return table;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Inverses of 0!, 1!, ..., N! modulo MOD: one exponentiation for N!, then 1 / (i - 1)! = i / i! downwards
+	//!
+	//====================================================================================================================================
+
+	template<size_t N, size_t MOD>
+	constexpr std::array<size_t, N + 1> MakeInverseFactorials(const std::array<size_t, N + 1> &rFactorials)
+	{
+		std::array<size_t, N + 1> table{ };
+
+		table[N] = InverseMod(rFactorials[N], MOD);
+		for (size_t i = N; i > 0; --i)
+			table[i - 1] = MulMod(table[i], i, MOD);
+
+		return table;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Tables of factorials and inverse factorials of 0..N modulo the prime MOD, filled at compile time
+	//!
+	//====================================================================================================================================
+
+	template<size_t N, size_t MOD>
+	struct Tables
+	{
+		static_assert(IsPrime(MOD), "Modulus must be a prime");
+		static_assert(N < MOD, "Factorials from MOD! on are divisible by MOD");
+
+		static constexpr size_t SIZE = N + 1;
+
+		static constexpr std::array<size_t, SIZE> factorial = MakeFactorials<N, MOD>();
+		static constexpr std::array<size_t, SIZE> inverseFactorial = MakeInverseFactorials<N, MOD>(factorial);
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 1 / n modulo MOD = (n - 1)! / n!, 0 < n <= N
+		//!
+		//! \throw   std::invalid_argument if n is 0, std::out_of_range if n is greater than N, compile errors in constant expressions
+		//!
+		//====================================================================================================================================
+
+		static constexpr size_t inverse(size_t n)
+		{
+			if (!n)
+				throw std::invalid_argument("Zero has no inverse");
+
+			return MulMod(factorial[check(n) - 1], inverseFactorial[n], MOD);
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Binomial coefficient n choose k modulo MOD, 0 if k > n
+		//!
+		//! \throw   std::out_of_range if n is greater than N, compile error in constant expressions
+		//!
+		//====================================================================================================================================
+
+		static constexpr size_t binomial(size_t n, size_t k)
+		{
+			check(n);
+
+			return (k > n ? 0 : MulMod(MulMod(factorial[n], inverseFactorial[k], MOD), inverseFactorial[n - k], MOD));
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Number of ordered selections of k out of n, n! / (n - k)!, modulo MOD, 0 if k > n
+		//!
+		//! \throw   std::out_of_range if n is greater than N, compile error in constant expressions
+		//!
+		//====================================================================================================================================
+
+		static constexpr size_t permutations(size_t n, size_t k)
+		{
+			check(n);
+
+			return (k > n ? 0 : MulMod(factorial[n], inverseFactorial[n - k], MOD));
+		}
+
+	private:
+		static constexpr size_t check(size_t n)
+		{
+			if (n > N)
+				throw std::out_of_range("Index exceeds the size of the table");
+
+			return n;
+		}
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Row N of Pascal's triangle modulo MOD: C(N, 0), ..., C(N, N)
+	//!
+	//====================================================================================================================================
+
+	template<size_t N, size_t MOD>
+	constexpr std::array<size_t, N + 1> MakeBinomials()
+	{
+		std::array<size_t, N + 1> row{ };
+		for (size_t k = 0; k <= N; ++k)
+			row[k] = Tables<N, MOD>::binomial(N, k);
+
+		return row;
+	}
+
+	template<size_t N, size_t MOD>
+	struct BinomialRow
+	{
+		static constexpr std::array<size_t, N + 1> value = MakeBinomials<N, MOD>();
+	};
+
+#pragma endregion
+
+#pragma region Runtime tables
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Tables of a size and a prime modulus known at runtime, built once in O(size) and queried in O(1)
+	//!
+	//====================================================================================================================================
+
+	class Table
+	{
+	public:
+		//====================================================================================================================================
+		//!
+		//! \brief	 Builds the tables of 0..size
+		//!
+		//! \param   size  Largest n of the lookups, less than mod
+		//! \param   mod   Prime modulus
+		//!
+		//! \throw   std::invalid_argument if mod is not a prime or not greater than size
+		//!
+		//====================================================================================================================================
+
+		Table(size_t size, size_t mod) :
+			m_Mod(mod)
+		{
+			if (!IsPrime(mod))
+				throw std::invalid_argument("Modulus must be a prime");
+
+			if (size >= mod)
+				throw std::invalid_argument("Factorials from mod! on are divisible by mod");
+
+			m_Factorial.resize(size + 1);
+			m_InverseFactorial.resize(size + 1);
+
+			m_Factorial[0] = 1;
+			for (size_t i = 1; i <= size; ++i)
+				m_Factorial[i] = MulMod(m_Factorial[i - 1], i, mod);
+
+			m_InverseFactorial[size] = InverseMod(m_Factorial[size], mod);
+			for (size_t i = size; i > 0; --i)
+				m_InverseFactorial[i - 1] = MulMod(m_InverseFactorial[i], i, mod);
+		}
+
+		size_t size() const noexcept { return m_Factorial.size() - 1; }
+		size_t mod() const noexcept { return m_Mod; }
+
+		size_t factorial(size_t n) const { return m_Factorial[check(n)]; }
+		size_t inverseFactorial(size_t n) const { return m_InverseFactorial[check(n)]; }
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 1 / n modulo mod, 0 < n <= size()
+		//!
+		//! \throw   std::invalid_argument if n is 0, std::out_of_range if n is greater than size()
+		//!
+		//====================================================================================================================================
+
+		size_t inverse(size_t n) const
+		{
+			if (!n)
+				throw std::invalid_argument("Zero has no inverse");
+
+			return MulMod(m_Factorial[check(n) - 1], m_InverseFactorial[n], m_Mod);
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Binomial coefficient n choose k modulo mod, 0 if k > n
+		//!
+		//! \throw   std::out_of_range if n is greater than size()
+		//!
+		//====================================================================================================================================
+
+		size_t binomial(size_t n, size_t k) const
+		{
+			check(n);
+
+			return (k > n ? 0 : MulMod(MulMod(m_Factorial[n], m_InverseFactorial[k], m_Mod), m_InverseFactorial[n - k], m_Mod));
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Number of ordered selections of k out of n modulo mod, 0 if k > n
+		//!
+		//! \throw   std::out_of_range if n is greater than size()
+		//!
+		//====================================================================================================================================
+
+		size_t permutations(size_t n, size_t k) const
+		{
+			check(n);
+
+			return (k > n ? 0 : MulMod(m_Factorial[n], m_InverseFactorial[n - k], m_Mod));
+		}
+
+	private:
+		size_t check(size_t n) const
+		{
+			if (n >= m_Factorial.size())
+				throw std::out_of_range("Index exceeds the size of the table");
+
+			return n;
+		}
+
+		size_t m_Mod;
+
+		std::vector<size_t> m_Factorial;
+		std::vector<size_t> m_InverseFactorial;
+	};
+
+#pragma endregion
+
+} // namespace Combinatorics
+
+#endif /* __BINOMIAL_HPP_INCLUDED__ */
@@ -3,16 +3,72 @@
 #ifndef __FACTORIAL_HPP_INCLUDED__
 #define __FACTORIAL_HPP_INCLUDED__
 
-template<size_t N>
-struct Factorial 
+#include "../BigInteger/BigInteger.hpp"
+
+#include <cstddef>   // size_t
+#include <limits>    // std::numeric_limits
+#include <stdexcept> // std::overflow_error
+
+//====================================================================================================================================
+//!
+//! \brief	Factorials at compile time: value fits into size_t up to 20!, big is exact for any N
+//!
+//====================================================================================================================================
+
+namespace FactorialEngine
 {
-	static constexpr size_t value = N * Factorial<N - 1>::value;
-};
 
-template<>
-struct Factorial<0ull> 
+	//====================================================================================================================================
+	//!
+	//! \brief	 Calculates n! with checked multiplication
+	//!
+	//! \throw   std::overflow_error if the value does not fit into size_t, compile error in constant expressions
+	//!
+	//====================================================================================================================================
+
+	constexpr size_t Calc(size_t n)
+	{
+		size_t result = 1;
+		for (size_t factor = 2; factor <= n; ++factor)
+		{
+			if (result > std::numeric_limits<size_t>::max() / factor)
+				throw std::overflow_error("Factorial does not fit into size_t");
+
+			result *= factor;
+		}
+
+		return result;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Limbs enough for n!: the bits of a product are at most the sum of the bits of the factors
+	//!
+	//====================================================================================================================================
+
+	constexpr size_t Limbs(size_t n) noexcept
+	{
+		size_t bits = 0;
+		for (size_t factor = 2; factor <= n; ++factor)
+			bits += Multiprecision::BitWidth(factor);
+
+		return Multiprecision::LimbsForBits(bits);
+	}
+
+} // namespace FactorialEngine
+
+template<size_t N>
+struct Factorial
 {
-	static constexpr size_t value = 1ull;
+	static constexpr size_t value = FactorialEngine::Calc(N);
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Exact value by a balanced product tree of 1..N
+	//!
+	//====================================================================================================================================
+
+	static constexpr Multiprecision::BigInteger<FactorialEngine::Limbs(N)> big = Multiprecision::RangeProduct<FactorialEngine::Limbs(N)>(1, N);
 };
 
-#endif /* __FACTORIAL_HPP_INCLUDED__ */
\ No newline at end of file
+#endif /* __FACTORIAL_HPP_INCLUDED__ */
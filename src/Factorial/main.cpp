@@ -1,10 +1,13 @@
-#include "Factorial.hpp" 
+#include "Factorial.hpp"
+#include "Binomial.hpp"
 
 #include <iostream> // std::cout
 
 int main() 
 {
-	std::cout << Factorial<5ull>::value;
+	std::cout << Factorial<5ull>::value << std::endl
+		<< Factorial<30ull>::big << std::endl
+		<< Combinatorics::Tables<100ull, 1000000007ull>::binomial(100, 50) << std::endl;
 
 	system("pause");
 	return 0;
@@ -0,0 +1,274 @@
+#pragma once
+
+#ifndef __FIBONACCI_HPP_INCLUDED__
+#define __FIBONACCI_HPP_INCLUDED__
+
+#include "../BigInteger/BigInteger.hpp"
+
+#include <array>     // std::array
+#include <cstddef>   // size_t
+#include <limits>    // std::numeric_limits
+#include <stdexcept> // std::overflow_error
+
+//====================================================================================================================================
+//!
+//! \brief	Fibonacci numbers by fast doubling in O(log N), both at compile time and at runtime
+//!
+//! \note	Numbering is the same as always: Fibonacci<0> == Fibonacci<1> == 1, Fibonacci<2> == 2, ...
+//!
+//====================================================================================================================================
+
+namespace FibonacciEngine
+{
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Largest index whose value fits into size_t without modulus
+	//!
+	//====================================================================================================================================
+
+	constexpr size_t MAX_INDEX = std::numeric_limits<size_t>::digits == 64 ? 92 : 45;
+
+#pragma region Arithmetic
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Checked addition
+	//!
+	//! \throw   std::overflow_error, compile error in constant expressions
+	//!
+	//====================================================================================================================================
+
+	constexpr size_t Add(size_t left, size_t right, size_t mod)
+	{
+		if (mod)
+			return (left >= mod - right ? left - (mod - right) : left + right);
+
+		if (left > std::numeric_limits<size_t>::max() - right)
+			throw std::overflow_error("Fibonacci number does not fit into size_t");
+
+		return (left + right);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Checked multiplication, modular multiplication never overflows
+	//!
+	//! \throw   std::overflow_error, compile error in constant expressions
+	//!
+	//====================================================================================================================================
+
+	constexpr size_t Mul(size_t left, size_t right, size_t mod)
+	{
+		if (mod)
+		{
+#if defined(__SIZEOF_INT128__)
+			return static_cast<size_t>(static_cast<unsigned __int128>(left) * right % mod);
+#else
+			size_t result = 0;
+			for (left %= mod; right; right >>= 1)
+			{
+				if (right & 1)
+					result = Add(result, left, mod);
+
+				left = Add(left, left, mod);
+			}
+
+			return result;
+#endif /* defined(__SIZEOF_INT128__) */
+		}
+
+		if (left && right > std::numeric_limits<size_t>::max() / left)
+			throw std::overflow_error("Fibonacci number does not fit into size_t");
+
+		return (left * right);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Subtraction, the result is never negative for the values of the doubling step
+	//!
+	//====================================================================================================================================
+
+	constexpr size_t Sub(size_t left, size_t right, size_t mod) noexcept
+	{
+		return (mod && left < right ? left + (mod - right) : left - right);
+	}
+
+#pragma endregion
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Calculates Fibonacci number by fast doubling
+	//!
+	//! \param   n    Index, numbering starts from Calc(0) == Calc(1) == 1
+	//! \param   mod  Modulus, 0 means no modulus and checked arithmetic
+	//!
+	//! \return  Fibonacci number (modulo mod)
+	//!
+	//! \throw   std::overflow_error if mod is 0 and the value does not fit into size_t
+	//!
+	//====================================================================================================================================
+
+	constexpr size_t Calc(size_t n, size_t mod = 0)
+	{
+		if (mod == 1)
+			return 0;
+
+		// (a, b) = (F(k), F(k + 1)) in the classic numbering for the leading bits k of n, the answer is F(n + 1).
+		// Every intermediate value is at most F(n + 1), so the checks fire only on real overflow
+		size_t a = 0;
+		size_t b = 1;
+
+		size_t bit = 1;
+		while (bit <= n / 2)
+			bit <<= 1;
+
+		for (bit = n ? bit : 0; bit; bit >>= 1)
+		{
+			const size_t even = Mul(a, Sub(Add(b, b, mod), a, mod), mod); // F(2k)     = F(k) * (2 * F(k + 1) - F(k))
+			const size_t odd  = Add(Mul(a, a, mod), Mul(b, b, mod), mod); // F(2k + 1) = F(k) ^ 2 + F(k + 1) ^ 2
+
+			if (n & bit)
+			{
+				a = odd;
+				b = Add(even, odd, mod);
+			}
+			else
+			{
+				a = even;
+				b = odd;
+			}
+		}
+
+		return b;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Limbs enough for Calc(n): F(n + 1) < phi ^ (n + 1) and log2(phi) < 0.7
+	//!
+	//====================================================================================================================================
+
+	constexpr size_t Limbs(size_t n) noexcept
+	{
+		return Multiprecision::LimbsForBits((n + 1) * 7 / 10 + 1);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Calculates the exact Fibonacci number by the same fast doubling as Calc
+	//!
+	//! \param   n  Index, numbering starts from CalcBig(0) == CalcBig(1) == 1
+	//!
+	//! \throw   std::overflow_error if the value does not fit into LIMBS limbs
+	//!
+	//====================================================================================================================================
+
+	template<size_t LIMBS>
+	constexpr Multiprecision::BigInteger<LIMBS> CalcBig(size_t n)
+	{
+		Multiprecision::BigInteger<LIMBS> a = 0;
+		Multiprecision::BigInteger<LIMBS> b = 1;
+
+		size_t bit = 1;
+		while (bit <= n / 2)
+			bit <<= 1;
+
+		for (bit = n ? bit : 0; bit; bit >>= 1)
+		{
+			const Multiprecision::BigInteger<LIMBS> even = a * (b + b - a);
+			const Multiprecision::BigInteger<LIMBS> odd  = a * a + b * b;
+
+			if (n & bit)
+			{
+				a = odd;
+				b = even + odd;
+			}
+			else
+			{
+				a = even;
+				b = odd;
+			}
+		}
+
+		return b;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Exact value of Fibonacci<N>, only without modulus
+	//!
+	//====================================================================================================================================
+
+	template<size_t N, bool EXACT>
+	struct Exact
+	{
+	};
+
+	template<size_t N>
+	struct Exact<N, true>
+	{
+		static constexpr Multiprecision::BigInteger<Limbs(N)> big = CalcBig<Limbs(N)>(N);
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Every Fibonacci number that fits into size_t
+	//!
+	//====================================================================================================================================
+
+	constexpr std::array<size_t, MAX_INDEX + 1> MakeTable()
+	{
+		std::array<size_t, MAX_INDEX + 1> table{ };
+
+		table[0] = table[1] = 1;
+		for (size_t i = 2; i <= MAX_INDEX; ++i)
+			table[i] = table[i - 1] + table[i - 2];
+
+		return table;
+	}
+
+	constexpr std::array<size_t, MAX_INDEX + 1> TABLE = MakeTable();
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Calculates Fibonacci numbers for many indices
+	//!
+	//! \param   pIndices  Indices
+	//! \param   pResult   Output, at least count elements
+	//! \param   count     Number of indices
+	//! \param   mod       Modulus, 0 means no modulus: the values are taken from TABLE
+	//!
+	//! \throw   std::overflow_error if mod is 0 and an index is greater than MAX_INDEX
+	//!
+	//====================================================================================================================================
+
+	inline void CalcBatch(const size_t *pIndices, size_t *pResult, size_t count, size_t mod = 0)
+	{
+		if (!mod)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (pIndices[i] > MAX_INDEX)
+					throw std::overflow_error("Fibonacci number does not fit into size_t");
+
+				pResult[i] = TABLE[pIndices[i]];
+			}
+		}
+		else
+		{
+			for (size_t i = 0; i < count; ++i)
+				pResult[i] = Calc(pIndices[i], mod);
+		}
+	}
+
+} // namespace FibonacciEngine
+
+template<size_t N, size_t MOD = 0>
+struct Fibonacci : FibonacciEngine::Exact<N, MOD == 0>
+{
+	static constexpr size_t value = FibonacciEngine::Calc(N, MOD);
+};
+
+#endif /* __FIBONACCI_HPP_INCLUDED__ */
@@ -4,8 +4,11 @@
 
 int main()
 {
-	std::cout << Fibonacci<5ull>::value;
+	std::cout << Fibonacci<5ull>::value << std::endl
+		<< Fibonacci<1000000000000000000ull, 1000000007ull>::value << std::endl
+		<< FibonacciEngine::Calc(90) << std::endl
+		<< Fibonacci<200ull>::big << std::endl;
 
 	system("pause");
 	return 0;
-}
\ No newline at end of file
+}
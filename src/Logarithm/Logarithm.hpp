@@ -3,16 +3,318 @@
 #ifndef __LOGARITHM_HPP_INCLUDED__
 #define __LOGARITHM_HPP_INCLUDED__
 
-template <unsigned x>
-struct Log2 
-{ 
-	static constexpr int value = 1 + Log2<x / 2>::value;
-};
+#include <climits>     // CHAR_BIT
+#include <cstddef>     // size_t
+#include <cstdint>     // std::uint32_t, std::uint64_t
+#include <type_traits> // std::is_unsigned_v
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif /* defined(__AVX2__) */
+
+//====================================================================================================================================
+//!
+//! \brief	Integer binary logarithms by counting leading zeros, both at compile time and at runtime
+//!
+//! \note	FloorLog2(0) == CeilLog2(0) == -1, so that FloorLog2(x) + 1 is the number of significant bits for every x
+//!
+//====================================================================================================================================
+
+namespace LogarithmEngine
+{
+
+	template<typename T>
+	struct IsUnsignedInteger : std::bool_constant<std::is_integral_v<T> && std::is_unsigned_v<T> && !std::is_same_v<T, bool>> { };
+
+#if defined(__SIZEOF_INT128__)
+	template<>
+	struct IsUnsignedInteger<unsigned __int128> : std::true_type { };
+#endif /* defined(__SIZEOF_INT128__) */
+
+	template<typename T>
+	constexpr int DIGITS = static_cast<int>(sizeof(T) * CHAR_BIT);
+
+#pragma region Leading zeros
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Leading zeros of a 32-bit value, 32 for 0
+	//!
+	//! \note	 GCC and clang evaluate the builtin in constant expressions, elsewhere a binary search over halves is used
+	//!
+	//====================================================================================================================================
+
+	constexpr int CountLeadingZeros32(std::uint32_t value) noexcept
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return (value ? __builtin_clz(value) : 32);
+#else
+		int count = 0;
+		for (int shift = 16; shift; shift >>= 1)
+		{
+			if (!(value >> (32 - shift)))
+			{
+				count += shift;
+				value <<= shift;
+			}
+		}
+
+		return (value ? count : 32);
+#endif /* defined(__GNUC__) || defined(__clang__) */
+	}
+
+	constexpr int CountLeadingZeros64(std::uint64_t value) noexcept
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return (value ? __builtin_clzll(value) : 64);
+#else
+		int count = 0;
+		for (int shift = 32; shift; shift >>= 1)
+		{
+			if (!(value >> (64 - shift)))
+			{
+				count += shift;
+				value <<= shift;
+			}
+		}
+
+		return (value ? count : 64);
+#endif /* defined(__GNUC__) || defined(__clang__) */
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Leading zeros of an unsigned integer of up to 128 bits, DIGITS<T> for 0
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	constexpr int CountLeadingZeros(T value) noexcept
+	{
+		static_assert(IsUnsignedInteger<T>::value, "Logarithms are defined for unsigned integers");
+
+		if constexpr (DIGITS<T> <= 32)
+			return CountLeadingZeros32(static_cast<std::uint32_t>(value)) - (32 - DIGITS<T>);
+		else if constexpr (DIGITS<T> == 64)
+			return CountLeadingZeros64(static_cast<std::uint64_t>(value));
+		else
+		{
+			static_assert(DIGITS<T> == 128, "Unsupported width");
+
+			const std::uint64_t high = static_cast<std::uint64_t>(value >> 64);
+
+			return (high ? CountLeadingZeros64(high) : 64 + CountLeadingZeros64(static_cast<std::uint64_t>(value)));
+		}
+	}
+
+#pragma endregion
+
+#pragma region Logarithms
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Number of significant bits, 0 for 0
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	constexpr int BitWidth(T value) noexcept
+	{
+		return DIGITS<T> - CountLeadingZeros(value);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Largest k with 2 ^ k <= value, -1 for 0
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	constexpr int FloorLog2(T value) noexcept
+	{
+		return BitWidth(value) - 1;
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Smallest k with 2 ^ k >= value, -1 for 0
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	constexpr int CeilLog2(T value) noexcept
+	{
+		return (value ? BitWidth(static_cast<T>(value - 1)) : -1);
+	}
+
+	template<typename T>
+	constexpr bool IsPowerOf2(T value) noexcept
+	{
+		static_assert(IsUnsignedInteger<T>::value, "Logarithms are defined for unsigned integers");
+
+		return (value && !(value & (value - 1)));
+	}
+
+#pragma endregion
+
+#pragma region Batches
+
+#if defined(__AVX2__)
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 FloorLog2 of eight 32-bit lanes by vplzcntd of AVX-512CD where available. With AVX2 alone the exponent of a
+	//!			 float is the logarithm: value & ~(value >> 1) has no two adjacent bits set, so its conversion cannot round up to
+	//!			 the next power of two
+	//!
+	//====================================================================================================================================
+
+	inline __m256i FloorLog2x8(__m256i values) noexcept
+	{
+#if defined(__AVX512CD__) && defined(__AVX512VL__)
+		return _mm256_sub_epi32(_mm256_set1_epi32(31), _mm256_lzcnt_epi32(values));
+#else
+		const __m256i isolated = _mm256_andnot_si256(_mm256_srli_epi32(values, 1), values);
+		const __m256i exponent = _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(isolated)), 23);
+
+		// 0 converts to 0.0 with the exponent field 0, so the maximum turns it into -1
+		const __m256i result = _mm256_max_epi32(_mm256_sub_epi32(exponent, _mm256_set1_epi32(127)), _mm256_set1_epi32(-1));
+
+		// the conversion is signed, the lanes with the top bit set are 31
+		return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(result), _mm256_castsi256_ps(_mm256_set1_epi32(31)),
+			_mm256_castsi256_ps(values)));
+#endif /* defined(__AVX512CD__) && defined(__AVX512VL__) */
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 FloorLog2 of four 64-bit lanes in the low half by vplzcntq where available. With AVX2 alone it is the logarithm
+	//!			 of the high 32 bits plus 32 if they are not 0, of the low 32 bits otherwise
+	//!
+	//====================================================================================================================================
+
+	inline __m128i FloorLog2x4(__m256i values) noexcept
+	{
+#if defined(__AVX512CD__) && defined(__AVX512VL__)
+		const __m256i merged = _mm256_sub_epi64(_mm256_set1_epi64x(63), _mm256_lzcnt_epi64(values));
+#else
+		const __m256i halves = FloorLog2x8(values);
+
+		// the high half moved to the low one, -1 stays -1 in the low 32 bits
+		const __m256i high = _mm256_srli_epi64(halves, 32);
+		const __m256i useHigh = _mm256_cmpgt_epi32(high, _mm256_set1_epi32(-1));
+		const __m256i merged = _mm256_blendv_epi8(halves, _mm256_add_epi32(high, _mm256_set1_epi32(32)), useHigh);
+#endif /* defined(__AVX512CD__) && defined(__AVX512VL__) */
+
+		return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(merged, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+	}
+
+#endif /* defined(__AVX2__) */
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Calculates FloorLog2 or CeilLog2 of many values, with AVX2 eight 32-bit or four 64-bit values at a time
+	//!
+	//! \note	 With LZCNT and without AVX-512CD the scalar FloorLog2 is about as fast on 64-bit values
+	//!
+	//! \param   pValues  Values
+	//! \param   pResult  Output, at least count elements
+	//! \param   count    Number of values
+	//!
+	//! \note	 CeilLog2(x) == FloorLog2(x - 1) + 1 except for 0, whose x - 1 wraps around
+	//!
+	//====================================================================================================================================
+
+	template<bool CEIL>
+	void Log2Batch(const std::uint32_t *pValues, int *pResult, size_t count) noexcept
+	{
+		size_t i = 0;
+
+#if defined(__AVX2__)
+		const __m256i one = _mm256_set1_epi32(1);
+
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pValues + i));
+
+			__m256i result;
+			if constexpr (CEIL)
+			{
+				const __m256i zero = _mm256_cmpeq_epi32(values, _mm256_setzero_si256());
+				result = _mm256_or_si256(_mm256_add_epi32(FloorLog2x8(_mm256_sub_epi32(values, one)), one), zero);
+			}
+			else
+				result = FloorLog2x8(values);
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pResult + i), result);
+		}
+#endif /* defined(__AVX2__) */
+
+		for (; i < count; ++i)
+			pResult[i] = (CEIL ? CeilLog2(pValues[i]) : FloorLog2(pValues[i]));
+	}
+
+	template<bool CEIL>
+	void Log2Batch(const std::uint64_t *pValues, int *pResult, size_t count) noexcept
+	{
+		size_t i = 0;
+
+#if defined(__AVX2__)
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pValues + i));
+
+			__m128i result;
+			if constexpr (CEIL)
+			{
+				const __m128i one = _mm_set1_epi32(1);
+				const __m256i zero = _mm256_cmpeq_epi64(values, _mm256_setzero_si256());
+				const __m128i floor = FloorLog2x4(_mm256_sub_epi64(values, _mm256_set1_epi64x(1)));
+
+				result = _mm_or_si128(_mm_add_epi32(floor, one),
+					_mm256_castsi256_si128(_mm256_permutevar8x32_epi32(zero, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6))));
+			}
+			else
+				result = FloorLog2x4(values);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pResult + i), result);
+		}
+#endif /* defined(__AVX2__) */
+
+		for (; i < count; ++i)
+			pResult[i] = (CEIL ? CeilLog2(pValues[i]) : FloorLog2(pValues[i]));
+	}
+
+	template<typename T>
+	void FloorLog2Batch(const T *pValues, int *pResult, size_t count) noexcept
+	{
+		Log2Batch<false>(pValues, pResult, count);
+	}
+
+	template<typename T>
+	void CeilLog2Batch(const T *pValues, int *pResult, size_t count) noexcept
+	{
+		Log2Batch<true>(pValues, pResult, count);
+	}
+
+#pragma endregion
+
+} // namespace LogarithmEngine
+
+//====================================================================================================================================
+//!
+//! \brief	Binary logarithm of a constant: value rounds down, ceil rounds up, exact tells whether X is a power of two
+//!
+//====================================================================================================================================
+
+template <unsigned long long X>
+struct Log2
+{
+	static_assert(X > 0, "Logarithm of zero is undefined");
 
-template <> 
-struct Log2<1u> 
-{ 
-	static constexpr int value = 1;
+	static constexpr int value = LogarithmEngine::FloorLog2(X);
+	static constexpr int ceil = LogarithmEngine::CeilLog2(X);
+	static constexpr bool exact = LogarithmEngine::IsPowerOf2(X);
 };
 
-#endif /* __LOGARITHM_HPP_INCLUDED__ */
\ No newline at end of file
+#endif /* __LOGARITHM_HPP_INCLUDED__ */
@@ -4,7 +4,8 @@
 
 int main()
 {
-	std::cout << Log2<5>::value;
+	std::cout << Log2<5>::value << ' ' << Log2<5>::ceil << std::endl
+		<< LogarithmEngine::FloorLog2(1ull << 40) << std::endl;
 
 	system("pause");
 	return 0;
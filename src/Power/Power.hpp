@@ -3,18 +3,471 @@
 #ifndef __POWER_HPP_INCLUDED__
 #define __POWER_HPP_INCLUDED__
 
+#include "../BigInteger/BigInteger.hpp"
+
+#include <array>       // std::array
+#include <cstddef>     // size_t
+#include <cstdint>     // std::uint64_t
+#include <limits>      // std::numeric_limits
+#include <stdexcept>   // std::overflow_error, std::invalid_argument
+#include <type_traits> // std::is_signed_v
+
 using ll_t = long long;
 
+//====================================================================================================================================
+//!
+//! \brief	Exponentiation by squaring over any monoid, both at compile time and at runtime: O(log N) multiplications of
+//!			checked integers, residues, Montgomery residues, floating point numbers, big integers or small matrices
+//!
+//! \note	A monoid is a class with value_type, identity() and multiply(left, right); a ring also has zero() and add(left, right)
+//!
+//====================================================================================================================================
+
+namespace PowerEngine
+{
+
+#pragma region Engine
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Calculates base ^ exponent in O(log exponent) multiplications of the monoid
+	//!
+	//! \throw   Whatever multiply of the monoid throws
+	//!
+	//====================================================================================================================================
+
+	template<typename Monoid>
+	constexpr typename Monoid::value_type Pow(const Monoid &rMonoid, typename Monoid::value_type base, std::uint64_t exponent)
+	{
+		typename Monoid::value_type result = rMonoid.identity();
+		for (; exponent; exponent >>= 1)
+		{
+			if (exponent & 1)
+				result = rMonoid.multiply(result, base);
+
+			// the last square is not needed and may overflow on its own
+			if (exponent > 1)
+				base = rMonoid.multiply(base, base);
+		}
+
+		return result;
+	}
+
+#pragma endregion
+
+#pragma region Monoids
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Built-in arithmetic of T: floating point numbers, big integers, unchecked integers
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	struct Arithmetic
+	{
+		using value_type = T;
+
+		constexpr T zero() const { return T(0); }
+		constexpr T identity() const { return T(1); }
+
+		constexpr T add(const T &rLeft, const T &rRight) const { return (rLeft + rRight); }
+		constexpr T multiply(const T &rLeft, const T &rRight) const { return (rLeft * rRight); }
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Integers with overflow checks, the magnitudes are compared with the limit of the sign of the result
+	//!
+	//! \throw   std::overflow_error, compile error in constant expressions
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	struct Checked
+	{
+		static_assert(std::numeric_limits<T>::is_integer, "Checked arithmetic is for integers");
+
+		using value_type = T;
+
+		constexpr T zero() const noexcept { return 0; }
+		constexpr T identity() const noexcept { return 1; }
+
+		constexpr T add(T left, T right) const
+		{
+			if (right > 0 ? left > std::numeric_limits<T>::max() - right : left < std::numeric_limits<T>::min() - right)
+				throw std::overflow_error("Sum does not fit into the type");
+
+			return static_cast<T>(left + right);
+		}
+
+		constexpr T multiply(T left, T right) const
+		{
+			if constexpr (std::is_signed_v<T>)
+			{
+				const bool negative = ((left < 0) != (right < 0));
+
+				const std::uint64_t leftMagnitude = Magnitude(left);
+				const std::uint64_t rightMagnitude = Magnitude(right);
+				const std::uint64_t limit = static_cast<std::uint64_t>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+
+				if (leftMagnitude && rightMagnitude > limit / leftMagnitude)
+					throw std::overflow_error("Product does not fit into the type");
+
+				const std::uint64_t magnitude = leftMagnitude * rightMagnitude;
+
+				return (negative ? static_cast<T>(0 - magnitude) : static_cast<T>(magnitude));
+			}
+			else
+			{
+				if (left && right > std::numeric_limits<T>::max() / left)
+					throw std::overflow_error("Product does not fit into the type");
+
+				return static_cast<T>(left * right);
+			}
+		}
+
+	private:
+		static constexpr std::uint64_t Magnitude(T value) noexcept
+		{
+			return (value < 0 ? 0 - static_cast<std::uint64_t>(value) : static_cast<std::uint64_t>(value));
+		}
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 High and low halves of the 128-bit product
+	//!
+	//====================================================================================================================================
+
+	constexpr std::uint64_t MultiplyWide(std::uint64_t left, std::uint64_t right, std::uint64_t &rLow) noexcept
+	{
+#if defined(__SIZEOF_INT128__)
+		const unsigned __int128 product = static_cast<unsigned __int128>(left) * right;
+
+		rLow = static_cast<std::uint64_t>(product);
+
+		return static_cast<std::uint64_t>(product >> 64);
+#else
+		const std::uint64_t leftLow = left & 0xFFFFFFFFu, leftHigh = left >> 32;
+		const std::uint64_t rightLow = right & 0xFFFFFFFFu, rightHigh = right >> 32;
+
+		const std::uint64_t low = leftLow * rightLow;
+		const std::uint64_t middle = leftHigh * rightLow + (low >> 32);
+		const std::uint64_t cross = leftLow * rightHigh + (middle & 0xFFFFFFFFu);
+
+		rLow = (cross << 32) | (low & 0xFFFFFFFFu);
+
+		return leftHigh * rightHigh + (middle >> 32) + (cross >> 32);
+#endif /* defined(__SIZEOF_INT128__) */
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Residues modulo mod, the product is reduced by a 128-bit division
+	//!
+	//====================================================================================================================================
+
+	class Modular
+	{
+	public:
+		using value_type = std::uint64_t;
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Residues modulo mod, 1 gives the zero ring
+		//!
+		//! \throw   std::invalid_argument if mod is 0
+		//!
+		//====================================================================================================================================
+
+		constexpr explicit Modular(std::uint64_t mod) :
+			m_Mod(mod)
+		{
+			if (!mod)
+				throw std::invalid_argument("Residues need a modulus greater than 0");
+		}
+
+		constexpr std::uint64_t mod() const noexcept { return m_Mod; }
+
+		constexpr std::uint64_t zero() const noexcept { return 0; }
+		constexpr std::uint64_t identity() const noexcept { return 1 % m_Mod; }
+
+		constexpr std::uint64_t add(std::uint64_t left, std::uint64_t right) const noexcept
+		{
+			return (left >= m_Mod - right ? left - (m_Mod - right) : left + right);
+		}
+
+		constexpr std::uint64_t multiply(std::uint64_t left, std::uint64_t right) const noexcept
+		{
+#if defined(__SIZEOF_INT128__)
+			return static_cast<std::uint64_t>(static_cast<unsigned __int128>(left) * right % m_Mod);
+#else
+			std::uint64_t result = 0;
+			for (left %= m_Mod; right; right >>= 1)
+			{
+				if (right & 1)
+					result = add(result, left);
+
+				left = add(left, left);
+			}
+
+			return result;
+#endif /* defined(__SIZEOF_INT128__) */
+		}
+
+	private:
+		std::uint64_t m_Mod;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Residues modulo an odd mod in Montgomery form x * 2^64 mod mod: the product is reduced by two multiplications
+	//!			instead of a division, which is the fast path for runtime moduli
+	//!
+	//====================================================================================================================================
+
+	class Montgomery
+	{
+	public:
+		using value_type = std::uint64_t;
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 Prepares the constants of the modulus
+		//!
+		//! \throw   std::invalid_argument if mod is even or 1
+		//!
+		//====================================================================================================================================
+
+		constexpr explicit Montgomery(std::uint64_t mod) :
+			m_Mod(mod)
+		{
+			if (!(mod & 1) || mod == 1)
+				throw std::invalid_argument("Montgomery form needs an odd modulus greater than 1");
+
+			// Newton's iteration doubles the correct low bits of the inverse, mod * mod == 1 modulo 8 gives the first 3
+			m_Inverse = mod;
+			for (int i = 0; i < 5; ++i)
+				m_Inverse *= 2 - mod * m_Inverse;
+
+			// 2^64 mod mod, then 2^128 mod mod by doubling it 64 times
+			m_One = (0 - mod) % mod;
+			m_Square = m_One;
+			for (int i = 0; i < 64; ++i)
+				m_Square = add(m_Square, m_Square);
+		}
+
+		constexpr std::uint64_t mod() const noexcept { return m_Mod; }
+
+		constexpr std::uint64_t zero() const noexcept { return 0; }
+		constexpr std::uint64_t identity() const noexcept { return m_One; }
+
+		constexpr std::uint64_t add(std::uint64_t left, std::uint64_t right) const noexcept
+		{
+			return (left >= m_Mod - right ? left - (m_Mod - right) : left + right);
+		}
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 left * right / 2^64 modulo mod: the low 64 bits of left * right - q * mod vanish for q = low * mod^-1
+		//!
+		//====================================================================================================================================
+
+		constexpr std::uint64_t multiply(std::uint64_t left, std::uint64_t right) const noexcept
+		{
+			std::uint64_t low = 0;
+			const std::uint64_t high = MultiplyWide(left, right, low);
+
+			std::uint64_t unused = 0;
+			const std::uint64_t subtrahend = MultiplyWide(low * m_Inverse, m_Mod, unused);
+
+			return (high >= subtrahend ? high - subtrahend : high + (m_Mod - subtrahend));
+		}
+
+		constexpr std::uint64_t to(std::uint64_t value) const noexcept { return multiply(value % m_Mod, m_Square); }
+		constexpr std::uint64_t from(std::uint64_t value) const noexcept { return multiply(value, 1); }
+
+		//====================================================================================================================================
+		//!
+		//! \brief	 base ^ exponent modulo mod, the conversions into the form and back cost one multiplication each
+		//!
+		//====================================================================================================================================
+
+		constexpr std::uint64_t pow(std::uint64_t base, std::uint64_t exponent) const noexcept
+		{
+			return from(Pow(*this, to(base), exponent));
+		}
+
+	private:
+		std::uint64_t m_Mod;
+		std::uint64_t m_Inverse = 0;
+		std::uint64_t m_One = 0;
+		std::uint64_t m_Square = 0;
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 base ^ exponent modulo mod, Montgomery is faster for many exponentiations by the same odd modulus
+	//!
+	//! \throw   std::invalid_argument if mod is 0, compile error in constant expressions
+	//!
+	//====================================================================================================================================
+
+	constexpr std::uint64_t PowMod(std::uint64_t base, std::uint64_t exponent, std::uint64_t mod)
+	{
+		const Modular ring{ mod };
+
+		return Pow(ring, base % mod, exponent);
+	}
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 base ^ exponent for a signed exponent: the power of the reciprocal for negative ones
+	//!
+	//====================================================================================================================================
+
+	template<typename T>
+	constexpr T PowFloating(T base, long long exponent) noexcept
+	{
+		static_assert(std::numeric_limits<T>::is_iec559, "Reciprocals need floating point numbers");
+
+		const std::uint64_t magnitude = (exponent < 0 ? 0 - static_cast<std::uint64_t>(exponent) : static_cast<std::uint64_t>(exponent));
+		const T result = Pow(Arithmetic<T>{ }, base, magnitude);
+
+		return (exponent < 0 ? T(1) / result : result);
+	}
+
+#pragma endregion
+
+#pragma region Matrices
+
+	template<typename T, size_t N>
+	using Matrix = std::array<std::array<T, N>, N>;
+
+	//====================================================================================================================================
+	//!
+	//! \brief	Square matrices of N x N over the ring, the product is the naive one, which is the fastest for small N
+	//!
+	//====================================================================================================================================
+
+	template<typename Ring, size_t N>
+	struct MatrixRing
+	{
+		using element_type = typename Ring::value_type;
+		using value_type = Matrix<element_type, N>;
+
+		Ring ring;
+
+		constexpr value_type zero() const
+		{
+			value_type result{ };
+			for (auto &rRow : result)
+				for (auto &rElement : rRow)
+					rElement = ring.zero();
+
+			return result;
+		}
+
+		constexpr value_type identity() const
+		{
+			value_type result = zero();
+			for (size_t i = 0; i < N; ++i)
+				result[i][i] = ring.identity();
+
+			return result;
+		}
+
+		constexpr value_type add(const value_type &rLeft, const value_type &rRight) const
+		{
+			value_type result{ };
+			for (size_t i = 0; i < N; ++i)
+				for (size_t j = 0; j < N; ++j)
+					result[i][j] = ring.add(rLeft[i][j], rRight[i][j]);
+
+			return result;
+		}
+
+		constexpr value_type multiply(const value_type &rLeft, const value_type &rRight) const
+		{
+			value_type result = zero();
+			for (size_t i = 0; i < N; ++i)
+				for (size_t k = 0; k < N; ++k)
+					for (size_t j = 0; j < N; ++j)
+						result[i][j] = ring.add(result[i][j], ring.multiply(rLeft[i][k], rRight[k][j]));
+
+			return result;
+		}
+	};
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Term n of the linear recurrence a(n) = c[0] a(n - 1) + ... + c[K - 1] a(n - K) by the power of its companion
+	//!			 matrix, O(K^3 log n)
+	//!
+	//! \param   rRing          Arithmetic of the terms, e.g. Modular or Montgomery with the values in its form
+	//! \param   rCoefficients  c[0], ..., c[K - 1]
+	//! \param   rInitial       a(0), ..., a(K - 1)
+	//! \param   n              Index of the term
+	//!
+	//====================================================================================================================================
+
+	template<typename Ring, size_t K>
+	constexpr typename Ring::value_type Recurrence(const Ring &rRing, const std::array<typename Ring::value_type, K> &rCoefficients,
+		const std::array<typename Ring::value_type, K> &rInitial, std::uint64_t n)
+	{
+		if (n < K)
+			return rInitial[n];
+
+		// the state (a(m + K - 1), ..., a(m)) is multiplied by the companion matrix to advance m by one
+		const MatrixRing<Ring, K> matrices{ rRing };
+
+		Matrix<typename Ring::value_type, K> companion = matrices.zero();
+		for (size_t j = 0; j < K; ++j)
+			companion[0][j] = rCoefficients[j];
+		for (size_t i = 1; i < K; ++i)
+			companion[i][i - 1] = rRing.identity();
+
+		const Matrix<typename Ring::value_type, K> power = Pow(matrices, companion, n);
+
+		// a(n) is the last element of the advanced state (a(K - 1), ..., a(0))
+		typename Ring::value_type result = rRing.zero();
+		for (size_t j = 0; j < K; ++j)
+			result = rRing.add(result, rRing.multiply(power[K - 1][j], rInitial[K - 1 - j]));
+
+		return result;
+	}
+
+#pragma endregion
+
+	//====================================================================================================================================
+	//!
+	//! \brief	 Limbs enough for x ^ n, the powers of 0, 1 and -1 need one bit
+	//!
+	//====================================================================================================================================
+
+	constexpr size_t Limbs(ll_t x, unsigned n) noexcept
+	{
+		const std::uint64_t magnitude = (x < 0 ? 0 - static_cast<std::uint64_t>(x) : static_cast<std::uint64_t>(x));
+
+		return Multiprecision::LimbsForBits(magnitude > 1 ? n * Multiprecision::BitWidth(magnitude) : 1);
+	}
+
+} // namespace PowerEngine
+
+//====================================================================================================================================
+//!
+//! \brief	Power of constants: value is checked to fit into ll_t, big is exact
+//!
+//====================================================================================================================================
+
 template <ll_t X, unsigned N>
 struct Power
 {
-	static constexpr ll_t value = X * Power<X, N - 1>::value;
-};
+	static constexpr ll_t value = PowerEngine::Pow(PowerEngine::Checked<ll_t>{ }, X, N);
 
-template <ll_t X>
-struct Power<X, 0u>
-{
-	static constexpr ll_t value = 1ll;
+	static constexpr Multiprecision::BigInteger<PowerEngine::Limbs(X, N)> big =
+		PowerEngine::Pow(PowerEngine::Arithmetic<Multiprecision::BigInteger<PowerEngine::Limbs(X, N)>>{ }, X, N);
 };
 
-#endif /* __POWER_HPP_INCLUDED__ */
\ No newline at end of file
+#endif /* __POWER_HPP_INCLUDED__ */
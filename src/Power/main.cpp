@@ -4,7 +4,9 @@
 
 int main()
 {
-	std::cout << Power<5ll, 3u>::value;
+	std::cout << Power<5ll, 3u>::value << std::endl
+		<< Power<-3ll, 50u>::big << std::endl
+		<< PowerEngine::Montgomery(1000000007ull).pow(2, 1000000006) << std::endl;
 
 	system("pause");
 	return 0;